@@ -0,0 +1,85 @@
+#include <ringexport.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+
+// Throughput of the ring export : frames are written back to back while a reader thread maps the same file
+// through RingView, like an external process would, and checks every frame it reads in place
+// A frame is consistent when all its heights equal its index, torn frames are detected by the sequence lock
+// and dropped, never read half written. Fails when the writer cannot sustain 60 frames per second
+// Usage : exportbench [ resolution ] [ frames ] [ path ]
+int main( int argc, char ** argv )
+{
+    int resolution = 256;
+    int frames = 2000;
+    std::string path = "exportbench.ring";
+    if( argc > 1 )
+        resolution = std::max( 1, std::stoi( argv[1] ) );
+    if( argc > 2 )
+        frames = std::max( 1, std::stoi( argv[2] ) );
+    if( argc > 3 )
+        path = argv[3];
+
+    const size_t texels = static_cast< size_t >( resolution ) * resolution;
+    std::vector< glm::vec4 > displacement( texels );
+    std::vector< glm::vec4 > normals( texels, glm::vec4( 0.0f, 1.0f, 0.0f, 0.0f ) );
+
+    RingExport ring( path, resolution, 128.0f, 1.0f / 60.0f );
+    RingView view( path );
+
+    std::atomic< bool > done( false );
+    unsigned long readFrames = 0, tornFrames = 0, wrongFrames = 0;
+    std::thread reader( [ & ]()
+    {
+        std::uint64_t last = ~std::uint64_t( 0 );
+        while( !done )
+        {
+            RingView::FrameRef ref;
+            if( !view.acquireLatest( ref ) || ref.frame->frame == last )
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            const std::uint64_t frame = ref.frame->frame;
+            const float expected = static_cast< float >( frame );
+            bool consistent = true;
+            for( size_t i = 0; i < texels; i += 97 )
+                consistent = consistent && ref.heights[i] == expected && ref.normals[ i * 3 + 1 ] == 1.0f;
+            consistent = consistent && ref.heights[ texels - 1 ] == expected;
+            if( !view.isValid( ref ) )
+            {
+                tornFrames++;
+                continue;
+            }
+            readFrames++;
+            wrongFrames += consistent ? 0 : 1;
+            last = frame;
+        }
+    } );
+
+    RingExportParameters parameters;
+    const auto begin = std::chrono::steady_clock::now();
+    for( int frame = 0; frame < frames; frame++ )
+    {
+        for( size_t i = 0; i < texels; i++ )
+            displacement[i].y = static_cast< float >( frame );
+        ring.write( frame / 60.0, parameters, displacement, normals );
+    }
+    const std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - begin;
+    done = true;
+    reader.join();
+
+    const double framesPerSecond = frames / elapsed.count();
+    std::cout << "Ring export, " << resolution << " x " << resolution << ", " << ring.getFileSize() / ( 1024 * 1024 ) << " MB file\n";
+    std::cout << std::fixed << std::setprecision( 3 );
+    std::cout << "write : " << elapsed.count() * 1000.0 / frames << " ms per frame, " << std::setprecision( 0 ) << framesPerSecond << " frames per second\n";
+    std::cout << "read in place : " << readFrames << " frames, " << tornFrames << " overwritten while read, " << wrongFrames << " inconsistent" << std::endl;
+    std::remove( path.c_str() );
+    return framesPerSecond >= 60.0 && wrongFrames == 0 ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#include <oceancpu.hpp>
+#include <simd.hpp>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+
+// Throughput of the CPU spectral ocean : milliseconds per frame for every grid size and thread count
+// Usage : fftbench [ max threads ] [ frames ]
+int main( int argc, char ** argv )
+{
+    unsigned int maxThreads = std::max( 1u, std::thread::hardware_concurrency() );
+    int frames = 50;
+    if( argc > 1 )
+        maxThreads = std::max( 1, std::stoi( argv[1] ) );
+    if( argc > 2 )
+        frames = std::max( 1, std::stoi( argv[2] ) );
+
+    const int sizes[] = { 64, 128, 256, 512, 1024 };
+
+    std::cout << "CPU FFT ocean, " << SIMD_NAME << " kernels, " << frames << " frames per measure\n";
+    std::cout << std::setw( 8 ) << "grid";
+    for( unsigned int threads = 1; threads <= maxThreads; threads++ )
+        std::cout << std::setw( 12 ) << ( std::to_string( threads ) + " thr ms" );
+    std::cout << std::endl;
+
+    for( int size : sizes )
+    {
+        std::cout << std::setw( 8 ) << ( std::to_string( size ) + "²" );
+        for( unsigned int threads = 1; threads <= maxThreads; threads++ )
+        {
+            OceanCPU ocean( size, 128.0f, threads );
+            ocean.update( 0.0f ); // warm up the caches and the workers
+
+            auto start = std::chrono::steady_clock::now();
+            for( int i = 0; i < frames; i++ )
+                ocean.update( i / 60.0f );
+            std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+
+            std::cout << std::setw( 12 ) << std::fixed << std::setprecision( 3 ) << elapsed.count() / frames;
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
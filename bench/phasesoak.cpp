@@ -0,0 +1,157 @@
+#include <wavephases.hpp>
+#include <wavespectrum.hpp>
+#include <oceancpu.hpp>
+#include <glm/gtc/constants.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Largest phase error the accumulated phases may reach, a few float roundings of a value below 2 pi
+#define PHASE_TOLERANCE 1e-5
+// Same for the FFT ocean, the float frequencies are a few roundings off the exact multiples of 2 pi / OCEAN_PERIOD and
+// the GPU takes a float product of omega and the wrapped time, which reaches a few thousand radians
+#define FFT_PHASE_TOLERANCE 1e-3
+// Grid of the FFT ocean in the application, its wavenumbers are sampled at this many lengths
+#define FFT_RESOLUTION 256
+#define FFT_PATCH_SIZE 128.0
+#define FFT_SAMPLES 64
+
+// Distance between two phases on the circle
+static double phaseDistance( long double a, long double b )
+{
+    return static_cast< double >( std::abs( std::remainder( a - b, 2.0L * glm::pi< long double >() ) ) );
+}
+
+// Soak test of the wave time base : from large elapsed times, the phases accumulated by WavePhases at 60 Hz are
+// compared with omega * time computed in long double, next to what the former float clock gave
+// The step error is how far one frame's phase increment is from omega * dt, the stutter seen on screen
+// The phases of the FFT ocean are then checked the same way : wrapped in double on the CPU ( OceanCPU ), omega times
+// the time wrapped to the period in float on the GPU ( fft_spectrum.fs )
+// Usage : phasesoak [ seconds simulated per start time ]
+int main( int argc, char ** argv )
+{
+    double duration = 600.0;
+    if( argc > 1 )
+        duration = std::max( 1.0, std::stod( argv[1] ) );
+
+    WaveSpectrum spectrum;
+    SpectrumParameters parameters;
+    parameters.type = SPECTRUM_JONSWAP;
+    parameters.waveCount = 256;
+    parameters.speed = 2.0f;
+    spectrum.setParameters( parameters );
+    const std::vector< WaveComponent > & waves = spectrum.getWaves();
+
+    const double dt = 1.0 / 60.0;
+    const long ticks = static_cast< long >( duration / dt );
+    const double starts[] = { 0.0, 3600.0, 86400.0, 30.0 * 86400.0, 365.0 * 86400.0 };
+    const char * startNames[] = { "0", "1 hour", "1 day", "30 days", "1 year" };
+
+    std::cout << "Phase soak, " << waves.size() << " waves, " << ticks << " ticks at 60 Hz from each start time\n";
+    std::cout << std::setw( 10 ) << "start" << std::setw( 16 ) << "double error" << std::setw( 16 ) << "double step"
+              << std::setw( 16 ) << "float error" << std::setw( 16 ) << "float step" << std::endl;
+
+    bool passed = true;
+    for( int s = 0; s < 5; s++ )
+    {
+        WavePhases phases;
+        std::vector< float > previousFloat( waves.size() );
+        std::vector< float > previousDouble( waves.size() );
+        double doubleError = 0.0, doubleStep = 0.0, floatError = 0.0, floatStep = 0.0;
+
+        for( long tick = 0; tick <= ticks; tick++ )
+        {
+            const double time = starts[s] + tick * dt;
+            phases.advance( waves, time );
+            const std::vector< float > & current = phases.getPhases();
+            const float floatTime = static_cast< float >( time );
+
+            for( size_t i = 0; i < waves.size(); i++ )
+            {
+                const long double exact = static_cast< long double >( waves[i].omega ) * time;
+                // What the shader computed with the float time uniform
+                const float legacy = waves[i].omega * floatTime;
+                doubleError = std::max( doubleError, phaseDistance( current[i], exact ) );
+                floatError = std::max( floatError, phaseDistance( legacy, exact ) );
+                if( tick > 0 )
+                {
+                    const long double expected = static_cast< long double >( waves[i].omega ) * dt;
+                    doubleStep = std::max( doubleStep, phaseDistance( static_cast< long double >( current[i] ) - previousDouble[i], expected ) );
+                    floatStep = std::max( floatStep, phaseDistance( static_cast< long double >( legacy ) - previousFloat[i], expected ) );
+                }
+                previousDouble[i] = current[i];
+                previousFloat[i] = legacy;
+            }
+        }
+
+        passed = passed && doubleError < PHASE_TOLERANCE;
+        std::cout << std::setw( 10 ) << startNames[s] << std::scientific << std::setprecision( 3 )
+                  << std::setw( 16 ) << doubleError << std::setw( 16 ) << doubleStep
+                  << std::setw( 16 ) << floatError << std::setw( 16 ) << floatStep << std::endl;
+    }
+
+    // From the shortest wavelength of the grid, along its diagonal, to the longest. The reference frequencies are the
+    // exact multiples of 2 pi / OCEAN_PERIOD the float ones stand for
+    std::vector< float > omegas( FFT_SAMPLES );
+    std::vector< long double > exactOmegas( FFT_SAMPLES );
+    const double kMin = glm::two_pi< double >() / FFT_PATCH_SIZE;
+    const double kMax = kMin * FFT_RESOLUTION / 2 * std::sqrt( 2.0 );
+    const long double omegaStep = 2.0L * glm::pi< long double >() / OCEAN_PERIOD;
+    for( int i = 0; i < FFT_SAMPLES; i++ )
+    {
+        omegas[i] = dispersion( static_cast< float >( kMin * std::pow( kMax / kMin, i / ( FFT_SAMPLES - 1.0 ) ) ) );
+        exactOmegas[i] = std::round( omegas[i] / omegaStep ) * omegaStep;
+    }
+
+    std::cout << "\nFFT ocean phases, " << FFT_SAMPLES << " wavenumbers of the " << FFT_RESOLUTION << "² grid over "
+              << static_cast< int >( FFT_PATCH_SIZE ) << " m, period " << static_cast< int >( OCEAN_PERIOD ) << " s\n";
+    std::cout << std::setw( 10 ) << "start" << std::setw( 16 ) << "CPU error" << std::setw( 16 ) << "CPU step"
+              << std::setw( 16 ) << "GPU error" << std::setw( 16 ) << "GPU step"
+              << std::setw( 16 ) << "float error" << std::setw( 16 ) << "float step" << std::endl;
+    bool fftPassed = true;
+    for( int s = 0; s < 5; s++ )
+    {
+        std::vector< float > previousCpu( FFT_SAMPLES ), previousGpu( FFT_SAMPLES ), previousFloat( FFT_SAMPLES );
+        double cpuError = 0.0, cpuStep = 0.0, gpuError = 0.0, gpuStep = 0.0, floatError = 0.0, floatStep = 0.0;
+
+        for( long tick = 0; tick <= ticks; tick++ )
+        {
+            const double time = starts[s] + tick * dt;
+            const double cycle = oceanCycle( time );
+            const float floatTime = static_cast< float >( time );
+            for( int i = 0; i < FFT_SAMPLES; i++ )
+            {
+                const long double exact = exactOmegas[i] * time;
+                // OceanCPU, then fft_spectrum.fs given the wrapped time as a float, then the former float clock
+                const float cpu = wavePhase( omegas[i], cycle );
+                const float gpu = omegas[i] * static_cast< float >( cycle );
+                const float legacy = omegas[i] * floatTime;
+                cpuError = std::max( cpuError, phaseDistance( cpu, exact ) );
+                gpuError = std::max( gpuError, phaseDistance( gpu, exact ) );
+                floatError = std::max( floatError, phaseDistance( legacy, exact ) );
+                if( tick > 0 )
+                {
+                    const long double expected = exactOmegas[i] * dt;
+                    cpuStep = std::max( cpuStep, phaseDistance( static_cast< long double >( cpu ) - previousCpu[i], expected ) );
+                    gpuStep = std::max( gpuStep, phaseDistance( static_cast< long double >( gpu ) - previousGpu[i], expected ) );
+                    floatStep = std::max( floatStep, phaseDistance( static_cast< long double >( legacy ) - previousFloat[i], expected ) );
+                }
+                previousCpu[i] = cpu;
+                previousGpu[i] = gpu;
+                previousFloat[i] = legacy;
+            }
+        }
+
+        fftPassed = fftPassed && cpuError < FFT_PHASE_TOLERANCE && gpuError < FFT_PHASE_TOLERANCE;
+        std::cout << std::setw( 10 ) << startNames[s] << std::scientific << std::setprecision( 3 )
+                  << std::setw( 16 ) << cpuError << std::setw( 16 ) << cpuStep << std::setw( 16 ) << gpuError << std::setw( 16 ) << gpuStep
+                  << std::setw( 16 ) << floatError << std::setw( 16 ) << floatStep << std::endl;
+    }
+
+    std::cout << ( passed ? "Passed" : "Failed" ) << " : accumulated phases within " << PHASE_TOLERANCE << " rad\n"
+              << ( fftPassed ? "Passed" : "Failed" ) << " : FFT phases within " << FFT_PHASE_TOLERANCE << " rad" << std::endl;
+    return passed && fftPassed ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+#include <wavequery.hpp>
+#include <wavephases.hpp>
+#include <simd.hpp>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <random>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Largest height difference allowed between the queries and the surface drawn with the same phases, m
+#define PHASE_HEIGHT_TOLERANCE 1e-3f
+
+// Cost of one simulation tick of surface queries : exact evaluation against the cached tile ( rebuild included )
+// Then the speed is changed halfway through a minute at 60 Hz and the queries given the phases of WavePhases are
+// compared with the shader port fed the same phases, the surface drawn, next to queries computing omega * time
+// Usage : querybench [ threads ] [ ticks ]
+int main( int argc, char ** argv )
+{
+    unsigned int threads = std::max( 1u, std::thread::hardware_concurrency() );
+    int ticks = 10;
+    if( argc > 1 )
+        threads = std::max( 1, std::stoi( argv[1] ) );
+    if( argc > 2 )
+        ticks = std::max( 1, std::stoi( argv[2] ) );
+
+    const int waveCount = 64;
+    WaveSpectrum spectrum;
+    SpectrumParameters parameters;
+    parameters.type = SPECTRUM_JONSWAP;
+    parameters.waveCount = waveCount;
+    spectrum.setParameters( parameters );
+
+    WaveQuery query( 128, 256.0f, threads );
+    query.setWaves( spectrum );
+
+    std::cout << "Surface queries, " << SIMD_NAME << " kernels, " << waveCount << " waves, "
+              << query.getResolution() << "² tile over " << query.getTileSize() << " m, " << threads << " threads for the rebuild\n";
+    std::cout << std::setw( 10 ) << "points" << std::setw( 12 ) << "exact ms" << std::setw( 12 ) << "cached ms"
+              << std::setw( 10 ) << "speedup" << std::setw( 14 ) << "max dh ( m )" << std::setw( 14 ) << "max dn" << std::endl;
+
+    const int counts[] = { 1000, 10000, 100000, 1000000 };
+    for( int count : counts )
+    {
+        // Objects scattered over the tile
+        std::mt19937 generator( 42 );
+        std::uniform_real_distribution< float > position( -120.0f, 120.0f );
+        std::vector< float > x( count ), z( count );
+        for( int i = 0; i < count; i++ )
+        {
+            x[i] = position( generator );
+            z[i] = position( generator );
+        }
+        std::vector< float > exact[ 4 ], cached[ 4 ];
+        for( int f = 0; f < 4; f++ )
+        {
+            exact[f].resize( count );
+            cached[f].resize( count );
+        }
+        SurfaceBatch exactBatch = { x.data(), z.data(), exact[0].data(), exact[1].data(), exact[2].data(), exact[3].data(), count };
+        SurfaceBatch cachedBatch = { x.data(), z.data(), cached[0].data(), cached[1].data(), cached[2].data(), cached[3].data(), count };
+
+        auto measure = [ & ]( const SurfaceBatch & batch, QueryMode mode )
+        {
+            // Every tick has a new time so every cached tick pays for its rebuild
+            auto start = std::chrono::steady_clock::now();
+            for( int tick = 0; tick < ticks; tick++ )
+                query.query( batch, tick / 60.0f, mode );
+            std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count() / ticks;
+        };
+        double exactTime = measure( exactBatch, QUERY_EXACT );
+        double cachedTime = measure( cachedBatch, QUERY_CACHED );
+
+        float heightError = 0.0f, normalError = 0.0f;
+        for( int i = 0; i < count; i++ )
+        {
+            heightError = std::max( heightError, std::abs( exact[0][i] - cached[0][i] ) );
+            glm::vec3 difference = glm::vec3( exact[1][i], exact[2][i], exact[3][i] ) - glm::vec3( cached[1][i], cached[2][i], cached[3][i] );
+            normalError = std::max( normalError, glm::length( difference ) );
+        }
+
+        std::cout << std::setw( 10 ) << count << std::fixed << std::setprecision( 3 )
+                  << std::setw( 12 ) << exactTime << std::setw( 12 ) << cachedTime
+                  << std::setw( 10 ) << std::setprecision( 2 ) << exactTime / cachedTime
+                  << std::setw( 14 ) << std::setprecision( 4 ) << heightError << std::setw( 14 ) << normalError << std::endl;
+    }
+
+    const int count = 10000;
+    std::mt19937 generator( 7 );
+    std::uniform_real_distribution< float > position( -120.0f, 120.0f );
+    std::vector< float > x( count ), z( count );
+    for( int i = 0; i < count; i++ )
+    {
+        x[i] = position( generator );
+        z[i] = position( generator );
+    }
+    std::vector< float > drawn[ 4 ], phased[ 4 ], absolute[ 4 ];
+    for( int f = 0; f < 4; f++ )
+    {
+        drawn[f].resize( count );
+        phased[f].resize( count );
+        absolute[f].resize( count );
+    }
+
+    WavePhases phases;
+    double time = 0.0;
+    for( int tick = 0; tick <= 3600; tick++ )
+    {
+        time = tick / 60.0;
+        if( tick == 1800 )
+        {
+            parameters.speed = 2.0f;
+            spectrum.setParameters( parameters );
+            query.setWaves( spectrum );
+        }
+        phases.advance( spectrum.getWaves(), time );
+    }
+    const std::vector< WaveComponent > & waves = spectrum.getWaves();
+    SurfaceBatch drawnBatch = { x.data(), z.data(), drawn[0].data(), drawn[1].data(), drawn[2].data(), drawn[3].data(), count };
+    drawnBatch.phases = phases.getPhases().data();
+    evaluateWavesReference( waves.data(), static_cast< int >( waves.size() ), time, drawnBatch );
+    SurfaceBatch phasedBatch = { x.data(), z.data(), phased[0].data(), phased[1].data(), phased[2].data(), phased[3].data(), count };
+    phasedBatch.phases = phases.getPhases().data();
+    query.query( phasedBatch, time, QUERY_EXACT );
+    SurfaceBatch absoluteBatch = { x.data(), z.data(), absolute[0].data(), absolute[1].data(), absolute[2].data(), absolute[3].data(), count };
+    query.query( absoluteBatch, time, QUERY_EXACT );
+
+    float phasedError = 0.0f, absoluteError = 0.0f;
+    for( int i = 0; i < count; i++ )
+    {
+        phasedError = std::max( phasedError, std::abs( phased[0][i] - drawn[0][i] ) );
+        absoluteError = std::max( absoluteError, std::abs( absolute[0][i] - drawn[0][i] ) );
+    }
+    const bool passed = phasedError < PHASE_HEIGHT_TOLERANCE;
+    std::cout << "Speed doubled after 30 s, max dh against the drawn surface after 60 s : " << std::scientific << std::setprecision( 3 )
+              << phasedError << " m with the accumulated phases, " << absoluteError << " m with omega * time\n"
+              << ( passed ? "Passed" : "Failed" ) << " : queries within " << PHASE_HEIGHT_TOLERANCE << " m of the drawn surface" << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include <spray.hpp>
+#include <wavespectrum.hpp>
+#include <simd.hpp>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <algorithm>
+
+// Cost of the spray particles with a full pool : milliseconds per update for each thread count, and of the
+// emission on the crests of a JONSWAP sea. Fails when the update of 4 threads or more takes over 2 ms
+// Usage : spraybench [ max threads ] [ particles ] [ frames ]
+int main( int argc, char ** argv )
+{
+    unsigned int maxThreads = std::max( 1u, std::thread::hardware_concurrency() );
+    int particles = 500000;
+    int frames = 100;
+    if( argc > 1 )
+        maxThreads = std::max( 1, std::stoi( argv[1] ) );
+    if( argc > 2 )
+        particles = std::max( 1, std::stoi( argv[2] ) );
+    if( argc > 3 )
+        frames = std::max( 1, std::stoi( argv[3] ) );
+
+    WaveSpectrum spectrum;
+    SpectrumParameters spectrumParameters;
+    spectrumParameters.type = SPECTRUM_JONSWAP;
+    spectrumParameters.waveCount = 64;
+    spectrumParameters.windSpeed = 15.0f;
+    spectrum.setParameters( spectrumParameters );
+
+    // Lives long enough for the pool to stay full over the measure, the emission only refills it
+    SprayParameters parameters;
+    parameters.steepness = 0.2f;
+    parameters.sprayLife = 1000.0f;
+    parameters.emissionRate = 1e5f;
+
+    const float dt = 1.0f / 60.0f;
+    std::cout << "Spray, " << SIMD_NAME << " update, " << particles << " particles, " << frames << " frames per measure\n";
+    std::cout << std::setw( 8 ) << "threads" << std::setw( 12 ) << "live" << std::setw( 12 ) << "update ms" << std::setw( 12 ) << "emit ms" << std::setw( 12 ) << "crests" << std::endl;
+
+    double verdict = -1.0;
+    for( unsigned int threads = 1; threads <= maxThreads; threads++ )
+    {
+        Spray spray( particles, 128, 128.0f, threads );
+        spray.setWaves( spectrum );
+        spray.setParameters( parameters );
+        double time = 0.0;
+        for( int i = 0; i < 100 && spray.getLiveCount() < spray.getCapacity(); i++, time += dt )
+            spray.emit( time, dt );
+
+        std::chrono::duration< double > updateTime( 0.0 ), emitTime( 0.0 );
+        for( int i = 0; i < frames; i++, time += dt )
+        {
+            auto start = std::chrono::steady_clock::now();
+            spray.emit( time, dt );
+            auto middle = std::chrono::steady_clock::now();
+            spray.update( dt );
+            updateTime += std::chrono::steady_clock::now() - middle;
+            emitTime += middle - start;
+        }
+        const double updateMilliseconds = updateTime.count() * 1000.0 / frames;
+        std::cout << std::setw( 8 ) << threads << std::setw( 12 ) << spray.getLiveCount() << std::fixed << std::setprecision( 3 )
+                  << std::setw( 12 ) << updateMilliseconds << std::setw( 12 ) << emitTime.count() * 1000.0 / frames
+                  << std::setw( 12 ) << spray.getCrestCount() << std::endl;
+        if( threads >= 4 )
+            verdict = verdict < 0.0 ? updateMilliseconds : std::min( verdict, updateMilliseconds );
+    }
+
+    if( verdict < 0.0 )
+    {
+        std::cout << "\nfewer than 4 threads measured, no verdict against the 2 ms target" << std::endl;
+        return 0;
+    }
+    std::cout << "\nbest update with 4 threads or more : " << verdict << " ms, target 2 ms" << std::endl;
+    return verdict <= 2.0 ? 0 : 1;
+}
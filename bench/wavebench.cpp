@@ -0,0 +1,106 @@
+#include <wavecpu.hpp>
+#include <wavespectrum.hpp>
+#include <threadpool.hpp>
+#include <simd.hpp>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+typedef void ( * WaveKernel )( const WaveComponent *, int, double, const SurfaceBatch & );
+
+// Million points per second of kernel over a points² grid split between the workers of pool
+static double measure( ThreadPool & pool, WaveKernel kernel, const std::vector< WaveComponent > & waves, int points, int frames )
+{
+    const int count = points * points;
+    std::vector< float > x( count ), z( count ), height( count ), normalX( count ), normalY( count ), normalZ( count );
+    for( int i = 0; i < count; i++ )
+    {
+        x[i] = ( i % points ) * 0.5f;
+        z[i] = ( i / points ) * 0.5f;
+    }
+
+    auto run = [ & ]( float time )
+    {
+        pool.parallelFor( count, [ & ]( int begin, int end )
+        {
+            SurfaceBatch batch = { &x[ begin ], &z[ begin ], &height[ begin ], &normalX[ begin ], &normalY[ begin ], &normalZ[ begin ], end - begin };
+            kernel( waves.data(), static_cast< int >( waves.size() ), time, batch );
+        }, 64 );
+    };
+    run( 0.0f ); // warm up the caches and the workers
+
+    auto start = std::chrono::steady_clock::now();
+    for( int i = 0; i < frames; i++ )
+        run( i / 60.0f );
+    std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast< double >( count ) * frames / elapsed.count() * 1e-6;
+}
+
+static std::vector< WaveComponent > makeWaves( int waveCount )
+{
+    WaveSpectrum spectrum;
+    SpectrumParameters parameters;
+    parameters.type = SPECTRUM_JONSWAP;
+    parameters.waveCount = waveCount;
+    spectrum.setParameters( parameters );
+    return spectrum.getWaves();
+}
+
+// Throughput of the CPU port of wave() : million points per second per core for each kernel and wave count,
+// then the scaling of the fastest kernel across threads
+// Usage : wavebench [ max threads ] [ frames ]
+int main( int argc, char ** argv )
+{
+    unsigned int maxThreads = std::max( 1u, std::thread::hardware_concurrency() );
+    int frames = 10;
+    if( argc > 1 )
+        maxThreads = std::max( 1, std::stoi( argv[1] ) );
+    if( argc > 2 )
+        frames = std::max( 1, std::stoi( argv[2] ) );
+
+    const int points = 256;
+    const int waveCounts[] = { 8, 16, 32, 64 };
+    const struct { const char * name; WaveKernel kernel; } kernels[] =
+    {
+        { "scalar ref", evaluateWavesReference },
+        { "simd loop", evaluateWavesLoop },
+        { "simd fixed", evaluateWaves } // dispatches to the unrolled kernels for these counts
+    };
+
+    std::cout << "CPU wave(), " << SIMD_NAME << " kernels, " << points << "² points, " << frames << " frames per measure\n";
+    std::cout << "Mpoints/s on one core\n" << std::setw( 12 ) << "kernel";
+    for( int waveCount : waveCounts )
+        std::cout << std::setw( 12 ) << ( std::to_string( waveCount ) + " waves" );
+    std::cout << std::endl;
+
+    ThreadPool single( 1 );
+    for( const auto & kernel : kernels )
+    {
+        std::cout << std::setw( 12 ) << kernel.name;
+        for( int waveCount : waveCounts )
+        {
+            std::cout << std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << measure( single, kernel.kernel, makeWaves( waveCount ), points, frames );
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "\nsimd fixed, Mpoints/s per core across threads\n" << std::setw( 12 ) << "threads";
+    for( int waveCount : waveCounts )
+        std::cout << std::setw( 12 ) << ( std::to_string( waveCount ) + " waves" );
+    std::cout << std::endl;
+    for( unsigned int threads = 1; threads <= maxThreads; threads++ )
+    {
+        ThreadPool pool( threads );
+        std::cout << std::setw( 12 ) << threads;
+        for( int waveCount : waveCounts )
+        {
+            std::cout << std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << measure( pool, evaluateWaves, makeWaves( waveCount ), points, frames ) / threads;
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+#ifndef BAKEDWAVES_HPP
+#define BAKEDWAVES_HPP
+
+#include <wavespectrum.hpp>
+#include <threadpool.hpp>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Sum of waves baked into a looping animation and played back with one fetch per vertex and per fragment
+// The table is quantized so the surface repeats every tileSize meters and every period seconds, the frames
+// are stored in an RGBA16F 3D texture ( normal.xyz, height ) whose third axis is time : with REPEAT on every
+// axis a trilinear fetch blends two frames and wraps seamlessly in space and time
+// Bakes run on a background thread once the spectrum stopped changing, update() uploads them on the GL thread
+class BakedWaves
+{
+    public :
+        BakedWaves( int resolution = 256, int frameCount = 64, float tileSize = 256.0f, float period = 32.0f,
+                    unsigned int threadCount = std::max( 2u, std::thread::hardware_concurrency() ) - 1 );
+        ~BakedWaves();
+
+        BakedWaves( const BakedWaves & ) = delete;
+        BakedWaves & operator=( const BakedWaves & ) = delete;
+
+        // Call every frame from the GL thread with the current time in seconds
+        void update( const WaveSpectrum & spectrum, double now );
+        void bind( unsigned int unit ) const noexcept;
+
+        // True when the texture holds the current spectrum
+        bool isReady() const noexcept;
+        bool isBaking() const noexcept;
+        // Fraction of the frames of the running bake already computed
+        float getProgress() const noexcept;
+        // Position of the given time in the loop, in [ 0, 1 )
+        float getCycle( double time ) const noexcept;
+
+        float getTileSize() const noexcept;
+        float getPeriod() const noexcept;
+        size_t getMemorySize() const noexcept; // bytes of the texture
+        float getBakeTime() const noexcept; // seconds taken by the last finished bake
+
+        // Rounds every wave vector to a multiple of 2 pi / tileSize and every frequency to a multiple of 2 pi / period,
+        // waves shorter than maxWavenumber allows are dropped since the texture could not resolve them
+        static std::vector< WaveComponent > makePeriodic( const std::vector< WaveComponent > & waves, float tileSize, float period, float maxWavenumber );
+
+    private :
+        int resolution;
+        int frameCount;
+        float tileSize;
+        float period;
+        ThreadPool pool;
+        unsigned int texture = 0;
+
+        unsigned long targetVersion = 0; // spectrum version seen last
+        double changeTime = 0.0; // when it was first seen
+        unsigned long bakingVersion = 0;
+        unsigned long readyVersion = 0;
+
+        std::thread worker;
+        std::atomic< bool > cancel;
+        std::atomic< bool > done;
+        std::atomic< int > framesDone;
+        std::atomic< float > bakeTime; // written by the worker, read by getBakeTime
+        std::vector< unsigned short > pixels; // half floats written by the worker
+
+        void bake( std::vector< WaveComponent > waves ) noexcept;
+        void stopWorker() noexcept;
+};
+
+#endif
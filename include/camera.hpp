@@ -18,6 +18,8 @@ enum CameraMovement
     NONE
 };
 
+// The position is kept in double precision, the rendering sees it relative to an origin on the sea plane moved
+// near the camera in steps, see rebase, so the floats of the GPU stay small however far the camera flies
 class Camera
 {
     public :
@@ -27,6 +29,13 @@ class Camera
         void onMouseMove( float xOffset, float yOffset, bool constrainPitch = true ) noexcept;
         void onScroll( float offset ) noexcept;
 
+        // Moves the origin to the multiple of step nearest the camera once the camera is more than step away from it
+        // along x or z, returns true when it moved
+        bool rebase( double step ) noexcept;
+        void setOrigin( glm::dvec2 origin ) noexcept;
+        void translate( glm::dvec3 offset ) noexcept;
+
+        // Relative to the origin
         glm::mat4 getViewMat() const noexcept;
 
         float getFov() const noexcept;
@@ -38,10 +47,13 @@ class Camera
         glm::vec3 getRight() const noexcept;
         glm::vec3 getUp() const noexcept;
         glm::vec3 getFront() const noexcept;
-        glm::vec3 getPosition() const noexcept;
+        glm::vec3 getPosition() const noexcept; // relative to the origin
+        glm::dvec3 getWorldPosition() const noexcept;
+        glm::dvec2 getOrigin() const noexcept; // world ( x, z ) of the origin
     
     private :
-        glm::vec3 position;
+        glm::dvec3 position;
+        glm::dvec2 origin = glm::dvec2( 0.0 );
         glm::vec3 front;
         glm::vec3 up;
         glm::vec3 right;
@@ -0,0 +1,70 @@
+#ifndef CLIPMAP_HPP
+#define CLIPMAP_HPP
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// Nested square rings of grid around the camera, each level twice as coarse and twice as wide as the one inside it,
+// so the sea reaches far for a vertex count growing with the number of levels only
+// Every level is a grid of 2 * ringCells cells across, the innermost one full and the others with a hole where the
+// level inside sits. Each level is snapped to twice its cell size so its vertices do not swim, which puts the hole
+// one cell off center along each axis half of the time : the rings come in 4 index layouts, all over the same
+// vertex buffer in cells that the instances scale and move, and the levels sharing a layout are drawn by one
+// instanced call. The outermost row of cells of a level only uses every other vertex of its edge, so the edge
+// matches the coarser level around it and the displaced surface has no cracks
+class Clipmap
+{
+    public :
+        // ringCells is rounded up to an even count of at least 8, ( 2 * ringCells + 1 )² vertices must fit 16 bit indices
+        Clipmap( int levels = 3, int ringCells = 64, float cellSize = 0.5f );
+        ~Clipmap();
+
+        Clipmap( const Clipmap & ) = delete;
+        Clipmap & operator=( const Clipmap & ) = delete;
+
+        // Snaps the levels around the camera
+        void update( glm::vec3 cameraPosition ) noexcept;
+        // Draws the levels with the water program active, see water.vs
+        void draw() const noexcept;
+        // See Mesh, every vertex of every level is captured once, the levels are then drawn from the capture
+        void capture() const noexcept;
+        void drawCaptured() const noexcept;
+
+        int getLevelCount() const noexcept;
+        // Vertices the level draws
+        unsigned int getLevelVertexCount( int level ) const noexcept;
+        unsigned int getVertexCount() const noexcept;
+        float getCellSize() const noexcept; // of the innermost level
+        float getExtent() const noexcept; // width of the outermost level
+
+        // Smallest number of levels reaching distance away from the camera in every direction
+        static int levelsFor( float distance, int ringCells = 64, float cellSize = 0.5f ) noexcept;
+
+    private :
+        // Index layouts : the full square, then the rings with their hole shifted by one cell along x and z or not
+        static const int LAYOUT_COUNT = 5;
+
+        struct Level
+        {
+            glm::vec3 instance; // ( x, z ) of the first corner and cell size
+            int layout;
+        };
+
+        int levels;
+        int ringCells;
+        float cellSize;
+        int side; // vertices across a level
+        unsigned int layoutFirst[ LAYOUT_COUNT ]; // first index of the layout in the index buffer
+        unsigned int layoutCount[ LAYOUT_COUNT ];
+        unsigned int layoutVertices[ LAYOUT_COUNT ];
+        std::vector< Level > placed; // levels in the order of the instance buffer, grouped by layout
+        int layoutInstances[ LAYOUT_COUNT ] = {};
+        int layoutBase[ LAYOUT_COUNT ] = {}; // first instance of the layout
+
+        unsigned int vao, vbo, ebo, instanceBuffer;
+        unsigned int feedbackBuffer, capturedVao;
+
+        void buildLayout( int layout, std::vector< unsigned short > & indices ) noexcept;
+};
+
+#endif
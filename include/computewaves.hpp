@@ -0,0 +1,48 @@
+#ifndef COMPUTEWAVES_HPP
+#define COMPUTEWAVES_HPP
+
+#include <glm/glm.hpp>
+#include <shader.hpp>
+#include <memory>
+
+// Sum of waves evaluated by compute shaders ( GL 4.3 ) into displacement and normal maps over a square window
+// following the camera, the vertex stage then samples them instead of looping over the waves. Every work group
+// loads the wave table in chunks into shared memory, so each wave is fetched once per group rather than per texel
+// Waves shorter than two texels are left out of the maps, 1024 texels over 256 m keep wavelengths down to 0.5 m
+// Throws when the context has no compute shaders, the sum of waves stays in the vertex stage then
+class ComputeWaves
+{
+    public :
+        // loader resolves the GL 4.3 entry points glad was not generated for, glfwGetProcAddress for instance
+        ComputeWaves( void * ( *loader )( const char * ), int resolution = 1024, float size = 256.0f );
+        ~ComputeWaves();
+
+        ComputeWaves( const ComputeWaves & ) = delete;
+        ComputeWaves & operator=( const ComputeWaves & ) = delete;
+
+        // Fills the maps around center with the waves of the table and phases bound to the given buffer texture units
+        void update( int waveCount, unsigned int tableUnit, unsigned int phasesUnit, glm::vec2 center ) noexcept;
+
+        // Binds the displacement map ( 0, h, 0 ) and the normal map, sampled at ( pos.xz - origin ) / size
+        void bindMaps( unsigned int displacementUnit, unsigned int normalUnit ) const noexcept;
+
+        // World position of the window's first corner, in meters
+        glm::vec2 getOrigin() const noexcept;
+        float getSize() const noexcept;
+        int getResolution() const noexcept;
+
+    private :
+        int resolution;
+        float size;
+        glm::vec2 origin = glm::vec2( 0.0f );
+
+        std::unique_ptr< Shader > shader;
+        unsigned int textures[ 2 ] = {};
+
+        // GL 4.3 entry points, cast to their types in the source
+        void * dispatchCompute = nullptr;
+        void * bindImageTexture = nullptr;
+        void * memoryBarrier = nullptr;
+};
+
+#endif
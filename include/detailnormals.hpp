@@ -0,0 +1,44 @@
+#ifndef DETAILNORMALS_HPP
+#define DETAILNORMALS_HPP
+
+#include <shader.hpp>
+#include <wavespectrum.hpp>
+#include <vector>
+
+// Slopes of the short waves of the sum of waves rendered once per frame into a tiling mipmapped texture, so the
+// fragment stage gets their detail whatever the density of the water mesh. The vertex stage only keeps the waves
+// long enough for the mesh to follow, the split is picked from the mesh spacing by firstDetailWave
+class DetailNormals
+{
+    public :
+        // resolution² texels over a tileSize² m tile, repeated over the whole surface
+        DetailNormals( int resolution = 512, float tileSize = 64.0f );
+        ~DetailNormals();
+
+        DetailNormals( const DetailNormals & ) = delete;
+        DetailNormals & operator=( const DetailNormals & ) = delete;
+
+        // Index of the first wave of the table shorter than the mesh can show : wavelengths below cellsPerWave
+        // times the spacing, or below a quarter of the tile so that moving them onto its lattice stays a small change
+        // The legacy table only comes by increasing wavenumber after its first wave, which is always kept
+        int firstDetailWave( const std::vector< WaveComponent > & waves, int waveCount, float meshSpacing, float cellsPerWave = 4.0f ) const noexcept;
+
+        // Renders waves [ firstWave, lastWave ) of the table bound to tableUnit, with the phases bound to phasesUnit
+        // origin is the world point the phases were moved to, see WavePhases, a multiple of the tile size
+        void update( int firstWave, int lastWave, unsigned int tableUnit, unsigned int phasesUnit, glm::vec2 origin = glm::vec2( 0.0f ) ) noexcept;
+        // Binds the ( dh/dx, dh/dz ) texture, sample it with REPEAT at pos.xz / getTileSize()
+        void bind( unsigned int unit ) const noexcept;
+
+        float getTileSize() const noexcept;
+        int getResolution() const noexcept;
+
+    private :
+        int resolution;
+        float tileSize;
+        Shader shader = { "../include/shader/fullscreen.vs", "../include/shader/detail_normals.fs" };
+        unsigned int quadVAO;
+        unsigned int texture;
+        unsigned int framebuffer;
+};
+
+#endif
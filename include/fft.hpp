@@ -0,0 +1,36 @@
+#ifndef FFT_HPP
+#define FFT_HPP
+
+#include <vector>
+
+// Radix-4 / radix-2 Stockham complex FFT working on split real and imaginary planes
+// One call transforms a whole batch of interleaved signals at once : sample j of lane x is stored at
+// data[ j * stride + x ], so every butterfly is a SIMD loop over the lanes ( the columns of a matrix )
+class FFTPlan
+{
+    public :
+        // Plans are built once per size and cached, the returned reference is valid for the program lifetime
+        static const FFTPlan & get( int size );
+
+        // Transforms lanes [ 0, width ) in place, the scratch planes use the same layout as the data
+        // The inverse transform is not normalized
+        void execute( float * re, float * im, float * scratchRe, float * scratchIm, int stride, int width, bool inverse ) const noexcept;
+
+        int getSize() const noexcept;
+
+    private :
+        struct Stage
+        {
+            int radix;
+            int span; // length of the sub-transforms already computed
+            std::vector< float > twiddleRe; // ( radix - 1 ) twiddles for each k in [ 0, span )
+            std::vector< float > twiddleIm;
+        };
+
+        int size;
+        std::vector< Stage > stages;
+
+        explicit FFTPlan( int size );
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef GPUQUADTREE_HPP
+#define GPUQUADTREE_HPP
+
+#include <glm/glm.hpp>
+#include <shader.hpp>
+#include <memory>
+#include <vector>
+
+// The tiles of Quadtree selected and culled by a compute shader ( GL 4.3 ) instead of the CPU. Every node of every
+// level over the roots around the camera gets an invocation, the ones the refinement stops at and the frustum keeps
+// append their tile to their level in the instance buffer and count it into that level's indirect command, so the
+// whole sea is drawn by one glMultiDrawElementsIndirect and the CPU never reads the selection back
+// The CPU cost of a frame stays the same however many tiles are drawn
+// Throws when the context has no compute shaders, the CPU quadtree is used then
+class GpuQuadtree
+{
+    public :
+        // loader resolves the GL 4.3 entry points glad was not generated for, glfwGetProcAddress for instance
+        // The levels and tiles are those of Quadtree, the roots are walked up to distance m from the camera
+        GpuQuadtree( void * ( *loader )( const char * ), int maxLevel = 4, int tileCells = 32, float leafSize = 16.0f, float distance = 100.0f );
+        ~GpuQuadtree();
+
+        GpuQuadtree( const GpuQuadtree & ) = delete;
+        GpuQuadtree & operator=( const GpuQuadtree & ) = delete;
+
+        // Selects the tiles seen through viewProjection, see Quadtree::update
+        void update( const glm::mat4 & viewProjection, glm::vec3 cameraPosition, float height ) noexcept;
+        // Draws the tiles with the water program active, see water.vs
+        void draw() const noexcept;
+        // See Mesh, each level is captured into its own range and every tile is drawn from there
+        void capture() const noexcept;
+        void drawCaptured() const noexcept;
+
+        int getLevelCount() const noexcept;
+        // Tiles the instance buffer has room for, the selection itself stays on the GPU
+        int getCapacity() const noexcept;
+        unsigned int getTileVertexCount() const noexcept;
+
+    private :
+        int maxLevel;
+        int tileCells;
+        float leafSize;
+        float distance;
+        int maxRoots; // roots across the walked square
+        unsigned int indexCount;
+        std::vector< int > levelBase; // first slot of each level in the instance buffer
+        std::vector< int > levelCapacity;
+        int capacity = 0;
+
+        std::unique_ptr< Shader > shader;
+        // One draw command per level, for the elements then the points of the capture, and one per slot for the
+        // draw out of the capture
+        unsigned int vao, vbo, ebo, instanceBuffer, commandBuffer, captureCommandBuffer, capturedCommandBuffer;
+        unsigned int feedbackBuffer, capturedVao;
+
+        // GL 4.3 entry points, cast to their types in the source
+        void * dispatchCompute = nullptr;
+        void * memoryBarrier = nullptr;
+        void * clearBufferData = nullptr;
+        void * drawArraysIndirect = nullptr;
+        void * multiDrawElementsIndirect = nullptr;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef GPUTIMER_HPP
+#define GPUTIMER_HPP
+
+// GPU time of a section of commands measured with GL_TIME_ELAPSED queries
+// Results are read a few frames later when they are available, so measuring never stalls the pipeline
+class GpuTimer
+{
+    public :
+        GpuTimer() noexcept;
+        ~GpuTimer();
+
+        GpuTimer( const GpuTimer & ) = delete;
+        GpuTimer & operator=( const GpuTimer & ) = delete;
+
+        // Only one timer can be running at a time, GL does not nest time queries
+        void begin() noexcept;
+        void end() noexcept;
+
+        // Drops the results gathered so far
+        void reset() noexcept;
+        // Average of the results gathered since the last reset, in milliseconds
+        float getMilliseconds() const noexcept;
+        int getSampleCount() const noexcept;
+
+    private :
+        static const int QUERY_COUNT = 4;
+        unsigned int queries[ QUERY_COUNT ];
+        bool issued[ QUERY_COUNT ] = {};
+        int next = 0;
+
+        double totalMilliseconds = 0.0;
+        int sampleCount = 0;
+
+        void collect() noexcept;
+};
+
+#endif
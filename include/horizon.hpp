@@ -0,0 +1,34 @@
+#ifndef HORIZON_HPP
+#define HORIZON_HPP
+
+#include <glm/glm.hpp>
+#include <shader.hpp>
+
+// Sea from the end of the water mesh out to the horizon, drawn as one fullscreen pass : every pixel under the
+// horizon intersects its ray with the rest plane and is shaded there with the normal of the longest waves only,
+// so the cost follows the pixels covered instead of the distance reached. The mesh fades out over a band of
+// distances into the far field drawn beneath it, see meshFade in water.fs
+class Horizon
+{
+    public :
+        // waveCount longest waves of the table are evaluated per pixel
+        explicit Horizon( int waveCount = 8 ) noexcept;
+        ~Horizon();
+
+        Horizon( const Horizon & ) = delete;
+        Horizon & operator=( const Horizon & ) = delete;
+
+        // The caller sets the wave table, LOD and shading uniforms of getShader() beforehand, as for the water
+        // Pixels closer than fadeStart are left to the mesh, it is opaque there
+        void draw( const glm::mat4 & view, const glm::mat4 & projection, int tableWaves, float fadeStart, float fadeEnd ) noexcept;
+
+        Shader & getShader() noexcept;
+        int getWaveCount() const noexcept;
+
+    private :
+        int waveCount;
+        Shader shader = { "../include/shader/fullscreen.vs", "../include/shader/horizon.fs" };
+        unsigned int quadVAO;
+};
+
+#endif
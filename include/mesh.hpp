@@ -19,6 +19,14 @@ struct Vertex
     float weights[ MAX_BONE_INFLUENCE ];
 };
 
+// Vertex written by the transform feedback of a vertex stage, in the order of its VS_OUT block
+struct CapturedVertex
+{
+    glm::vec3 pos;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
 struct Texture
 {
     unsigned int id;
@@ -31,12 +39,27 @@ class Mesh
     public :
         Mesh( std::vector< Vertex > vertices, std::vector< unsigned int > indices, std::vector< Texture > textures ) noexcept;
         void draw( Shader & shader ) const noexcept;
+        // Runs the vertex stage of the active program once per vertex and keeps its output, the program must be built
+        // with the feedback constructor capturing VS_OUT.pos, VS_OUT.normal and VS_OUT.uv
+        void capture() const noexcept;
+        // Draws the captured vertices, the active program reads them as attributes 0 to 2 ( position, normal, uv )
+        void drawCaptured() const noexcept;
+
+        // Flat square of cells² quads over size² m centered on the origin, facing up
+        static Mesh grid( int cells, float size ) noexcept;
+        // Grid of columns x rows quads over [ 0, 1 ]² in the xy plane, facing +z, see ProjectedGrid
+        static Mesh screenGrid( int columns, int rows ) noexcept;
+        unsigned int getVertexCount() const noexcept;
+        unsigned int getTriangleCount() const noexcept;
+        // Mean distance between neighbour vertices, from the horizontal extent of the mesh and its vertex count
+        float getSpacing() const noexcept;
     
     private :
         std::vector<Vertex> vertices;
         std::vector<unsigned int> indices;
         std::vector<Texture> textures;
         unsigned int vao, vbo, ebo;
+        unsigned int feedbackBuffer, capturedVao;
 
 };
 
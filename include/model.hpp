@@ -13,7 +13,16 @@ class Model
         std::vector< Texture > textureLoaded;
 
         Model( std::string path, bool gamma = false ) noexcept;
+        explicit Model( std::vector< Mesh > meshes ) noexcept;
         void draw( Shader & shader ) const noexcept;
+        // See Mesh, the captured surface can then be drawn by as many passes as needed
+        void capture() const noexcept;
+        void drawCaptured() const noexcept;
+
+        unsigned int getVertexCount() const noexcept;
+        unsigned int getTriangleCount() const noexcept;
+        // Spacing of the densest mesh, 0 without any mesh
+        float getSpacing() const noexcept;
 
     private :
         std::vector< Mesh > meshes;
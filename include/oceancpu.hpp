@@ -0,0 +1,72 @@
+#ifndef OCEANCPU_HPP
+#define OCEANCPU_HPP
+
+#include <glm/glm.hpp>
+#include <threadpool.hpp>
+#include <vector>
+
+#define GRAVITY 9.81f
+// Seconds after which the spectral ocean repeats : the frequencies are snapped to multiples of 2 pi / OCEAN_PERIOD
+// ( Tessendorf ), so the time can be wrapped to the period in double precision before any float math
+#define OCEAN_PERIOD 200.0
+
+// Deep water dispersion relation snapped to the period, angular frequency of the wavenumber kLength
+float dispersion( float kLength ) noexcept;
+// Time in seconds wrapped to [ 0, OCEAN_PERIOD ), the phases omega * cycle stay below a few thousand radians
+// however long the clock has run
+double oceanCycle( double time ) noexcept;
+
+// Phillips spectrum h0 on a resolution² grid centered on k = 0, texel ( x, z ) holds h0( k ) in xy and conj( h0( -k ) ) in zw
+// "amplitude" is the root mean square height of the resulting surface
+std::vector< glm::vec4 > generateInitialSpectrum( int resolution, float patchSize, float amplitude, float windSpeed, glm::vec2 windDirection );
+
+// Headless Tessendorf ocean, same model as OceanFFT but computed with the SIMD CPU FFT across a thread pool
+// The rows and columns transforms are split by lanes between the workers
+class OceanCPU
+{
+    public :
+        OceanCPU( int resolution = 256, float patchSize = 128.0f, unsigned int threadCount = std::thread::hardware_concurrency() );
+
+        // Regenerates the initial spectrum h0 only when one of the parameters changed
+        void setSpectrum( float amplitude, float windSpeed, glm::vec2 windDirection ) noexcept;
+        void setChoppiness( float value ) noexcept;
+
+        // Computes the displacement and normal maps at the given time, the phases are wrapped in double precision
+        void update( double time ) noexcept;
+
+        // resolution² RGBA maps laid out like the ones of OceanFFT : displacement ( dx, h, dz, 1 ) and normal ( nx, ny, nz, 1 )
+        const std::vector< glm::vec4 > & getDisplacement() const noexcept;
+        const std::vector< glm::vec4 > & getNormals() const noexcept;
+
+        int getResolution() const noexcept;
+        float getPatchSize() const noexcept;
+        unsigned int getThreadCount() const noexcept;
+
+    private :
+        // Packed complex fields, see fft_spectrum.fs : ( h + i dx ), ( dz + i slope x ), ( slope z )
+        static const int FIELD_COUNT = 3;
+
+        int resolution;
+        float patchSize;
+        float choppiness = 1.0f;
+
+        float amplitude = -1.0f;
+        float windSpeed = -1.0f;
+        glm::vec2 windDirection = glm::vec2( 0.0f );
+
+        ThreadPool pool;
+        std::vector< glm::vec4 > h0;
+        std::vector< float > omega;
+        std::vector< float > fieldRe[ FIELD_COUNT ];
+        std::vector< float > fieldIm[ FIELD_COUNT ];
+        std::vector< float > scratchRe[ FIELD_COUNT ];
+        std::vector< float > scratchIm[ FIELD_COUNT ];
+
+        std::vector< glm::vec4 > displacement;
+        std::vector< glm::vec4 > normals;
+
+        void transformColumns() noexcept;
+        void transpose() noexcept;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef OCEANFFT_HPP
+#define OCEANFFT_HPP
+
+#include <glm/glm.hpp>
+#include <shader.hpp>
+
+// Tessendorf spectral ocean evaluated on the GPU
+// The spectrum is animated and transformed back to the spatial domain with Stockham radix-2 passes
+// rendered into ping-pong framebuffers, so a frame costs O( N² log N ) whatever the number of waves
+class OceanFFT
+{
+    public :
+        OceanFFT( int resolution = 256, float patchSize = 128.0f );
+        ~OceanFFT();
+
+        OceanFFT( const OceanFFT & ) = delete;
+        OceanFFT & operator=( const OceanFFT & ) = delete;
+
+        // Regenerates the initial spectrum h0 only when one of the parameters changed
+        void setSpectrum( float amplitude, float windSpeed, glm::vec2 windDirection ) noexcept;
+        void setChoppiness( float value ) noexcept;
+
+        // Computes the displacement and normal maps at the given time, wrapped to the period of the ocean on the CPU
+        void update( double time ) noexcept;
+
+        // Binds the displacement map ( dx, h, dz ) and the normal map to the given texture units
+        void bindMaps( unsigned int displacementUnit, unsigned int normalUnit ) const noexcept;
+
+        int getResolution() const noexcept;
+        float getPatchSize() const noexcept;
+        float getChoppiness() const noexcept;
+
+    private :
+        int resolution;
+        int log2Resolution;
+        float patchSize;
+        float choppiness = 1.0f;
+
+        float amplitude = -1.0f;
+        float windSpeed = -1.0f;
+        glm::vec2 windDirection = glm::vec2( 0.0f );
+
+        // Fullscreen passes
+        Shader spectrumShader = { "../include/shader/fullscreen.vs", "../include/shader/fft_spectrum.fs" };
+        Shader fftShader = { "../include/shader/fullscreen.vs", "../include/shader/fft_pass.fs" };
+        Shader resolveShader = { "../include/shader/fullscreen.vs", "../include/shader/fft_resolve.fs" };
+
+        unsigned int quadVAO;
+        unsigned int h0Texture;
+        // Each ping-pong target holds two packed complex spectra per texture, see fft_spectrum.fs
+        unsigned int pingPongFBO[ 2 ];
+        unsigned int pingPongTextures[ 2 ][ 2 ];
+        unsigned int mapsFBO;
+        unsigned int displacementMap;
+        unsigned int normalMap;
+
+        void generateH0() noexcept;
+        static unsigned int createTexture( int size, int internalFormat, bool repeat ) noexcept;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef PRIMITIVECOUNTER_HPP
+#define PRIMITIVECOUNTER_HPP
+
+// Primitives a section of draws sends to the rasterizer, after tessellation, counted with GL_PRIMITIVES_GENERATED
+// queries. Like GpuTimer the results are read a few frames later when available, so counting never stalls
+class PrimitiveCounter
+{
+    public :
+        PrimitiveCounter() noexcept;
+        ~PrimitiveCounter();
+
+        PrimitiveCounter( const PrimitiveCounter & ) = delete;
+        PrimitiveCounter & operator=( const PrimitiveCounter & ) = delete;
+
+        // Only one counter can be running at a time, GL does not nest these queries
+        void begin() noexcept;
+        void end() noexcept;
+
+        // Count of the latest section whose result came back
+        unsigned long long getCount() const noexcept;
+
+    private :
+        static const int QUERY_COUNT = 4;
+        unsigned int queries[ QUERY_COUNT ];
+        bool issued[ QUERY_COUNT ] = {};
+        int next = 0;
+        int latest = -1; // serial of the query the count comes from
+        int serials[ QUERY_COUNT ] = {};
+        int serial = 0;
+
+        unsigned long long count = 0;
+
+        void collect() noexcept;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef PROJECTEDGRID_HPP
+#define PROJECTEDGRID_HPP
+
+#include <glm/glm.hpp>
+#include <shader.hpp>
+#include <model.hpp>
+
+// Water mesh following the screen : a grid of columns x rows cells spread over the view, whose vertices water.vs
+// casts onto the rest plane of the sea every frame. The vertices keep the same spacing in pixels near and far, none
+// is spent out of the view and their count only depends on the grid, not on how far the sea is drawn
+// The rows are fitted between the bottom of the screen and the far edge of the sea, with a margin around the screen
+// for the waves rising into the view from out of it
+class ProjectedGrid
+{
+    public :
+        ProjectedGrid( int columns, int rows ) noexcept;
+
+        // Fits the grid to the view, the sea is drawn up to distance m from the camera and the surface rises at
+        // most height m over its rest plane. Returns false when no part of the sea is in view
+        bool update( const glm::mat4 & view, const glm::mat4 & projection, glm::vec3 cameraPosition, float distance, float height ) noexcept;
+        // Uniforms of water.vs for the last update, viewPos must be the camera position given to it
+        void setUniforms( const Shader & shader ) const noexcept;
+
+        const Model & getModel() const noexcept;
+        int getColumns() const noexcept;
+        int getRows() const noexcept;
+        // Distance between the two lowest rows in the middle of the screen, where the vertices are the closest
+        float getSpacing() const noexcept;
+
+    private :
+        int columns;
+        int rows;
+        Model model;
+        glm::mat4 inverseViewProjection = glm::mat4( 1.0f );
+        glm::vec4 range = glm::vec4( -1.0f, -1.0f, 1.0f, 1.0f ); // NDC rectangle covered by the grid, ( x, y ) min then max
+        float distance = 100.0f;
+        float spacing = 0.0f;
+
+        // Point of the rest plane seen at ndc, the same as water.vs computes
+        glm::vec3 cast( glm::vec2 ndc, glm::vec3 cameraPosition ) const noexcept;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef QUADTREE_HPP
+#define QUADTREE_HPP
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// Sea split into the square tiles of a quadtree refined near the camera. Every tile is the same grid of tileCells²
+// cells scaled to its size, so the detail halves with each level up. The world is paved with root tiles, the ones
+// within the far distance are walked down every frame, the nodes out of the view frustum are dropped with their
+// whole subtree and the tiles left are drawn with one instanced call per level
+// A tile next to a coarser one snaps the vertices of that edge onto the grid of its neighbour, so the seams between
+// levels do not crack once displaced
+class Quadtree
+{
+    public :
+        // Levels 0 to maxLevel, the tiles of maxLevel are leafSize m wide, tileCells is a power of two
+        Quadtree( int maxLevel = 4, int tileCells = 32, float leafSize = 16.0f, int maxTiles = 4096 );
+        ~Quadtree();
+
+        Quadtree( const Quadtree & ) = delete;
+        Quadtree & operator=( const Quadtree & ) = delete;
+
+        // Selects the tiles seen through viewProjection up to distance m from the camera, their bounds are padded by
+        // height m up, down and sideways for the displacement of the waves
+        void update( const glm::mat4 & viewProjection, glm::vec3 cameraPosition, float distance, float height ) noexcept;
+        // Draws the tiles with the water program active, see water.vs
+        void draw() const noexcept;
+        // See Mesh, the selected tiles are captured at once and drawn from the capture
+        void capture() const noexcept;
+        void drawCaptured() const noexcept;
+
+        int getLevelCount() const noexcept;
+        int getVisibleCount( int level ) const noexcept;
+        int getVisibleCount() const noexcept;
+        // Nodes dropped by the frustum test, each one with the tiles it would have been refined into
+        int getCulledCount() const noexcept;
+        unsigned int getVertexCount() const noexcept; // of the tiles drawn
+        float getCellSize() const noexcept; // of the finest tiles
+
+        // A node is refined while the camera is closer to it than this many times its size
+        static constexpr float REFINE_DISTANCE = 2.0f;
+        // Grid of tileCells² cells shared by every tile, vertices in cells and 16 bit indices
+        static void buildTile( int tileCells, std::vector< glm::vec3 > & vertices, std::vector< unsigned short > & indices ) noexcept;
+
+    private :
+        // ( x, z ) of the first corner and cell size, then the cells the vertices of the -x, +x, -z and +z edges
+        // snap to, 1 unless the neighbour on that side is coarser
+        struct Tile
+        {
+            glm::vec3 corner;
+            glm::vec4 stitch;
+        };
+
+        int maxLevel;
+        int tileCells;
+        float leafSize;
+        int maxTiles;
+        unsigned int indexCount;
+
+        std::vector< std::vector< Tile > > levels; // tiles selected this frame per level
+        std::vector< int > levelBase; // first instance of each level in the instance buffer
+        // One draw per tile out of the capture, built by update
+        std::vector< int > capturedCounts;
+        std::vector< const void * > capturedOffsets;
+        std::vector< int > capturedBases;
+        int visible = 0;
+        int culled = 0;
+
+        glm::vec4 planes[6];
+        glm::vec3 camera = glm::vec3( 0.0f );
+        float height = 0.0f;
+
+        unsigned int vao, vbo, ebo, instanceBuffer;
+        unsigned int feedbackBuffer, capturedVao;
+
+        float tileSize( int level ) const noexcept;
+        bool refine( glm::vec2 corner, int level ) const noexcept;
+        int levelAt( glm::vec2 point ) const noexcept;
+        bool inFrustum( glm::vec2 corner, float size ) const noexcept;
+        void select( glm::vec2 corner, int level ) noexcept;
+};
+
+#endif
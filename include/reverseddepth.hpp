@@ -0,0 +1,42 @@
+#ifndef REVERSEDDEPTH_HPP
+#define REVERSEDDEPTH_HPP
+
+#include <glm/glm.hpp>
+
+// Reversed-Z depth : the near plane lands on depth 1 and the far one on 0, in [ 0, 1 ] clip space set with
+// glClipControl, and the depth is stored as 32 bit floats. The float exponent then packs its precision where the
+// perspective divide spreads the distances out, so the depth stays even from the near plane to a far plane
+// thousands of times further. The default framebuffer only has a fixed point depth buffer, the scene is drawn into
+// an offscreen one and its color copied to the window
+// Throws when the context has neither GL 4.5 nor ARB_clip_control, the standard depth is used then
+class ReversedDepth
+{
+    public :
+        // loader resolves glClipControl, glfwGetProcAddress for instance, the framebuffer is width x height
+        ReversedDepth( void * ( *loader )( const char * ), int width, int height );
+        ~ReversedDepth();
+
+        ReversedDepth( const ReversedDepth & ) = delete;
+        ReversedDepth & operator=( const ReversedDepth & ) = delete;
+
+        // Binds the offscreen framebuffer and switches the clip space, the depth test and the cleared depth
+        // over, clear it afterwards
+        void begin() const noexcept;
+        // Copies the color to the window and switches the conventions back
+        void end() const noexcept;
+
+        // glm::perspective with the near plane at depth 1 and the far one at 0 in [ 0, 1 ] clip space
+        static glm::mat4 perspective( float fovy, float aspect, float nearPlane, float farPlane ) noexcept;
+
+    private :
+        int width;
+        int height;
+        unsigned int framebuffer;
+        unsigned int colorBuffer;
+        unsigned int depthBuffer;
+
+        // GL 4.5 entry point, cast to its type in the source
+        void * clipControl = nullptr;
+};
+
+#endif
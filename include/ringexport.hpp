@@ -0,0 +1,103 @@
+#ifndef RINGEXPORT_HPP
+#define RINGEXPORT_HPP
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Layout of the ring file, written by RingExport and read in place by other processes ( see RingView )
+// [ RingExportHeader, padded to headerSize ][ slot 0 ][ slot 1 ]... every slot being slotSize bytes :
+// a RingExportFrame padded to 64 bytes, resolution² heights then resolution² normals ( x, y, z ), all floats
+#define RING_EXPORT_MAGIC "OCEANRNG"
+#define RING_EXPORT_VERSION 1
+
+struct RingExportHeader
+{
+    char magic[ 8 ]; // RING_EXPORT_MAGIC without the terminating zero, written last
+    std::uint32_t version;
+    std::uint32_t resolution;
+    std::uint32_t slotCount;
+    std::uint32_t headerSize; // offset of the first slot
+    std::uint64_t slotSize;
+    std::uint64_t frameOffset; // offset of the heights in a slot
+    float patchSize; // meters covered by a frame
+    float dt; // seconds between two frames
+    std::atomic< std::uint64_t > frameCount; // frames written, the latest is in slot ( frameCount - 1 ) % slotCount
+};
+
+// Inputs of the simulation a frame was computed with
+struct RingExportParameters
+{
+    float amplitude = 0.0f;
+    float windSpeed = 0.0f;
+    float windDirection[ 2 ] = {};
+    float choppiness = 0.0f;
+    float speed = 0.0f;
+};
+
+struct RingExportFrame
+{
+    // Sequence lock : odd while the slot is written, 2 * ( frame + 1 ) once it holds frame. Readers check it is
+    // unchanged after reading, the writer never waits for them
+    std::atomic< std::uint64_t > sequence;
+    std::uint64_t frame;
+    double time; // seconds on the simulation clock
+    RingExportParameters parameters;
+};
+
+// Writes frames into a memory-mapped ring file, the oldest frame is overwritten once the ring is full
+// Writing is a copy into the page cache, nothing waits for the disk or for the readers
+class RingExport
+{
+    public :
+        RingExport( const std::string & path, int resolution, float patchSize, float dt, int slotCount = 8 );
+        ~RingExport();
+
+        RingExport( const RingExport & ) = delete;
+        RingExport & operator=( const RingExport & ) = delete;
+
+        // displacement and normals hold resolution² texels, the height is displacement.y
+        void write( double time, const RingExportParameters & parameters, const std::vector< glm::vec4 > & displacement,
+                    const std::vector< glm::vec4 > & normals ) noexcept;
+
+        std::uint64_t getFrameCount() const noexcept;
+        size_t getFileSize() const noexcept;
+
+    private :
+        unsigned char * data = nullptr;
+        size_t size = 0;
+        RingExportHeader * header = nullptr;
+};
+
+// Read-only mapping of a ring file, frames are read in place
+class RingView
+{
+    public :
+        struct FrameRef
+        {
+            const RingExportFrame * frame = nullptr;
+            const float * heights = nullptr;
+            const float * normals = nullptr;
+            std::uint64_t sequence = 0;
+        };
+
+        explicit RingView( const std::string & path );
+        ~RingView();
+
+        RingView( const RingView & ) = delete;
+        RingView & operator=( const RingView & ) = delete;
+
+        const RingExportHeader & getHeader() const noexcept;
+        // Points ref at the latest complete frame, false when none was written yet or the writer is on it
+        bool acquireLatest( FrameRef & ref ) const noexcept;
+        // True when the frame was not overwritten since acquireLatest, check it once done reading
+        bool isValid( const FrameRef & ref ) const noexcept;
+
+    private :
+        const unsigned char * data = nullptr;
+        size_t size = 0;
+};
+
+#endif
@@ -0,0 +1,6 @@
+#version 330 core
+
+// Depth only passes, the color writes are masked
+void main()
+{
+}
@@ -0,0 +1,32 @@
+#version 330 core
+
+uniform samplerBuffer waveTable; // see WaveSpectrum
+uniform samplerBuffer wavePhases; // see WavePhases
+uniform int firstWave; // waves [ firstWave, lastWave ) of the table are rendered
+uniform int lastWave;
+uniform int resolution;
+uniform float tileSize;
+uniform vec2 origin; // world point the phases include, a multiple of tileSize
+
+#include "wavemodel.glsl"
+
+out vec2 slope;
+
+// Slopes ( dh/dx, dh/dz ) of the short waves over one tile. Each wavevector is moved to the nearest one that is
+// periodic over the tile, so the texture repeats without seams, the shift is at most half of 2 pi / tileSize
+// The phases carry k . origin of the original wavevector, the moved one owes nothing to an origin on the lattice
+void main()
+{
+    vec2 pos = ( gl_FragCoord.xy / float( resolution ) ) * tileSize;
+    float lattice = 6.2831853 / tileSize;
+    slope = vec2( 0.0 );
+    for( int i = firstWave; i < lastWave; i++ )
+    {
+        vec4 w = texelFetch( waveTable, i );
+        vec2 moved = round( w.xy / lattice ) * lattice;
+        float phase = texelFetch( wavePhases, i ).r + dot( moved - w.xy, origin );
+        w.xy = moved;
+        vec3 contribution = waveSample( w, phase, pos );
+        slope += contribution.yz;
+    }
+}
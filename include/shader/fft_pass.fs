@@ -0,0 +1,54 @@
+#version 330 core
+
+uniform sampler2D inputA;
+uniform sampler2D inputB;
+uniform int resolution;
+uniform int stage; // butterfly span is 1 << stage
+uniform int direction; // 0 along the rows, 1 along the columns
+
+layout ( location = 0 ) out vec4 outA;
+layout ( location = 1 ) out vec4 outB;
+
+const float PI = 3.14159265359;
+
+vec2 cmul( vec2 a, vec2 b )
+{
+    return vec2( a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x );
+}
+
+// One radix-2 Stockham pass of the inverse FFT. The autosort formulation keeps the output in natural order
+// so no bit reversal pass is needed : output j = 2qp + k ( + p ) reads inputs i = qp + k and i + N / 2
+void main()
+{
+    ivec2 coord = ivec2( gl_FragCoord.xy );
+    int j = direction == 0 ? coord.x : coord.y;
+    int p = 1 << stage;
+    int r = j & ( 2 * p - 1 );
+    int k = r & ( p - 1 );
+    int i = ( ( j >> ( stage + 1 ) ) << stage ) + k;
+
+    float angle = PI * float( k ) / float( p );
+    vec2 w = vec2( cos( angle ), sin( angle ) );
+    if( r >= p )
+        w = -w;
+
+    ivec2 c0 = coord;
+    ivec2 c1 = coord;
+    if( direction == 0 )
+    {
+        c0.x = i;
+        c1.x = i + resolution / 2;
+    }
+    else
+    {
+        c0.y = i;
+        c1.y = i + resolution / 2;
+    }
+
+    vec4 a0 = texelFetch( inputA, c0, 0 );
+    vec4 a1 = texelFetch( inputA, c1, 0 );
+    vec4 b0 = texelFetch( inputB, c0, 0 );
+    vec4 b1 = texelFetch( inputB, c1, 0 );
+    outA = vec4( a0.xy + cmul( w, a1.xy ), a0.zw + cmul( w, a1.zw ) );
+    outB = vec4( b0.xy + cmul( w, b1.xy ), b0.zw + cmul( w, b1.zw ) );
+}
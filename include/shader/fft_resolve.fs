@@ -0,0 +1,20 @@
+#version 330 core
+
+uniform sampler2D inputA;
+uniform sampler2D inputB;
+uniform float choppiness;
+
+layout ( location = 0 ) out vec4 displacement;
+layout ( location = 1 ) out vec4 normal;
+
+void main()
+{
+    ivec2 coord = ivec2( gl_FragCoord.xy );
+    // The spectrum is centered on k = 0, which shifts every output sample by ( -1 )^( x + z )
+    float sign = ( ( coord.x + coord.y ) & 1 ) == 1 ? -1.0 : 1.0;
+    vec4 a = texelFetch( inputA, coord, 0 ) * sign;
+    vec4 b = texelFetch( inputB, coord, 0 ) * sign;
+
+    displacement = vec4( choppiness * a.y, a.x, choppiness * a.z, 1.0 );
+    normal = vec4( normalize( vec3( -a.w, 1.0, -b.x ) ), 1.0 );
+}
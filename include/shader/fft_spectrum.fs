@@ -0,0 +1,55 @@
+#version 330 core
+
+uniform sampler2D h0; // rg = h0( k ), ba = conj( h0( -k ) )
+uniform int resolution;
+uniform float patchSize;
+uniform float time; // wrapped to the period, see oceanCycle
+uniform float period; // the frequencies are multiples of 2 pi / period, see dispersion
+
+// The inverse FFT of a spectrum whose spatial field is real can carry a second one in its imaginary part
+// A : rg = height + i * dx, ba = dz + i * slope x
+// B : rg = slope z, ba = unused
+layout ( location = 0 ) out vec4 outA;
+layout ( location = 1 ) out vec4 outB;
+
+const float PI = 3.14159265359;
+const float GRAVITY = 9.81;
+
+vec2 cmul( vec2 a, vec2 b )
+{
+    return vec2( a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x );
+}
+
+// Multiplication by i
+vec2 ci( vec2 a )
+{
+    return vec2( -a.y, a.x );
+}
+
+void main()
+{
+    ivec2 coord = ivec2( gl_FragCoord.xy );
+    vec2 k = 2.0 * PI * ( vec2( coord ) - float( resolution / 2 ) ) / patchSize;
+    float kLen = length( k );
+    if( kLen < 1e-6 )
+    {
+        outA = vec4( 0.0 );
+        outB = vec4( 0.0 );
+        return;
+    }
+
+    // Deep water dispersion relation snapped to the period, so omega * time repeats with the wrapped time
+    float omegaStep = 2.0 * PI / period;
+    float omega = floor( sqrt( GRAVITY * kLen ) / omegaStep ) * omegaStep;
+    vec4 h0Value = texelFetch( h0, coord, 0 );
+    vec2 e = vec2( cos( omega * time ), sin( omega * time ) );
+    vec2 h = cmul( h0Value.xy, e ) + cmul( h0Value.zw, vec2( e.x, -e.y ) );
+
+    vec2 dx = -ci( h ) * k.x / kLen;
+    vec2 dz = -ci( h ) * k.y / kLen;
+    vec2 sx = ci( h ) * k.x;
+    vec2 sz = ci( h ) * k.y;
+
+    outA = vec4( h + ci( dx ), dz + ci( sx ) );
+    outB = vec4( sz, 0.0, 0.0 );
+}
@@ -0,0 +1,59 @@
+#version 330 core
+
+uniform mat4 inverseViewProjection; // of the view without its translation
+uniform vec2 screenSize;
+uniform int numWaves; // longest waves of the table evaluated per pixel
+uniform samplerBuffer waveTable; // see WaveSpectrum
+uniform samplerBuffer wavePhases; // see WavePhases
+uniform float lodPixels;
+uniform float lodScale; // pixels covered by one meter seen from one meter away
+uniform vec2 meshFade; // distances the water mesh fades out between, the far field starts under the band
+
+#include "wavemodel.glsl"
+#include "water_shading.glsl"
+
+out vec4 fragColor;
+
+// Sea past the water mesh : the ray of the pixel meets the rest plane, the normal there is the sum of the longest
+// waves and the surface is lit as the mesh is, see Horizon
+void main()
+{
+    vec2 ndc = gl_FragCoord.xy / screenSize * 2.0 - 1.0;
+    // Any depth inside the clip volume is on the ray, for the standard and the reversed depth alike
+    vec4 point = inverseViewProjection * vec4( ndc, 0.5, 1.0 );
+    vec3 ray = normalize( point.xyz / point.w );
+    // Above the horizon, or under the sea looking up, the sky stays
+    float t = -viewPos.y / ray.y;
+    if( ray.y >= 0.0 || t <= meshFade.x )
+        discard;
+    vec3 pos = viewPos + ray * t;
+
+    // Meters covered by a pixel on the plane, along the ray where the grazing view stretches it and across it
+    vec2 along = normalize( ray.xz );
+    vec2 metersPerPixel = vec2( t / ( lodScale * max( -ray.y, 1e-4 ) ), t / lodScale );
+    // Waves shorter than two pixels of the stretched footprint fade out as in the vertex stage, always, or they
+    // alias into noise out there
+    float minPixels = max( lodPixels, 1.0 );
+    float dx = 0.0;
+    float dz = 0.0;
+    vec3 normal = vec3( 0.0, 1.0, 0.0 );
+    for( int i = 0; i < numWaves; i++ )
+    {
+        vec4 w = texelFetch( waveTable, i );
+        // Phase step from one pixel to the next along both axes of the footprint
+        vec2 phaseStep = vec2( dot( w.xy, along ), dot( w.xy, vec2( -along.y, along.x ) ) ) * metersPerPixel;
+        float wavelengthPixels = 6.2831853 / max( length( phaseStep ), 1e-6 );
+        float weight = smoothstep( minPixels, 2.0 * minPixels, wavelengthPixels );
+        if( weight == 0.0 )
+            continue;
+        vec3 contribution = weight * waveSample( w, texelFetch( wavePhases, i ).r, pos.xz );
+        dx += contribution.y;
+        dz += contribution.z;
+        // Same accumulation as wave() in water_surface.glsl, so both sides of the fade band agree
+        normal += weight * vec3( dx, 1.0, dz );
+    }
+    normal = normalize( normal );
+
+    vec3 rgb = shade( pos, normal );
+    fragColor = vec4( pow( rgb, vec3( 1.0 / gamma ) ), 1.0 );
+}
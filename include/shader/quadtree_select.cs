@@ -0,0 +1,128 @@
+#version 430 core
+
+// Tiles of the quadtree selected and culled for the frame, see GpuQuadtree and Quadtree
+// One invocation per node, z is the level : a node is a tile when its parent is refined and it is not, since a node
+// is only refined when its parent is, the same cut as the walk from the roots on the CPU
+#define GROUP_SIZE 8
+#define MAX_LEVELS 16
+
+layout ( local_size_x = GROUP_SIZE, local_size_y = GROUP_SIZE ) in;
+
+struct ElementsCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+struct ArraysCommand
+{
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+// ( x, z ) of the first corner and cell size, then the cells the -x, +x, -z and +z edges snap to, see water.vs
+struct Tile
+{
+    vec4 corner;
+    vec4 stitch;
+};
+
+layout ( std430, binding = 0 ) buffer Commands { ElementsCommand commands[]; }; // one per level
+layout ( std430, binding = 1 ) buffer CaptureCommands { ArraysCommand captureCommands[]; }; // one per level
+layout ( std430, binding = 2 ) writeonly buffer CapturedCommands { ElementsCommand capturedCommands[]; }; // one per slot
+layout ( std430, binding = 3 ) writeonly buffer Tiles { Tile tiles[]; };
+
+uniform int maxLevel;
+uniform int tileCells;
+uniform float leafSize;
+uniform float refineDistance;
+uniform vec2 rootOrigin; // first corner of the first root walked
+uniform int rootsX; // roots walked along x and z
+uniform int rootsZ;
+uniform vec3 camera;
+uniform float height; // padding of the bounds for the waves
+uniform vec4 planes[6]; // of the frustum, inside when dot( plane.xyz, p ) + plane.w >= 0
+uniform int levelCapacity[ MAX_LEVELS ];
+
+float tileSize( int level )
+{
+    return ldexp( leafSize, maxLevel - level );
+}
+
+bool refine( vec2 corner, int level )
+{
+    if( level >= maxLevel )
+        return false;
+    // Distance from the camera to the box the surface of the node moves in
+    float size = tileSize( level );
+    vec2 offset = camera.xz - clamp( camera.xz, corner, corner + size );
+    float vertical = max( abs( camera.y ) - height, 0.0 );
+    return length( vec3( offset.x, vertical, offset.y ) ) < refineDistance * size;
+}
+
+int levelAt( vec2 point )
+{
+    float size = tileSize( 0 );
+    vec2 corner = floor( point / size ) * size;
+    int level = 0;
+    while( refine( corner, level ) )
+    {
+        size *= 0.5;
+        corner += floor( ( point - corner ) / size ) * size;
+        level++;
+    }
+    return level;
+}
+
+bool inFrustum( vec2 corner, float size )
+{
+    vec3 low = vec3( corner.x - height, -height, corner.y - height );
+    vec3 high = vec3( corner.x + size + height, height, corner.y + size + height );
+    for( int i = 0; i < 6; i++ )
+    {
+        // Corner of the box the furthest along the normal of the plane
+        vec3 farthest = mix( low, high, greaterThan( planes[i].xyz, vec3( 0.0 ) ) );
+        if( dot( planes[i].xyz, farthest ) + planes[i].w < 0.0 )
+            return false;
+    }
+    return true;
+}
+
+void main()
+{
+    int level = int( gl_GlobalInvocationID.z );
+    ivec2 node = ivec2( gl_GlobalInvocationID.xy );
+    if( level > maxLevel || any( greaterThanEqual( node, ivec2( rootsX, rootsZ ) << level ) ) )
+        return;
+    float size = tileSize( level );
+    vec2 corner = rootOrigin + vec2( node ) * size;
+    if( level > 0 && !refine( rootOrigin + vec2( node >> 1 ) * ( size * 2.0 ), level - 1 ) )
+        return;
+    if( refine( corner, level ) || !inFrustum( corner, size ) )
+        return;
+
+    uint slot = atomicAdd( commands[ level ].instanceCount, 1u );
+    // Never reached, the capacity bounds the tiles a level can have around the camera
+    if( slot >= uint( levelCapacity[ level ] ) )
+        return;
+    atomicAdd( captureCommands[ level ].instanceCount, 1u );
+
+    // Level of the tile across the middle of each edge, -x, +x, -z then +z
+    vec2 center = corner + size * 0.5;
+    float reach = ( size + tileSize( maxLevel ) ) * 0.5;
+    vec2 sides[4] = vec2[4]( vec2( -reach, 0.0 ), vec2( reach, 0.0 ), vec2( 0.0, -reach ), vec2( 0.0, reach ) );
+    vec4 stitch;
+    for( int side = 0; side < 4; side++ )
+    {
+        int coarser = max( level - levelAt( center + sides[ side ] ), 0 );
+        stitch[ side ] = float( min( 1 << coarser, tileCells ) );
+    }
+
+    uint index = commands[ level ].baseInstance + slot;
+    tiles[ index ] = Tile( vec4( corner, size / float( tileCells ), 0.0 ), stitch );
+    uint tileVertices = uint( ( tileCells + 1 ) * ( tileCells + 1 ) );
+    capturedCommands[ index ] = ElementsCommand( commands[ level ].count, 1u, 0u, int( index * tileVertices ), 0u );
+}
@@ -3,11 +3,19 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
 
 class Shader
 {
     public :
-        Shader( const char * vertexPath, const char * fragmentPath, const char * geometryPath = nullptr );
+        // defines are inserted after the #version line of every stage, for instance "#define FAST 1\n"
+        Shader( const char * vertexPath, const char * fragmentPath, const char * geometryPath = nullptr, const std::string & defines = std::string() );
+        // Vertex stage only, capturing the given outputs with transform feedback ( interleaved )
+        Shader( const char * vertexPath, const std::vector< std::string > & feedbackVaryings, const std::string & defines = std::string() );
+        // Vertex, tessellation control and evaluation then fragment stages, needs a GL 4.0 context
+        Shader( const char * vertexPath, const char * controlPath, const char * evaluationPath, const char * fragmentPath, const std::string & defines );
+        // Compute shader, needs a GL 4.3 context
+        explicit Shader( const char * computePath );
 
         void activate() const noexcept;
 
@@ -33,6 +41,9 @@ class Shader
         unsigned int id;
 
         void compileErrors( unsigned int shader, const char * type );
+        // Replaces the #include "file" lines by the content of the file, relative to the including one
+        static std::string resolveIncludes( const std::string & code, const std::string & directory, int depth = 0 );
+        static std::string insertDefines( const std::string & code, const std::string & defines );
 };
 
 #endif
\ No newline at end of file
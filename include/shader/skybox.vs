@@ -3,6 +3,7 @@ layout ( location = 0 ) in vec3 aPos;
 
 uniform mat4 projection;
 uniform mat4 view;
+uniform bool reversedDepth; // the far plane is at depth 0, see ReversedDepth
 
 out vec3 texCoords;
 
@@ -10,5 +11,6 @@ void main()
 {
     texCoords = aPos;
     vec4 pos = projection * view * vec4( aPos, 1.0 );
-    gl_Position = pos.xyww;
+    // On the far plane, so that anything drawn passes in front of it
+    gl_Position = reversedDepth ? vec4( pos.xy, 0.0, pos.w ) : pos.xyww;
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 330 core
+
+in vec2 corner;
+in float fade;
+in float foam;
+in float depth;
+
+uniform vec3 fogColor;
+uniform float fogStart;
+uniform float fogEnd;
+uniform float gamma;
+
+out vec4 fragColor;
+
+void main()
+{
+    // Soft round droplet or foam patch
+    float r2 = dot( corner, corner );
+    if( r2 >= 1.0 )
+        discard;
+    float alpha = ( 1.0 - r2 ) * ( 1.0 - fade ) * mix( 0.6, 0.35, foam );
+    vec3 color = mix( vec3( 0.9, 0.95, 1.0 ), vec3( 0.85, 0.9, 0.9 ), foam );
+    color = mix( color, fogColor, smoothstep( fogStart, fogEnd, depth ) );
+    fragColor = vec4( pow( color, vec3( 1.0 / gamma ) ), alpha );
+}
@@ -0,0 +1,61 @@
+#version 330 core
+// One instance per particle, the lanes of the pool streamed as separate attributes, see SprayRenderer
+layout ( location = 0 ) in float aX;
+layout ( location = 1 ) in float aY;
+layout ( location = 2 ) in float aZ;
+layout ( location = 3 ) in float aFade;
+layout ( location = 4 ) in float aFoam;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform int numWaves; // waves of the table the foam follows, the largest ones come first
+uniform samplerBuffer waveTable;
+uniform samplerBuffer wavePhases;
+uniform float spraySize;
+uniform float foamSize;
+
+#include "wavemodel.glsl"
+
+out vec2 corner;
+out float fade;
+out float foam;
+out float depth;
+
+// Height of the sum of waves, wave() of water.vs without the LOD and the normal
+float surfaceHeight( vec2 xz )
+{
+    float height = 0.0;
+    for( int i = 0; i < numWaves; i++ )
+        height += waveSample( texelFetch( waveTable, i ), texelFetch( wavePhases, i ).r, xz ).x;
+    return height;
+}
+
+void main()
+{
+    corner = vec2( gl_VertexID & 1, gl_VertexID >> 1 ) * 2.0 - 1.0;
+    fade = aFade;
+    foam = aFoam;
+    // Dead particles waiting for the older ones to be retired collapse to nothing
+    if( aFade >= 1.0 )
+    {
+        gl_Position = vec4( 0.0, 0.0, 2.0, 1.0 );
+        return;
+    }
+    vec3 pos = vec3( aX, aY, aZ );
+    if( aFoam > 0.5 )
+    {
+        // Flat on the water, a few centimeters above it to stay clear of the surface
+        pos.y = surfaceHeight( pos.xz ) + 0.03;
+        pos.xz += corner * foamSize;
+    }
+    else
+    {
+        // Facing the camera
+        vec3 right = vec3( view[0][0], view[1][0], view[2][0] );
+        vec3 up = vec3( view[0][1], view[1][1], view[2][1] );
+        pos += ( right * corner.x + up * corner.y ) * spraySize;
+    }
+    vec4 viewPos = view * vec4( pos, 1.0 );
+    depth = -viewPos.z;
+    gl_Position = projection * viewPos;
+}
@@ -0,0 +1,61 @@
+#version 330 core
+
+#define MAX_SOURCES 16
+
+uniform sampler2D state; // ( height, height one step before ), texel t holds the world cell w with t = w mod resolution
+uniform int resolution;
+uniform vec2 originTexel; // texel of the window's first cell
+uniform vec2 shift; // cells the window moved since the last step
+uniform bool advance; // false only clears the cells the window moved onto
+uniform float courant2; // ( wave speed * dt / cell size )²
+uniform float damping; // fraction of the velocity lost per step
+uniform float spongeWidth; // cells along the window edges absorbing the outgoing waves
+uniform float cellSize;
+uniform float dt;
+uniform int sourceCount;
+uniform vec4 sources[ MAX_SOURCES ]; // position in meters from the window origin, radius, vertical speed pushed in m/s
+
+out vec2 result;
+
+bool inWindow( ivec2 cell )
+{
+    return all( greaterThanEqual( cell, ivec2( 0 ) ) ) && all( lessThan( cell, ivec2( resolution ) ) );
+}
+
+// Field value at the given offset, zero for the cells outside of the window before or after the move
+vec2 fetch( ivec2 texel, ivec2 cell, ivec2 offset )
+{
+    if( !inWindow( cell + offset ) || !inWindow( cell + offset + ivec2( shift ) ) )
+        return vec2( 0.0 );
+    return texelFetch( state, ( texel + offset + resolution ) % resolution, 0 ).xy;
+}
+
+void main()
+{
+    ivec2 texel = ivec2( gl_FragCoord.xy );
+    // Position of the texel in the window, the cells wrapping around after a move are the new ones
+    ivec2 cell = ( texel - ivec2( originTexel ) + resolution ) % resolution;
+
+    vec2 center = fetch( texel, cell, ivec2( 0 ) );
+    if( !advance )
+    {
+        result = center;
+        return;
+    }
+    float laplacian = fetch( texel, cell, ivec2( 1, 0 ) ).x + fetch( texel, cell, ivec2( -1, 0 ) ).x +
+                      fetch( texel, cell, ivec2( 0, 1 ) ).x + fetch( texel, cell, ivec2( 0, -1 ) ).x - 4.0 * center.x;
+
+    // Waves reaching the edges fade out instead of reflecting back or wrapping around
+    float edge = float( min( min( cell.x, cell.y ), resolution - 1 - max( cell.x, cell.y ) ) );
+    float loss = damping + 0.25 * ( 1.0 - smoothstep( 0.0, spongeWidth, edge ) );
+
+    float height = center.x + ( center.x - center.y ) * ( 1.0 - loss ) + courant2 * laplacian;
+
+    vec2 position = ( vec2( cell ) + 0.5 ) * cellSize;
+    for( int i = 0; i < sourceCount; i++ )
+    {
+        vec2 d = position - sources[i].xy;
+        height += dt * sources[i].w * exp( -dot( d, d ) / ( sources[i].z * sources[i].z ) );
+    }
+    result = vec2( height, center.x );
+}
@@ -3,46 +3,62 @@
 in VS_OUT {
     vec3 pos;
     vec3 normal;
+    vec2 uv;
 } fs_in;
-uniform vec3 viewPos;
-uniform samplerCube reflectionTexture;
-uniform vec3 fogColor;
-uniform float fogStart;
-uniform float fogEnd;
-uniform float gamma;
-uniform float ambientStrength;
-uniform float shininess;
-uniform float fresnelStrength;
+uniform int waveMode;
+uniform sampler2D normalMap;
+uniform sampler3D bakedWaves;
+uniform float bakedCycle;
+uniform bool wakeEnabled;
+uniform sampler2D wakeField;
+uniform vec2 wakeOrigin;
+uniform float wakeSize;
+uniform bool detailEnabled; // the short waves of the sum of waves come from the detail map instead of the vertex stage
+uniform sampler2D detailMap; // ( dh/dx, dh/dz ) of the short waves over a tile, see DetailNormals
+uniform float detailSize;
+uniform vec2 meshFade; // distances the mesh fades out between, ( 0, 0 ) keeps it opaque
+
+#include "water_shading.glsl"
 
 out vec4 fragColor;
 
-vec3 fog( vec3 color, float depth )
+// Tilts the normal by the slopes of the ripples, the slopes of the two surfaces add up
+vec3 addWake( vec3 normal, vec2 xz )
 {
-    float factor = smoothstep( fogStart, fogEnd, depth );
-    return mix( color, fogColor, factor );
+    vec2 local = xz - wakeOrigin;
+    if( !wakeEnabled || any( lessThan( local, vec2( 0.0 ) ) ) || any( greaterThanEqual( local, vec2( wakeSize ) ) ) )
+        return normal;
+    float texel = 1.0 / float( textureSize( wakeField, 0 ).x );
+    vec2 uv = xz / wakeSize;
+    float scale = 0.5 / ( wakeSize * texel );
+    float dx = ( texture( wakeField, uv + vec2( texel, 0.0 ) ).x - texture( wakeField, uv - vec2( texel, 0.0 ) ).x ) * scale;
+    float dz = ( texture( wakeField, uv + vec2( 0.0, texel ) ).x - texture( wakeField, uv - vec2( 0.0, texel ) ).x ) * scale;
+    return normalize( normal / max( normal.y, 1e-3 ) - vec3( dx, 0.0, dz ) );
 }
 
-void main()
+// Tilts the normal by the slopes of the short waves, the detail tile repeats over the whole surface
+vec3 addDetail( vec3 normal, vec2 xz )
 {
-    vec3 color = vec3( 0.0, 0.15, 1.0 );
-    // Ambient
-    vec3 ambient = color * 0.1;
-    // Diffuse
-    vec3 lightDir = normalize( vec3( -1.0, 1.0, -1.0 ) );
-    float diff = max( dot( fs_in.normal, lightDir ), 0.0 );
-    vec3 diffuse = color * diff;
-    // Specular
-    float shininess = 64.0;
-    vec3 reflectDir = reflect( -lightDir, fs_in.normal );
-    vec3 viewDir = normalize( viewPos - fs_in.pos );
-    vec3 halfwayDir = normalize( lightDir + viewDir );
-    float spec = pow( max( dot( fs_in.normal, halfwayDir ), 0.0 ), shininess );
-    float fresnel = 0.02 + ( 1.0 - 0.02 ) * fresnelStrength * pow( 1.0 - clamp( dot( viewDir, fs_in.normal ), 0.0, 1.0 ), 5.0 );
-    vec3 specular = vec3( 0.4 ) * spec * fresnel;
-
-    vec3 reflectColor = texture( reflectionTexture, reflectDir ).rgb;
+    if( !detailEnabled || ( waveMode != 0 && waveMode != 3 ) )
+        return normal;
+    vec2 slope = texture( detailMap, xz / detailSize ).xy;
+    return normalize( normal / max( normal.y, 1e-3 ) - vec3( slope.x, 0.0, slope.y ) );
+}
 
-    vec3 rgb = mix( ambient + diffuse + specular, reflectColor, fresnel );
-    rgb = fog( rgb, length( viewPos - fs_in.pos ) );
-    fragColor = vec4( pow( rgb, vec3( 1 / gamma ) ), 1.0 );
+void main()
+{
+    vec3 normal = fs_in.normal;
+    if( waveMode == 1 )
+        normal = normalize( texture( normalMap, fs_in.uv ).xyz );
+    else if( waveMode == 2 )
+        normal = normalize( texture( bakedWaves, vec3( fs_in.uv, bakedCycle ) ).xyz );
+    normal = addDetail( normal, fs_in.pos.xz );
+    normal = addWake( normal, fs_in.pos.xz );
+    vec3 rgb = shade( fs_in.pos, normal );
+    // The mesh gives way to the far field over the fade band, see Horizon
+    float alpha = 1.0;
+    if( meshFade.y > 0.0 )
+        alpha = 1.0 - smoothstep( meshFade.x, meshFade.y, length( viewPos - fs_in.pos ) );
+    // The gamma exponent is a free parameter, it stays exact on every tier
+    fragColor = vec4( pow( rgb, vec3( 1 / gamma ) ), alpha );
 }
\ No newline at end of file
@@ -1,65 +1,67 @@
 #version 330 core
 layout ( location = 0 ) in vec3 aPos;
+layout ( location = 7 ) in vec3 aLevel; // clipmap level or quadtree tile of the instance : ( x, z ) of its first corner and cell size
+layout ( location = 8 ) in vec4 aStitch; // cells the vertices of the -x, +x, -z and +z edges of the tile snap to
 
 uniform mat4 view;
 uniform mat4 projection;
-uniform int numWaves;
-uniform float time;
-uniform float amplitude;
-uniform float speed;
-uniform float frequency;
-uniform float kFactor;
-uniform float ADecay;
-uniform float wIncrease;
+uniform bool clipmap; // aPos is in cells of the level, see Clipmap
+uniform bool quadtree; // aPos is in cells of the tile, see Quadtree
+uniform int tileCells;
+uniform bool projectedGrid; // aPos.xy is a point of the screen in [ 0, 1 ]² cast onto the rest plane, see ProjectedGrid
+uniform mat4 gridInverseViewProjection;
+uniform vec4 gridRange; // NDC rectangle covered by the grid, ( x, y ) min then max
+uniform float gridDistance; // the rays stop at this horizontal distance from the camera
+
+#include "water_surface.glsl"
 
 out VS_OUT
 {
     vec3 pos;
     vec3 normal;
+    vec2 uv;
 } vs_out;
+// The depth pre-pass and the color pass are separate programs, the color one only passes with an equal depth
+invariant gl_Position;
 
-float random( float seed )
+// Position of the vertex on the rest plane
+vec3 restPosition()
 {
-    return fract( sin( seed * 12.9898 ) * 43758.5453 );
-}
-
-// Returns the position and normal of the wave at the given position
-mat2x3 wave( vec3 pos )
-{
-    vec3 newPos = pos;
-    float dx = 0.0;
-    float dz = 0.0;
-    vec3 normal = vec3( 0.0, 1.0, 0.0 );
-
-    float A = amplitude;
-    float c = speed;
-    float w = frequency;
-    vec3 k = vec3( 1.0, 0.0, 0.0 );
-    for( int i = 0; i < numWaves; i++ )
+    if( clipmap )
+        return vec3( aLevel.x, 0.0, aLevel.y ) + aPos * aLevel.z;
+    if( quadtree )
     {
-        float d = dot( k, newPos );
-        float f = A * exp( cos( c * time + w * d ) - 1 );
-        float fp = -w * sin( c * time + w * d ) * f;
-
-        newPos.y += f;
-        dx += k.x * fp;
-        dz += k.z * fp;
-        normal += vec3( dx, 1.0, dz );
-
-        A *= ADecay;
-        k = normalize( vec3( random( float( i ) ), 0.0, 1.0 - random( float( i ) ) ) ) * kFactor;
-        // kFactor is how much the wave direction changes between each wave in [0, 1]
-        // I don't know weither or not this is physically accurate or has any real-world equivalent but it looks good
-        w *= wIncrease;
+        // The edges along a coarser tile keep the vertices it has, the others fold onto them
+        vec3 cell = aPos;
+        if( cell.x == 0.0 )
+            cell.z = floor( cell.z / aStitch.x ) * aStitch.x;
+        else if( cell.x == float( tileCells ) )
+            cell.z = floor( cell.z / aStitch.y ) * aStitch.y;
+        if( cell.z == 0.0 )
+            cell.x = floor( cell.x / aStitch.z ) * aStitch.z;
+        else if( cell.z == float( tileCells ) )
+            cell.x = floor( cell.x / aStitch.w ) * aStitch.w;
+        return vec3( aLevel.x, 0.0, aLevel.y ) + cell * aLevel.z;
     }
-    normal = normalize( normal );
-    return mat2x3( newPos, normal );
+    if( !projectedGrid )
+        return aPos;
+    vec4 far = gridInverseViewProjection * vec4( mix( gridRange.xy, gridRange.zw, aPos.xy ), 1.0, 1.0 );
+    vec3 direction = far.xyz / far.w - viewPos;
+    // Rays toward the plane meet it, unless farther than gridDistance, where the others stop as well
+    if( direction.y * viewPos.y < 0.0 )
+    {
+        vec3 hit = viewPos - direction * ( viewPos.y / direction.y );
+        if( distance( hit.xz, viewPos.xz ) <= gridDistance )
+            return vec3( hit.x, 0.0, hit.z );
+    }
+    float horizontal = length( direction.xz );
+    vec2 offset = horizontal > 0.0 ? direction.xz * ( gridDistance / horizontal ) : vec2( 0.0 );
+    return vec3( viewPos.x + offset.x, 0.0, viewPos.z + offset.y );
 }
 
 void main()
 {
-    mat2x3 waveData = wave( aPos );
-    vs_out.pos = waveData[ 0 ];
-    vs_out.normal = waveData[ 1 ];
+    vec3 rest = restPosition();
+    surface( rest, vs_out.pos, vs_out.normal, vs_out.uv );
     gl_Position = projection * view * vec4( vs_out.pos, 1.0 );
-}
\ No newline at end of file
+}
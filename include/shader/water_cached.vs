@@ -0,0 +1,25 @@
+#version 330 core
+// Pass-through of the surface captured by water.vs, see Mesh::capture
+layout ( location = 0 ) in vec3 aPos;
+layout ( location = 1 ) in vec3 aNormal;
+layout ( location = 2 ) in vec2 aUV;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out VS_OUT
+{
+    vec3 pos;
+    vec3 normal;
+    vec2 uv;
+} vs_out;
+// The depth pre-pass and the color pass are separate programs, the color one only passes with an equal depth
+invariant gl_Position;
+
+void main()
+{
+    vs_out.pos = aPos;
+    vs_out.normal = aNormal;
+    vs_out.uv = aUV;
+    gl_Position = projection * view * vec4( aPos, 1.0 );
+}
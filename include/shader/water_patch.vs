@@ -0,0 +1,13 @@
+#version 400 core
+layout ( location = 0 ) in vec3 aPos; // corner of a patch in patches, see WaterPatches
+
+uniform vec2 patchOrigin; // world position of the first corner of the grid
+uniform float patchWidth;
+
+out vec3 vertexRest;
+
+void main()
+{
+    // Placed on the rest plane only, the evaluation stage displaces the vertices it generates
+    vertexRest = vec3( patchOrigin.x, 0.0, patchOrigin.y ) + aPos * patchWidth;
+}
@@ -0,0 +1,74 @@
+// Lighting of the sea shared by the fragment stages that shade it, water.fs for the mesh and horizon.fs for the
+// far field past it
+#ifndef WATER_FAST_MATH
+#define WATER_FAST_MATH 0 // 1 fast, 2 fastest, see wavemodel.glsl
+#endif
+
+uniform vec3 viewPos;
+uniform samplerCube reflectionTexture;
+uniform vec3 fogColor;
+uniform float fogStart;
+uniform float fogEnd;
+uniform float gamma;
+uniform float ambientStrength;
+uniform float shininess;
+uniform float fresnelStrength;
+
+vec3 fog( vec3 color, float depth )
+{
+    float factor = smoothstep( fogStart, fogEnd, depth );
+    return mix( color, fogColor, factor );
+}
+
+// pow( x, n ) of the specular highlight for x in [ 0, 1 ]. The fast tier squares its way up to the fixed
+// exponent of 64, the fastest one uses Schlick's rational approximation x / ( n - n x + x )
+float specularPower( float x, float n )
+{
+#if WATER_FAST_MATH == 1
+    if( n != 64.0 )
+        return pow( x, n );
+    for( int i = 0; i < 6; i++ )
+        x *= x;
+    return x;
+#elif WATER_FAST_MATH == 2
+    return x / ( n - n * x + x );
+#else
+    return pow( x, n );
+#endif
+}
+
+// ( 1 - cos )^5 of Schlick's Fresnel term
+float fresnelPower( float x )
+{
+#if WATER_FAST_MATH
+    float x2 = x * x;
+    return x2 * x2 * x;
+#else
+    return pow( x, 5.0 );
+#endif
+}
+
+// Fogged linear color of the surface at pos, the gamma is left to the caller
+vec3 shade( vec3 pos, vec3 normal )
+{
+    vec3 color = vec3( 0.0, 0.15, 1.0 );
+    // Ambient
+    vec3 ambient = color * 0.1;
+    // Diffuse
+    vec3 lightDir = normalize( vec3( -1.0, 1.0, -1.0 ) );
+    float diff = max( dot( normal, lightDir ), 0.0 );
+    vec3 diffuse = color * diff;
+    // Specular
+    float shininess = 64.0;
+    vec3 reflectDir = reflect( -lightDir, normal );
+    vec3 viewDir = normalize( viewPos - pos );
+    vec3 halfwayDir = normalize( lightDir + viewDir );
+    float spec = specularPower( max( dot( normal, halfwayDir ), 0.0 ), shininess );
+    float fresnel = 0.02 + ( 1.0 - 0.02 ) * fresnelStrength * fresnelPower( 1.0 - clamp( dot( viewDir, normal ), 0.0, 1.0 ) );
+    vec3 specular = vec3( 0.4 ) * spec * fresnel;
+
+    vec3 reflectColor = texture( reflectionTexture, reflectDir ).rgb;
+
+    vec3 rgb = mix( ambient + diffuse + specular, reflectColor, fresnel );
+    return fog( rgb, length( viewPos - pos ) );
+}
@@ -0,0 +1,103 @@
+// Displacement of the sea shared by the stages that place the surface, water.vs and water.tes : the waves of the
+// active mode and the ripples of the wake over a point of the rest plane
+uniform int numWaves;
+uniform samplerBuffer waveTable; // one texel per wave : ( k.x, k.z, amplitude, omega ), built by WaveSpectrum
+uniform samplerBuffer wavePhases; // omega * time of every wave wrapped to [ 0, 2 pi ), see WavePhases
+uniform int waveMode; // 0 sum of sines, 1 FFT displacement map, 2 baked loop, 3 sum of sines computed into maps
+uniform sampler2D displacementMap;
+uniform sampler2D normalMap;
+uniform vec2 mapOrigin; // window of the computed maps, see ComputeWaves
+uniform float mapSize;
+uniform float patchSize;
+uniform sampler3D bakedWaves; // ( normal.xyz, height ) tiled over patchSize, third axis is time, see BakedWaves
+uniform float bakedCycle; // position in the loop in [ 0, 1 )
+uniform vec3 viewPos;
+uniform float lodPixels; // waves spanning fewer pixels than this on screen fade out, 0 disables the LOD
+uniform float lodScale; // pixels covered by one meter seen from one meter away
+uniform bool wakeEnabled;
+uniform sampler2D wakeField; // ( height, previous height ) of the ripples, stored toroidally, see WakeField
+uniform vec2 wakeOrigin; // world position of the first corner of the simulated window
+uniform float wakeSize;
+
+#include "wavemodel.glsl"
+
+// Returns the position and normal of the wave at the given position
+mat2x3 wave( vec3 pos )
+{
+    vec3 newPos = pos;
+    float dx = 0.0;
+    float dz = 0.0;
+    vec3 normal = vec3( 0.0, 1.0, 0.0 );
+    float pixelsPerMeter = lodScale / max( distance( viewPos, pos ), 1e-3 );
+
+    for( int i = 0; i < numWaves; i++ )
+    {
+        vec4 w = texelFetch( waveTable, i );
+        // Waves fade out between 2 and 1 times lodPixels of projected wavelength. The wavenumbers increase along
+        // the table after its first wave ( see WaveSpectrum ), the first legacy one is shorter than those right
+        // after it : past the first wave, once one is gone the following ones are too small as well
+        float weight = 1.0;
+        if( lodPixels > 0.0 )
+        {
+            float wavelengthPixels = 6.2831853 / max( length( w.xy ), 1e-6 ) * pixelsPerMeter;
+            weight = smoothstep( lodPixels, 2.0 * lodPixels, wavelengthPixels );
+            if( weight == 0.0 )
+            {
+                if( i > 0 )
+                    break;
+                continue;
+            }
+        }
+        vec3 contribution = weight * waveSample( w, texelFetch( wavePhases, i ).r, pos.xz );
+
+        newPos.y += contribution.x;
+        dx += contribution.y;
+        dz += contribution.z;
+        // Weighting the normal term as well keeps the normal continuous through the fade
+        normal += weight * vec3( dx, 1.0, dz );
+    }
+    normal = normalize( normal );
+    return mat2x3( newPos, normal );
+}
+
+// Height of the ripples, zero outside of the simulated window
+float wakeHeight( vec2 xz )
+{
+    vec2 local = xz - wakeOrigin;
+    if( !wakeEnabled || any( lessThan( local, vec2( 0.0 ) ) ) || any( greaterThanEqual( local, vec2( wakeSize ) ) ) )
+        return 0.0;
+    return textureLod( wakeField, xz / wakeSize, 0.0 ).x;
+}
+
+// Displaced position, normal and texture coordinates of the surface over the rest position
+void surface( vec3 rest, out vec3 pos, out vec3 normal, out vec2 uv )
+{
+    uv = rest.xz / patchSize;
+    if( waveMode == 1 )
+    {
+        // The spectral ocean is precomputed, the normal is read per fragment from the normal map
+        pos = rest + textureLod( displacementMap, uv, 0.0 ).xyz;
+        normal = vec3( 0.0, 1.0, 0.0 );
+    }
+    else if( waveMode == 2 )
+    {
+        vec4 baked = textureLod( bakedWaves, vec3( uv, bakedCycle ), 0.0 );
+        pos = rest + vec3( 0.0, baked.w, 0.0 );
+        normal = baked.xyz;
+    }
+    else if( waveMode == 3 && all( greaterThanEqual( rest.xz, mapOrigin ) ) && all( lessThan( rest.xz, mapOrigin + mapSize ) ) )
+    {
+        vec2 mapUV = ( rest.xz - mapOrigin ) / mapSize;
+        pos = rest + textureLod( displacementMap, mapUV, 0.0 ).xyz;
+        normal = normalize( textureLod( normalMap, mapUV, 0.0 ).xyz );
+    }
+    else
+    {
+        // Also the vertices out of the window of the computed maps
+        mat2x3 waveData = wave( rest );
+        pos = waveData[ 0 ];
+        normal = waveData[ 1 ];
+    }
+    // The ripples are a local correction on top of any of the modes, their normal is added per fragment
+    pos.y += wakeHeight( rest.xz );
+}
@@ -0,0 +1,58 @@
+#version 430 core
+
+// Sum of waves written into the displacement and normal maps sampled by water.vs, see ComputeWaves
+#define GROUP_SIZE 16
+#define CHUNK ( GROUP_SIZE * GROUP_SIZE )
+
+layout ( local_size_x = GROUP_SIZE, local_size_y = GROUP_SIZE ) in;
+
+layout ( rgba32f, binding = 0 ) writeonly uniform image2D displacementMap;
+layout ( rgba32f, binding = 1 ) writeonly uniform image2D normalMap;
+uniform samplerBuffer waveTable; // ( k.x, k.z, amplitude, omega )
+uniform samplerBuffer wavePhases;
+uniform int numWaves;
+uniform vec2 origin; // world position of the first texel's corner
+uniform float texelSize;
+uniform float maxWavenumber; // waves above it would alias in the maps
+
+#include "wavemodel.glsl"
+
+// One chunk of the table, loaded by the whole group : one wave per invocation
+shared vec4 waves[ CHUNK ];
+shared float phases[ CHUNK ];
+
+void main()
+{
+    ivec2 texel = ivec2( gl_GlobalInvocationID.xy );
+    vec2 xz = origin + ( vec2( texel ) + 0.5 ) * texelSize;
+
+    float height = 0.0;
+    float dx = 0.0;
+    float dz = 0.0;
+    vec3 normal = vec3( 0.0, 1.0, 0.0 );
+    for( int first = 0; first < numWaves; first += CHUNK )
+    {
+        int i = first + int( gl_LocalInvocationIndex );
+        waves[ gl_LocalInvocationIndex ] = i < numWaves ? texelFetch( waveTable, i ) : vec4( 0.0 );
+        phases[ gl_LocalInvocationIndex ] = i < numWaves ? texelFetch( wavePhases, i ).r : 0.0;
+        barrier();
+
+        int count = min( CHUNK, numWaves - first );
+        for( int j = 0; j < count; j++ )
+        {
+            vec4 w = waves[j];
+            if( dot( w.xy, w.xy ) > maxWavenumber * maxWavenumber )
+                continue;
+            vec3 contribution = waveSample( w, phases[j], xz );
+            height += contribution.x;
+            dx += contribution.y;
+            dz += contribution.z;
+            // Same accumulation as wave() in water.vs
+            normal += vec3( dx, 1.0, dz );
+        }
+        // The chunk is overwritten only once every invocation is done with it
+        barrier();
+    }
+    imageStore( displacementMap, texel, vec4( 0.0, height, 0.0, 0.0 ) );
+    imageStore( normalMap, texel, vec4( normalize( normal ), 0.0 ) );
+}
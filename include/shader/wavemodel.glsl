@@ -0,0 +1,87 @@
+// Wave model shared by the shaders and the C++ code
+// The text is written in the common subset of GLSL 3.30 and C++ with glm : the shaders include it through Shader,
+// wavemodel.hpp compiles the very same lines, so there is only one definition to change
+// Keep to scalars and glm types, float literals with an f suffix, no swizzles and no out parameters
+#ifndef WAVE_FUNCTION
+#define WAVE_FUNCTION
+#endif
+#ifndef WATER_FAST_MATH
+#define WATER_FAST_MATH 0
+#endif
+
+// Integer hash ( lowbias32 ), the same bits on every driver and compiler unlike fract( sin( x ) * 43758.5453 )
+WAVE_FUNCTION uint waveHash( uint x )
+{
+    x ^= x >> 16u;
+    x *= 0x7feb352du;
+    x ^= x >> 15u;
+    x *= 0x846ca68bu;
+    x ^= x >> 16u;
+    return x;
+}
+
+// Uniform number in [ 0, 1 ) built from the top 24 bits of the hash, so the conversion to float is exact
+WAVE_FUNCTION float waveRandom( uint key )
+{
+    return float( waveHash( key ) >> 8u ) * ( 1.0f / 16777216.0f );
+}
+
+#if WATER_FAST_MATH
+// Fast math tiers of the water shader, selected with WATER_FAST_MATH 1 ( fast ) or 2 ( fastest ) and measured
+// against the exact path by VertexProbe. The C++ side never defines it and always follows the exact model
+
+// ( sin( x ), cos( x ) ) : reduction to a quarter turn around a multiple of pi / 2, where the Taylor series converge
+// quickly, then rotation by the quadrant. Errors below 4e-6 ( fast ) and 4e-4 ( fastest ) on top of the reduction
+WAVE_FUNCTION vec2 waveSinCos( float x )
+{
+    float quadrant = floor( x * 0.63661977f + 0.5f );
+    // Past 1e7 rad the reduction loses every bit, the clamp keeps the result bounded as the built-ins do
+    float a = clamp( x - quadrant * 1.57079633f, -0.78539816f, 0.78539816f );
+    float a2 = a * a;
+#if WATER_FAST_MATH == 1
+    float s = a * ( 1.0f + a2 * ( -1.0f / 6.0f + a2 * ( 1.0f / 120.0f - a2 * ( 1.0f / 5040.0f ) ) ) );
+    float c = 1.0f + a2 * ( -0.5f + a2 * ( 1.0f / 24.0f - a2 * ( 1.0f / 720.0f ) ) );
+#else
+    float s = a * ( 1.0f + a2 * ( -1.0f / 6.0f + a2 * ( 1.0f / 120.0f ) ) );
+    float c = 1.0f + a2 * ( -0.5f + a2 * ( 1.0f / 24.0f ) );
+#endif
+    int q = int( quadrant ) & 3;
+    if( q == 0 )
+        return vec2( s, c );
+    if( q == 1 )
+        return vec2( c, -s );
+    if( q == 2 )
+        return vec2( -s, -c );
+    return vec2( -c, s );
+}
+
+// exp( c - 1 ) for c in [ -1, 1 ] : e^-1 * ( e^( c / 4 ) )^4 with e^( c / 4 ) from its Taylor series
+// Relative errors below 2e-6 ( fast ) and 5e-5 ( fastest )
+WAVE_FUNCTION float waveExpCosine( float c )
+{
+    float x = c * 0.25f;
+#if WATER_FAST_MATH == 1
+    float e = 1.0f + x * ( 1.0f + x * ( 0.5f + x * ( 1.0f / 6.0f + x * ( 1.0f / 24.0f + x * ( 1.0f / 120.0f ) ) ) ) );
+#else
+    float e = 1.0f + x * ( 1.0f + x * ( 0.5f + x * ( 1.0f / 6.0f + x * ( 1.0f / 24.0f ) ) ) );
+#endif
+    e *= e;
+    return 0.36787944f * e * e;
+}
+#endif
+
+// Height of one wave of the table ( k.x, k.z, amplitude, omega ) at xz and its derivatives along x and z
+// timePhase is omega * time wrapped to [ 0, 2 pi ), see WavePhases
+WAVE_FUNCTION vec3 waveSample( vec4 wave, float timePhase, vec2 xz )
+{
+    float phase = timePhase + ( wave.x * xz.x + wave.y * xz.y );
+#if WATER_FAST_MATH
+    vec2 sc = waveSinCos( phase );
+    float f = wave.z * waveExpCosine( sc.y );
+    float fp = -sc.x * f;
+#else
+    float f = wave.z * exp( cos( phase ) - 1.0f );
+    float fp = -sin( phase ) * f;
+#endif
+    return vec3( f, wave.x * fp, wave.y * fp );
+}
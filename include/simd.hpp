@@ -0,0 +1,145 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+// Thin wrappers over the widest float vector enabled at compile time ( AVX2 + FMA, SSE2 or scalar )
+// Kernels are written once against vfloat and process SIMD_WIDTH lanes per iteration
+
+#if defined( __AVX2__ ) && ( defined( __FMA__ ) || defined( _MSC_VER ) )
+    #include <immintrin.h>
+    #define SIMD_WIDTH 8
+    #define SIMD_NAME "AVX2"
+    typedef __m256 vfloat;
+
+    inline vfloat vload( const float * p ) noexcept { return _mm256_loadu_ps( p ); }
+    inline void vstore( float * p, vfloat a ) noexcept { _mm256_storeu_ps( p, a ); }
+    inline vfloat vset1( float a ) noexcept { return _mm256_set1_ps( a ); }
+    inline vfloat vadd( vfloat a, vfloat b ) noexcept { return _mm256_add_ps( a, b ); }
+    inline vfloat vsub( vfloat a, vfloat b ) noexcept { return _mm256_sub_ps( a, b ); }
+    inline vfloat vmul( vfloat a, vfloat b ) noexcept { return _mm256_mul_ps( a, b ); }
+    inline vfloat vdiv( vfloat a, vfloat b ) noexcept { return _mm256_div_ps( a, b ); }
+    inline vfloat vmin( vfloat a, vfloat b ) noexcept { return _mm256_min_ps( a, b ); }
+    inline vfloat vmax( vfloat a, vfloat b ) noexcept { return _mm256_max_ps( a, b ); }
+    inline vfloat vsqrt( vfloat a ) noexcept { return _mm256_sqrt_ps( a ); }
+    // a * b + c
+    inline vfloat vfmadd( vfloat a, vfloat b, vfloat c ) noexcept { return _mm256_fmadd_ps( a, b, c ); }
+    // c - a * b
+    inline vfloat vfnmadd( vfloat a, vfloat b, vfloat c ) noexcept { return _mm256_fnmadd_ps( a, b, c ); }
+
+    typedef __m256 vmask;
+    inline vfloat vround( vfloat a ) noexcept { return _mm256_round_ps( a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ); }
+    inline vmask vcmpeq( vfloat a, vfloat b ) noexcept { return _mm256_cmp_ps( a, b, _CMP_EQ_OQ ); }
+    inline vmask vcmplt( vfloat a, vfloat b ) noexcept { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+    inline vmask vmaskor( vmask a, vmask b ) noexcept { return _mm256_or_ps( a, b ); }
+    // mask ? a : b
+    inline vfloat vselect( vmask mask, vfloat a, vfloat b ) noexcept { return _mm256_blendv_ps( b, a, mask ); }
+    // 2^n for integral n in the normal range
+    inline vfloat vpow2i( vfloat n ) noexcept { return _mm256_castsi256_ps( _mm256_slli_epi32( _mm256_add_epi32( _mm256_cvtps_epi32( n ), _mm256_set1_epi32( 127 ) ), 23 ) ); }
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+    #include <emmintrin.h>
+    #define SIMD_WIDTH 4
+    #define SIMD_NAME "SSE2"
+    typedef __m128 vfloat;
+
+    inline vfloat vload( const float * p ) noexcept { return _mm_loadu_ps( p ); }
+    inline void vstore( float * p, vfloat a ) noexcept { _mm_storeu_ps( p, a ); }
+    inline vfloat vset1( float a ) noexcept { return _mm_set1_ps( a ); }
+    inline vfloat vadd( vfloat a, vfloat b ) noexcept { return _mm_add_ps( a, b ); }
+    inline vfloat vsub( vfloat a, vfloat b ) noexcept { return _mm_sub_ps( a, b ); }
+    inline vfloat vmul( vfloat a, vfloat b ) noexcept { return _mm_mul_ps( a, b ); }
+    inline vfloat vdiv( vfloat a, vfloat b ) noexcept { return _mm_div_ps( a, b ); }
+    inline vfloat vmin( vfloat a, vfloat b ) noexcept { return _mm_min_ps( a, b ); }
+    inline vfloat vmax( vfloat a, vfloat b ) noexcept { return _mm_max_ps( a, b ); }
+    inline vfloat vsqrt( vfloat a ) noexcept { return _mm_sqrt_ps( a ); }
+    inline vfloat vfmadd( vfloat a, vfloat b, vfloat c ) noexcept { return _mm_add_ps( _mm_mul_ps( a, b ), c ); }
+    inline vfloat vfnmadd( vfloat a, vfloat b, vfloat c ) noexcept { return _mm_sub_ps( c, _mm_mul_ps( a, b ) ); }
+
+    typedef __m128 vmask;
+    inline vfloat vround( vfloat a ) noexcept { return _mm_cvtepi32_ps( _mm_cvtps_epi32( a ) ); }
+    inline vmask vcmpeq( vfloat a, vfloat b ) noexcept { return _mm_cmpeq_ps( a, b ); }
+    inline vmask vcmplt( vfloat a, vfloat b ) noexcept { return _mm_cmplt_ps( a, b ); }
+    inline vmask vmaskor( vmask a, vmask b ) noexcept { return _mm_or_ps( a, b ); }
+    inline vfloat vselect( vmask mask, vfloat a, vfloat b ) noexcept { return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) ); }
+    inline vfloat vpow2i( vfloat n ) noexcept { return _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( _mm_cvtps_epi32( n ), _mm_set1_epi32( 127 ) ), 23 ) ); }
+#else
+    #include <cmath>
+    #define SIMD_WIDTH 1
+    #define SIMD_NAME "Scalar"
+    typedef float vfloat;
+
+    inline vfloat vload( const float * p ) noexcept { return *p; }
+    inline void vstore( float * p, vfloat a ) noexcept { *p = a; }
+    inline vfloat vset1( float a ) noexcept { return a; }
+    inline vfloat vadd( vfloat a, vfloat b ) noexcept { return a + b; }
+    inline vfloat vsub( vfloat a, vfloat b ) noexcept { return a - b; }
+    inline vfloat vmul( vfloat a, vfloat b ) noexcept { return a * b; }
+    inline vfloat vdiv( vfloat a, vfloat b ) noexcept { return a / b; }
+    inline vfloat vmin( vfloat a, vfloat b ) noexcept { return a < b ? a : b; }
+    inline vfloat vmax( vfloat a, vfloat b ) noexcept { return a > b ? a : b; }
+    inline vfloat vsqrt( vfloat a ) noexcept { return std::sqrt( a ); }
+    inline vfloat vfmadd( vfloat a, vfloat b, vfloat c ) noexcept { return a * b + c; }
+    inline vfloat vfnmadd( vfloat a, vfloat b, vfloat c ) noexcept { return c - a * b; }
+
+    typedef bool vmask;
+    inline vfloat vround( vfloat a ) noexcept { return std::nearbyint( a ); }
+    inline vmask vcmpeq( vfloat a, vfloat b ) noexcept { return a == b; }
+    inline vmask vcmplt( vfloat a, vfloat b ) noexcept { return a < b; }
+    inline vmask vmaskor( vmask a, vmask b ) noexcept { return a || b; }
+    inline vfloat vselect( vmask mask, vfloat a, vfloat b ) noexcept { return mask ? a : b; }
+    inline vfloat vpow2i( vfloat n ) noexcept { return std::ldexp( 1.0f, static_cast< int >( n ) ); }
+#endif
+
+// Polynomial approximations ( Cephes single precision coefficients ), a few ulps from the libm results
+
+// e^x, x is clamped to the range where the result is a normal float
+inline vfloat vexp( vfloat x ) noexcept
+{
+    x = vmin( vmax( x, vset1( -87.0f ) ), vset1( 88.0f ) );
+    vfloat n = vround( vmul( x, vset1( 1.44269504088896341f ) ) );
+    vfloat r = vfnmadd( n, vset1( 0.693359375f ), x );
+    r = vfnmadd( n, vset1( -2.12194440e-4f ), r );
+    vfloat p = vset1( 1.9875691500e-4f );
+    p = vfmadd( p, r, vset1( 1.3981999507e-3f ) );
+    p = vfmadd( p, r, vset1( 8.3334519073e-3f ) );
+    p = vfmadd( p, r, vset1( 4.1665795894e-2f ) );
+    p = vfmadd( p, r, vset1( 1.6666665459e-1f ) );
+    p = vfmadd( p, r, vset1( 5.0000001201e-1f ) );
+    p = vfmadd( p, vmul( r, r ), vadd( r, vset1( 1.0f ) ) );
+    return vmul( p, vpow2i( n ) );
+}
+
+// sin( x ) and cos( x ) together, accurate for |x| up to a few thousands
+// Beyond that the reduction loses every bit, the results are then only kept in [ -1, 1 ] like the GPU ones
+inline void vsincos( vfloat x, vfloat & s, vfloat & c ) noexcept
+{
+    // Cody-Waite reduction to [ -pi / 4, pi / 4 ] and quadrant q in { 0, 1, 2, 3 }
+    vfloat j = vround( vmul( x, vset1( 0.636619772367581343f ) ) );
+    vfloat r = vfnmadd( j, vset1( 1.5703125f ), x );
+    r = vfnmadd( j, vset1( 4.837512969970703125e-4f ), r );
+    r = vfnmadd( j, vset1( 7.54978995489188216e-8f ), r );
+    // j / 4 is a multiple of 0.25, shifting it by 0.375 makes the rounding a floor without ties
+    vfloat q = vfnmadd( vround( vsub( vmul( j, vset1( 0.25f ) ), vset1( 0.375f ) ) ), vset1( 4.0f ), j );
+
+    vfloat r2 = vmul( r, r );
+    vfloat sp = vset1( -1.9515295891e-4f );
+    sp = vfmadd( sp, r2, vset1( 8.3321608736e-3f ) );
+    sp = vfmadd( sp, r2, vset1( -1.6666654611e-1f ) );
+    sp = vfmadd( vmul( sp, r2 ), r, r );
+    vfloat cp = vset1( 2.443315711809948e-5f );
+    cp = vfmadd( cp, r2, vset1( -1.388731625493765e-3f ) );
+    cp = vfmadd( cp, r2, vset1( 4.166664568298827e-2f ) );
+    cp = vfmadd( vmul( cp, r2 ), r2, vfnmadd( vset1( 0.5f ), r2, vset1( 1.0f ) ) );
+
+    sp = vmin( vmax( sp, vset1( -1.0f ) ), vset1( 1.0f ) );
+    cp = vmin( vmax( cp, vset1( -1.0f ) ), vset1( 1.0f ) );
+
+    vmask q1 = vcmpeq( q, vset1( 1.0f ) );
+    vmask q2 = vcmpeq( q, vset1( 2.0f ) );
+    vmask q3 = vcmpeq( q, vset1( 3.0f ) );
+    vmask odd = vmaskor( q1, q3 );
+    vfloat sinValue = vselect( odd, cp, sp );
+    vfloat cosValue = vselect( odd, sp, cp );
+    s = vselect( vmaskor( q2, q3 ), vsub( vset1( 0.0f ), sinValue ), sinValue );
+    c = vselect( vmaskor( q1, q2 ), vsub( vset1( 0.0f ), cosValue ), cosValue );
+}
+
+#endif
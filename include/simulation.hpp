@@ -0,0 +1,94 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <oceancpu.hpp>
+#include <triplebuffer.hpp>
+#include <ringexport.hpp>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Inputs of the simulation, set by the render thread every frame
+struct SimulationSettings
+{
+    bool oceanEnabled = false; // the CPU ocean only runs while it is displayed
+    float amplitude = 1.0f;
+    float windSpeed = 10.0f;
+    glm::vec2 windDirection = glm::vec2( 1.0f, 0.0f );
+    float choppiness = 1.0f;
+    float speed = 1.0f;
+    double timeOffset = 0.0; // added to the simulation clock before scaling by speed
+    std::string exportPath; // ring file every tick is written to, see RingExport, empty to disable the export
+};
+
+// State of the simulation at the end of one tick
+struct SimulationSnapshot
+{
+    unsigned long tick = 0;
+    double time = 0.0; // seconds on the simulation clock
+    std::vector< glm::vec4 > displacement;
+    std::vector< glm::vec4 > normals;
+};
+
+// Wave simulation advancing at a fixed tick rate on its own thread, independently of the frame rate
+// Every tick publishes a snapshot through a triple buffer, the render thread blends the last two received
+// at one tick in the past, so the motion stays smooth whatever the phase between ticks and frames
+// Ticks missed by more than a period are dropped rather than run back to back
+class Simulation
+{
+    public :
+        Simulation( double tickRate = 60.0, int resolution = 256, float patchSize = 128.0f,
+                    unsigned int threadCount = std::max( 2u, std::thread::hardware_concurrency() ) - 1 );
+        ~Simulation();
+
+        Simulation( const Simulation & ) = delete;
+        Simulation & operator=( const Simulation & ) = delete;
+
+        // Render thread side
+        void setSettings( const SimulationSettings & settings ) noexcept;
+        // Writes the ocean maps interpolated at the current time, returns false until a tick of the ocean ran
+        bool interpolate( std::vector< glm::vec4 > & displacement, std::vector< glm::vec4 > & normals );
+
+        // Seconds elapsed on the simulation clock since the construction
+        double getTime() const noexcept;
+        double getTickRate() const noexcept;
+        float getTickTime() const noexcept; // smoothed milliseconds of work per tick
+        unsigned long getDroppedTicks() const noexcept;
+        unsigned long getExportedFrames() const noexcept;
+        float getExportTime() const noexcept; // smoothed milliseconds per exported frame
+        bool hasExportFailed() const noexcept; // the ring file of the current path could not be created
+        int getResolution() const noexcept;
+        float getPatchSize() const noexcept;
+
+    private :
+        double tickRate;
+        OceanCPU ocean;
+        std::chrono::steady_clock::time_point start;
+
+        TripleBuffer< SimulationSettings > settings;
+        TripleBuffer< SimulationSnapshot > snapshots;
+        SimulationSnapshot previous; // snapshot received before the front one, owned by the render thread
+
+        std::thread worker;
+        std::atomic< bool > stop;
+        std::atomic< float > tickTime;
+        std::atomic< unsigned long > droppedTicks;
+
+        // Owned by the worker, the frames are written on the simulation thread right after each tick
+        std::unique_ptr< RingExport > exporter;
+        std::string exportPath;
+        std::atomic< unsigned long > exportedFrames;
+        std::atomic< float > exportTime;
+        std::atomic< bool > exportFailed;
+
+        void updateExport( const SimulationSettings & settings ) noexcept;
+
+        void run() noexcept;
+};
+
+#endif
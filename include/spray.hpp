@@ -0,0 +1,108 @@
+#ifndef SPRAY_HPP
+#define SPRAY_HPP
+
+#include <wavecpu.hpp>
+#include <wavespectrum.hpp>
+#include <threadpool.hpp>
+#include <glm/glm.hpp>
+#include <random>
+#include <vector>
+
+// Live particles of the pool, count of them from first, wrapping around at the capacity
+// Particles that died before the oldest live one have a fade of 1 or more and are not drawn
+struct SprayPool
+{
+    const float * x;
+    const float * y;
+    const float * z;
+    const float * fade; // 0 when emitted or landed, the particle dies at 1
+    const float * foam; // 1 once landed, the foam follows the surface instead of its own height
+    int capacity;
+    int first;
+    int count;
+};
+
+struct SprayParameters
+{
+    float steepness = 0.8f; // slope of the surface ( tangent of its angle ) over which crests emit spray
+    float emissionRate = 40.0f; // particles per second and m² of surface at twice the steepness threshold
+    float sprayLife = 2.0f; // mean seconds the spray takes to fade, each particle gets between half and 1.5 times this
+    float foamLife = 4.0f; // the foam left by a particle lasts this many times its spray life
+    float gravity = 9.81f;
+    float sprayDrag = 0.5f; // fraction of the velocity lost per second in the air
+    float foamDrag = 0.8f; // on the surface
+    glm::vec2 wind = glm::vec2( 10.0f, 0.0f ); // m/s, a fraction of it pushes the emitted spray
+};
+
+// Spray and foam thrown by the breaking crests of the sum of waves
+// The crests are found by evaluating the wave table on a grid around a center point, the particles live in a
+// ring of structure of arrays lanes : emitted at the head, retired from the tail once dead, so the live ones stay
+// in one range that is streamed to the GPU as is. Particles dying out of order stay in the range until the older
+// ones are gone, the update runs SIMD_WIDTH of them per iteration, split between the pool threads
+class Spray
+{
+    public :
+        // capacity is rounded up to a multiple of the SIMD width, the emitter samples resolution² points over size² m
+        Spray( int capacity = 1 << 19, int emitterResolution = 128, float emitterSize = 128.0f,
+               unsigned int threadCount = std::thread::hardware_concurrency() );
+
+        Spray( const Spray & ) = delete;
+        Spray & operator=( const Spray & ) = delete;
+
+        // Copies the wave table when the spectrum version changed
+        void setWaves( const WaveSpectrum & spectrum );
+        void setParameters( const SprayParameters & parameters ) noexcept;
+        // Moves the emitter, snapped to its grid so the sampled points do not swim
+        void setCenter( glm::vec2 center ) noexcept;
+        // World point the center and the particles are given relative to, the live particles move with it
+        void setOrigin( glm::dvec2 origin ) noexcept;
+
+        // Emits the spray of the crests over the grid at the given time, for deltaTime seconds
+        // phases are those the surface is drawn with, WavePhases::getPhases for the table of the last setWaves,
+        // omega * time is used when they are not given or do not match it
+        void emit( double time, float deltaTime, const std::vector< float > & phases = std::vector< float >() );
+        // Moves every live particle deltaTime seconds forward and retires the dead ones at the tail
+        void update( float deltaTime ) noexcept;
+        void clear() noexcept;
+
+        SprayPool getPool() const noexcept;
+        int getCapacity() const noexcept;
+        int getLiveCount() const noexcept;
+        // Points of the last emission over the steepness threshold
+        int getCrestCount() const noexcept;
+        unsigned int getThreadCount() const noexcept;
+
+    private :
+        int capacity;
+        int emitterResolution;
+        float emitterSize;
+        float cellSize;
+        SprayParameters parameters;
+        glm::vec2 emitterOrigin = glm::vec2( 0.0f );
+        glm::dvec2 origin = glm::dvec2( 0.0 );
+        ThreadPool pool;
+        std::mt19937 random;
+
+        std::vector< WaveComponent > waves;
+        unsigned long wavesVersion = 0;
+        // Surface sampled on the emitter grid
+        std::vector< float > gridX;
+        std::vector< float > gridZ;
+        std::vector< float > gridHeight;
+        std::vector< float > gridNormalX;
+        std::vector< float > gridNormalY;
+        std::vector< float > gridNormalZ;
+        int crestCount = 0;
+
+        // Particle lanes, rate is the fade gained per second and floor the height the spray lands at
+        std::vector< float > x, y, z;
+        std::vector< float > velocityX, velocityY, velocityZ;
+        std::vector< float > fade, rate, floor, foam;
+        // Logical indices of the oldest live particle and of the next one emitted, slot = index % capacity
+        unsigned long long tail = 0;
+        unsigned long long head = 0;
+
+        void spawn( glm::vec3 position, glm::vec3 velocity, float life ) noexcept;
+};
+
+#endif
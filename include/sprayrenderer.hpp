@@ -0,0 +1,36 @@
+#ifndef SPRAYRENDERER_HPP
+#define SPRAYRENDERER_HPP
+
+#include <spray.hpp>
+#include <shader.hpp>
+
+// Draws the live range of a Spray pool with one instanced draw of camera facing quads for the spray and of quads
+// lying on the surface for the foam. The lanes are streamed every frame into an orphaned buffer, one block per lane
+class SprayRenderer
+{
+    public :
+        explicit SprayRenderer( int capacity ) noexcept;
+        ~SprayRenderer();
+
+        SprayRenderer( const SprayRenderer & ) = delete;
+        SprayRenderer & operator=( const SprayRenderer & ) = delete;
+
+        // Copies the live particles of the pool, at most the capacity given at construction
+        void upload( const SprayPool & pool ) noexcept;
+        // The caller sets the view, projection, fog and wave table uniforms of getShader() beforehand, the foam
+        // follows the first numWaves waves of the table
+        void draw() noexcept;
+
+        Shader & getShader() noexcept;
+        int getCount() const noexcept;
+
+    private :
+        static const int LANE_COUNT = 5;
+        int capacity;
+        int count = 0;
+        unsigned int vao;
+        unsigned int vbo;
+        Shader shader = { "../include/shader/spray.vs", "../include/shader/spray.fs" };
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef STREAMTEXTURE_HPP
+#define STREAMTEXTURE_HPP
+
+// RGBA float texture refreshed from CPU memory every frame through an orphaned pixel buffer,
+// so the upload does not stall on the draws still reading last frame's content
+class StreamTexture
+{
+    public :
+        StreamTexture( int width, int height, int internalFormat, bool mipmaps = false ) noexcept;
+        ~StreamTexture();
+
+        StreamTexture( const StreamTexture & ) = delete;
+        StreamTexture & operator=( const StreamTexture & ) = delete;
+
+        // data holds width * height RGBA floats
+        void upload( const float * data ) noexcept;
+        void bind( unsigned int unit ) const noexcept;
+
+        unsigned int getId() const noexcept;
+
+    private :
+        int width;
+        int height;
+        bool mipmaps;
+        unsigned int texture;
+        unsigned int pbo;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+// Fixed set of workers running data parallel loops, the calling thread takes part in the work
+class ThreadPool
+{
+    public :
+        explicit ThreadPool( unsigned int threadCount = std::thread::hardware_concurrency() );
+        ~ThreadPool();
+
+        ThreadPool( const ThreadPool & ) = delete;
+        ThreadPool & operator=( const ThreadPool & ) = delete;
+
+        // Splits [ 0, count ) into ranges and blocks until task( begin, end ) ran on all of them
+        // The ranges are multiples of granularity except the last one
+        void parallelFor( int count, const std::function< void( int, int ) > & task, int granularity = 1 );
+
+        unsigned int getThreadCount() const noexcept;
+
+    private :
+        std::vector< std::thread > workers;
+        std::mutex submitMutex;
+        std::mutex mutex;
+        std::condition_variable wakeCondition;
+        std::condition_variable doneCondition;
+
+        const std::function< void( int, int ) > * task = nullptr;
+        int count = 0;
+        int chunkSize = 1;
+        int chunkCount = 0;
+        std::atomic< int > nextChunk;
+        unsigned int pending = 0;
+        unsigned long generation = 0;
+        bool stop = false;
+
+        void workerLoop() noexcept;
+        void runChunks() noexcept;
+};
+
+#endif
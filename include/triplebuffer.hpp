@@ -0,0 +1,63 @@
+#ifndef TRIPLEBUFFER_HPP
+#define TRIPLEBUFFER_HPP
+
+#include <atomic>
+
+// Lock free single producer, single consumer channel keeping the latest value
+// The writer fills back() and publishes it, the reader acquires the latest published value into front().
+// Each side owns one of the three slots, the third one is exchanged atomically between them, so neither
+// side ever waits for the other and the reader skips the values published while it was busy
+template< typename T >
+class TripleBuffer
+{
+    public :
+        TripleBuffer() noexcept : middle( 2 ) {}
+
+        TripleBuffer( const TripleBuffer & ) = delete;
+        TripleBuffer & operator=( const TripleBuffer & ) = delete;
+
+        // Writer side
+        T & back() noexcept
+        {
+            return slots[ backIndex ];
+        }
+
+        void publish() noexcept
+        {
+            // The release half hands the content of the slot over, the acquire half makes sure the reader is done with the one received
+            backIndex = middle.exchange( backIndex | FRESH, std::memory_order_acq_rel ) & INDEX_MASK;
+        }
+
+        // Reader side
+        // True when a value was published since the last acquire
+        bool isFresh() const noexcept
+        {
+            return middle.load( std::memory_order_relaxed ) & FRESH;
+        }
+
+        // Moves the latest published value to front(), returns false when there was none
+        bool acquire() noexcept
+        {
+            if( !isFresh() )
+                return false;
+            frontIndex = middle.exchange( frontIndex, std::memory_order_acq_rel ) & INDEX_MASK;
+            return true;
+        }
+
+        // The reader may modify its slot, it is overwritten by the writer before being published again
+        T & front() noexcept
+        {
+            return slots[ frontIndex ];
+        }
+
+    private :
+        static const unsigned int INDEX_MASK = 3;
+        static const unsigned int FRESH = 4;
+
+        T slots[ 3 ];
+        std::atomic< unsigned int > middle; // index of the exchanged slot, FRESH when it holds a value the reader has not acquired
+        unsigned int backIndex = 0;
+        unsigned int frontIndex = 1;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef VERTEXPROBE_HPP
+#define VERTEXPROBE_HPP
+
+#include <glm/glm.hpp>
+#include <shader.hpp>
+#include <mesh.hpp>
+#include <vector>
+
+// Difference between the surfaces output by two vertex programs
+struct VertexError
+{
+    float maxHeight = 0.0f; // meters
+    float rmsHeight = 0.0f;
+    float maxNormal = 0.0f; // degrees
+    float rmsNormal = 0.0f;
+};
+
+// Compares two variants of the water vertex stage on a grid of points around a center : both programs run over
+// the same points with transform feedback, their positions and normals are read back and compared
+// The programs are the ones capturing the surface for Mesh::capture, their uniforms are set by the caller
+class VertexProbe
+{
+    public :
+        VertexProbe( int resolution = 128, float spacing = 1.5f ) noexcept;
+        ~VertexProbe();
+
+        VertexProbe( const VertexProbe & ) = delete;
+        VertexProbe & operator=( const VertexProbe & ) = delete;
+
+        // Blocks until both results are available, run it once in a while rather than every frame
+        VertexError measure( const Shader & reference, const Shader & candidate, glm::vec2 center ) noexcept;
+
+    private :
+        int resolution;
+        float spacing;
+        unsigned int VAO;
+        unsigned int VBO;
+        unsigned int feedbackBuffer;
+        std::vector< glm::vec3 > points;
+
+        void capture( const Shader & shader, std::vector< CapturedVertex > & output ) noexcept;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef WAKEFIELD_HPP
+#define WAKEFIELD_HPP
+
+#include <glm/glm.hpp>
+#include <shader.hpp>
+#include <vector>
+
+#define WAKE_MAX_SOURCES 16
+
+// Local ripples and wakes added on top of the analytic waves : a 2D wave equation solved on the GPU over a
+// square window of resolution² cells that follows the camera, stepped at a fixed rate in ping-pong framebuffers
+// The window scrolls toroidally, world cell w is always stored in texel w mod resolution, so moving it only
+// clears the cells that entered it and the surface can be sampled with REPEAT at pos.xz / size
+class WakeField
+{
+    public :
+        // waveSpeed in m/s, damping is the fraction of the velocity lost per second
+        WakeField( int resolution = 1024, float size = 256.0f, float waveSpeed = 4.0f, float damping = 0.2f, float stepRate = 60.0f );
+        ~WakeField();
+
+        WakeField( const WakeField & ) = delete;
+        WakeField & operator=( const WakeField & ) = delete;
+
+        // Moves the window so the given point stays in the middle, snapped to the cells
+        void setCenter( glm::vec2 center ) noexcept;
+        // Moves the coordinates by offset m, when the floating origin they are relative to moves by it. The ripples
+        // stay where they are as long as offset is a multiple of the size, the field is cleared otherwise
+        void rebase( glm::vec2 offset ) noexcept;
+        // Pushes the surface around position with a gaussian of the given radius, speed in m/s ( negative to push it down )
+        // Sources last for duration seconds, 0 applies them to the steps of the next update only so moving objects
+        // can add themselves every frame
+        void addSource( glm::vec2 position, float radius, float speed, float duration = 0.0f ) noexcept;
+        // Runs the fixed steps covering deltaTime seconds, at most a few of them after a hitch
+        void update( float deltaTime ) noexcept;
+        // Clears the field
+        void reset() noexcept;
+
+        // Binds the ( height, previous height ) texture
+        void bind( unsigned int unit ) const noexcept;
+
+        // World position of the window's first corner, in meters
+        glm::vec2 getOrigin() const noexcept;
+        float getSize() const noexcept;
+        int getResolution() const noexcept;
+        unsigned long getStepCount() const noexcept;
+
+    private :
+        int resolution;
+        float size;
+        float cellSize;
+        float waveSpeed;
+        float damping;
+        float stepTime;
+        float accumulator = 0.0f;
+        unsigned long stepCount = 0;
+
+        glm::ivec2 origin = glm::ivec2( 0 ); // first cell of the window in world cells
+        glm::ivec2 shift = glm::ivec2( 0 ); // move not applied to the field yet
+        struct Source
+        {
+            glm::vec2 position;
+            float radius;
+            float speed;
+            float remaining;
+        };
+        std::vector< Source > sources;
+
+        Shader stepShader = { "../include/shader/fullscreen.vs", "../include/shader/wake_step.fs" };
+        unsigned int quadVAO;
+        unsigned int textures[ 2 ];
+        unsigned int framebuffers[ 2 ];
+        int current = 0;
+
+        // Without advance, only clears the cells the window moved onto
+        void step( bool advance ) noexcept;
+};
+
+#endif
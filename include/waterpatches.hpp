@@ -0,0 +1,48 @@
+#ifndef WATERPATCHES_HPP
+#define WATERPATCHES_HPP
+
+#include <glm/glm.hpp>
+#include <shader.hpp>
+
+// Coarse grid of square patches around the camera subdivided by the tessellation stages ( GL 4.0 ), see water.tcs
+// and water.tes : the density of the surface follows a target number of pixels per triangle on screen instead of
+// the vertices of a mesh, and the waves are evaluated on the vertices the tessellator generates
+// Throws when the context has no tessellation shaders, the other meshes stay available then
+class WaterPatches
+{
+    public :
+        // loader resolves the GL 4.0 entry points glad was not generated for, glfwGetProcAddress for instance
+        // The grid reaches distance m from the camera in every direction
+        WaterPatches( void * ( *loader )( const char * ), float distance = 100.0f, float patchWidth = 8.0f );
+        ~WaterPatches();
+
+        WaterPatches( const WaterPatches & ) = delete;
+        WaterPatches & operator=( const WaterPatches & ) = delete;
+
+        // Snaps the grid around the camera
+        void update( glm::vec3 cameraPosition ) noexcept;
+        // Sets the placement of the grid and the finest level the tessellator allows
+        void setUniforms( const Shader & shader ) const noexcept;
+        // Draws the patches with a tessellation program active
+        void draw() const noexcept;
+
+        int getPatchesAcross() const noexcept;
+        unsigned int getVertexCount() const noexcept; // corners of the patches
+        float getPatchWidth() const noexcept;
+        // Finest spacing the vertices can reach
+        float getMinSpacing() const noexcept;
+
+    private :
+        int across;
+        float patchWidth;
+        float maxLevel;
+        unsigned int indexCount;
+        glm::vec2 origin = glm::vec2( 0.0f );
+
+        unsigned int vao, vbo, ebo;
+
+        // GL 4.0 entry point, cast to its type in the source
+        void * patchParameteri = nullptr;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef WAVECPU_HPP
+#define WAVECPU_HPP
+
+#include <wavespectrum.hpp>
+#include <wavephases.hpp>
+
+// CPU port of wave() in water.vs, evaluating the WaveSpectrum table on batches of points
+// The reference calls waveSample of wavemodel.glsl like the shader, the SIMD kernels are a port of it
+//
+// Tolerance against the shader, measured on Mesa llvmpipe for the physical spectra over a 220 m grid :
+// height errors below 4e-6 times the sum of amplitudes and normal errors below 2e-6. Both sides get their phases
+// wrapped in double precision ( WavePhases, see SurfaceBatch::phases ), so the errors do not grow with time
+// Legacy tables with more than ~30 waves have wavenumbers whose phases exceed float precision on either
+// side, the heights still agree but the normals only share their large scale shape
+
+// Structure of arrays view of a batch of surface points
+// Inputs are the rest positions ( x, z ) relative to the world point origin, outputs the height added to the rest
+// position and the unit normal
+struct SurfaceBatch
+{
+    const float * x;
+    const float * z;
+    float * height;
+    float * normalX;
+    float * normalY;
+    float * normalZ;
+    int count;
+    glm::dvec2 origin = glm::dvec2( 0.0 ); // folded into the phases in double precision, see WavePhases
+    // One phase per wave with the origin already folded in, WavePhases::getPhases, so the batch follows the
+    // accumulated phases the shader draws and not omega * time, which drifts from them once the speed or spectrum changed
+    // When null the phases are omega * time at origin
+    const float * phases = nullptr;
+};
+
+// Scalar reference, a line by line translation of the shader using the standard library exp, sin and cos
+void evaluateWavesReference( const WaveComponent * waves, int waveCount, double time, const SurfaceBatch & batch ) noexcept;
+
+// SIMD_WIDTH points per iteration with the polynomial exp and sincos of simd.hpp, any wave count
+void evaluateWavesLoop( const WaveComponent * waves, int waveCount, double time, const SurfaceBatch & batch ) noexcept;
+
+// Same kernel with the wave count known at compile time so the wave loop is fully unrolled
+// Instantiated for 8, 16, 32 and 64 waves
+template< int WAVES >
+void evaluateWavesFixed( const WaveComponent * waves, double time, const SurfaceBatch & batch ) noexcept;
+
+// Picks evaluateWavesFixed when an instantiation matches waveCount, evaluateWavesLoop otherwise
+void evaluateWaves( const WaveComponent * waves, int waveCount, double time, const SurfaceBatch & batch ) noexcept;
+
+#endif
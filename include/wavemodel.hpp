@@ -0,0 +1,19 @@
+#ifndef WAVEMODEL_HPP
+#define WAVEMODEL_HPP
+
+#include <glm/glm.hpp>
+#include <cmath>
+
+// C++ side of the wave model of wavemodel.glsl, the shader source is compiled as is with glm standing in for
+// the GLSL types and built-in functions
+namespace waveModel
+{
+    using namespace glm;
+    typedef unsigned int uint;
+
+#define WAVE_FUNCTION inline
+#include <wavemodel.glsl>
+#undef WAVE_FUNCTION
+}
+
+#endif
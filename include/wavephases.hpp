@@ -0,0 +1,37 @@
+#ifndef WAVEPHASES_HPP
+#define WAVEPHASES_HPP
+
+#include <wavespectrum.hpp>
+#include <vector>
+
+// omega * time wrapped to [ 0, 2 pi ), computed in double precision
+// A float time has a step of 2 ms after 4 hours and 0.25 s after a month, its product with omega quantizes the animation
+float wavePhase( float omega, double time ) noexcept;
+// Same with the phase of the wave at the world point origin added, for positions given relative to it
+float wavePhase( const WaveComponent & wave, double time, glm::dvec2 origin ) noexcept;
+
+// Per wave phase of the sum of waves, accumulated on a double precision clock and wrapped to [ 0, 2 pi ) so the
+// shader only adds a small float to dot( k, pos ), however long the program has been running
+// Phases advance by omega * dt, so changing the speed or the spectrum does not make the waves jump
+// k . origin is added to the phases handed out, the shader then works in coordinates relative to the floating origin
+// and dot( k, pos ) stays as small as the distance to it
+class WavePhases
+{
+    public :
+        // Moves the clock to time in seconds. Waves added to the table since the last call start at omega * time
+        void advance( const std::vector< WaveComponent > & waves, double time, glm::dvec2 origin = glm::dvec2( 0.0 ) ) noexcept;
+        // Sets every phase back to omega * time, for instance when the clock itself jumps
+        void reset( const std::vector< WaveComponent > & waves, double time, glm::dvec2 origin = glm::dvec2( 0.0 ) ) noexcept;
+
+        // One float per wave of the table given to the last advance
+        const std::vector< float > & getPhases() const noexcept;
+        double getTime() const noexcept;
+
+    private :
+        std::vector< double > phases;
+        std::vector< float > floatPhases;
+        double time = 0.0;
+        bool started = false;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef WAVEQUERY_HPP
+#define WAVEQUERY_HPP
+
+#include <wavecpu.hpp>
+#include <wavespectrum.hpp>
+#include <threadpool.hpp>
+#include <glm/glm.hpp>
+#include <shared_mutex>
+#include <vector>
+
+enum QueryMode
+{
+    QUERY_EXACT, // the sum of waves evaluated at every point
+    QUERY_CACHED // bilinear lookup in a heightfield tile, exact outside of it
+};
+
+// Surface height and normal at arbitrary points for the gameplay side ( floating objects, buoyancy )
+// Cached queries read a tile of the surface around a center point, rebuilt lazily the first time it is
+// read at a new time, so all the callers of a simulation tick share one rebuild
+// Any number of threads can query at once, setWaves and setTileCenter may be called from any thread
+class WaveQuery
+{
+    public :
+        // resolution² cells covering a tileSize² square, the rebuild is split between threadCount threads
+        WaveQuery( int resolution = 128, float tileSize = 256.0f, unsigned int threadCount = std::thread::hardware_concurrency() );
+
+        WaveQuery( const WaveQuery & ) = delete;
+        WaveQuery & operator=( const WaveQuery & ) = delete;
+
+        // Copies the wave table when the spectrum version changed
+        void setWaves( const WaveSpectrum & spectrum );
+        // Moves the tile, the center is snapped to the cell grid so the cached surface does not swim
+        void setTileCenter( glm::vec2 center ) noexcept;
+
+        // Fills the heights and normals of the batch at the given time. The phases of the batch ( see SurfaceBatch )
+        // are for the wave table of the last setWaves, the tile is rebuilt with those of the first query of a time
+        void query( const SurfaceBatch & batch, double time, QueryMode mode );
+
+        int getResolution() const noexcept;
+        float getTileSize() const noexcept;
+        // Number of tile rebuilds since the construction
+        unsigned long getRebuildCount() const noexcept;
+
+    private :
+        int resolution;
+        float tileSize;
+        float cellSize;
+        ThreadPool pool;
+
+        mutable std::shared_mutex mutex;
+        std::vector< WaveComponent > waves;
+        unsigned long wavesVersion = 0;
+        glm::vec2 tileOrigin = glm::vec2( 0.0f );
+
+        // ( resolution + 1 )² samples of the tile and the state they were built for
+        std::vector< float > tileHeight;
+        std::vector< float > tileNormalX;
+        std::vector< float > tileNormalY;
+        std::vector< float > tileNormalZ;
+        bool tileValid = false;
+        double tileTime = 0.0;
+        unsigned long rebuildCount = 0;
+
+        void rebuildTile( double time, const SurfaceBatch & query ) noexcept;
+        void lookup( const SurfaceBatch & batch, double time ) const;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef WAVESPECTRUM_HPP
+#define WAVESPECTRUM_HPP
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#define MAX_WAVES 4096
+
+enum SpectrumType
+{
+    SPECTRUM_LEGACY, // the original sum of waves of water.vs
+    SPECTRUM_PHILLIPS,
+    SPECTRUM_JONSWAP,
+    SPECTRUM_PIERSON_MOSKOWITZ,
+    SPECTRUM_COUNT
+};
+
+// One wave of the table, laid out as a single RGBA32F texel of the GPU wave table
+// phase = omega * time + dot( k, pos.xz ), height = amplitude * exp( cos( phase ) - 1 )
+struct WaveComponent
+{
+    glm::vec2 k; // direction scaled by the angular wavenumber
+    float amplitude;
+    float omega; // angular frequency
+};
+
+struct SpectrumParameters
+{
+    SpectrumType type = SPECTRUM_LEGACY;
+    int waveCount = 16;
+
+    // Legacy sum of waves, same meaning as the uniforms water.vs used to read
+    float amplitude = 1.0f; // also the overall gain of the physical spectra
+    float frequency = 1.0f;
+    float speed = 1.0f; // also scales time for the physical spectra
+    float amplitudeDecay = 0.82f;
+    float frequencyIncrease = 1.18f;
+    float directionFactor = 0.5f;
+
+    // Physical spectra
+    float windSpeed = 10.0f; // m/s, 10 m above the sea
+    glm::vec2 windDirection = glm::vec2( 1.0f, 0.0f );
+    float fetch = 100000.0f; // m, JONSWAP only
+    float peakEnhancement = 3.3f; // JONSWAP gamma
+    float spreading = 10.0f; // exponent s of the cos^2s( theta / 2 ) directional spreading
+    float minWaveLength = 0.5f; // m, shortest wave of the table
+
+    bool operator==( const SpectrumParameters & other ) const noexcept;
+    bool operator!=( const SpectrumParameters & other ) const noexcept;
+};
+
+// Builds the per wave table ( direction, amplitude, frequency, phase speed ) once on the CPU
+// instead of every vertex deriving it again for every wave
+// Waves come by increasing wavenumber ( apart from the first legacy one ), which the shader LOD relies on
+class WaveSpectrum
+{
+    public :
+        WaveSpectrum() noexcept;
+
+        // Rebuilds the table only when the parameters changed, returns true when it did
+        bool setParameters( const SpectrumParameters & parameters ) noexcept;
+
+        const SpectrumParameters & getParameters() const noexcept;
+        const std::vector< WaveComponent > & getWaves() const noexcept;
+        // Incremented on every rebuild, consumers compare it to know when to refresh their copy
+        unsigned long getVersion() const noexcept;
+
+        static const char * getTypeName( SpectrumType type ) noexcept;
+
+    private :
+        SpectrumParameters parameters;
+        std::vector< WaveComponent > waves;
+        unsigned long version = 0;
+
+        void buildLegacy() noexcept;
+        void buildPhysical() noexcept;
+        // One sided spectral density S( omega ) in m²·s
+        float density( float omega ) const noexcept;
+        float peakFrequency() const noexcept;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef WAVETABLE_HPP
+#define WAVETABLE_HPP
+
+#include <wavespectrum.hpp>
+
+// GPU copy of the WaveSpectrum table in a buffer texture, one RGBA32F texel per wave ( k.x, k.y, amplitude, omega )
+// The buffer is only uploaded again when the spectrum was rebuilt. The per wave phases, which change every
+// frame, live in a second R32F buffer texture
+class WaveTable
+{
+    public :
+        WaveTable() noexcept;
+        ~WaveTable();
+
+        WaveTable( const WaveTable & ) = delete;
+        WaveTable & operator=( const WaveTable & ) = delete;
+
+        // Returns true when the table was uploaded
+        bool update( const WaveSpectrum & spectrum ) noexcept;
+        // Streams one phase per wave, see WavePhases
+        void updatePhases( const std::vector< float > & phases ) noexcept;
+        void bind( unsigned int unit ) const noexcept;
+        void bindPhases( unsigned int unit ) const noexcept;
+
+        int getWaveCount() const noexcept;
+
+    private :
+        unsigned int buffer;
+        unsigned int texture;
+        unsigned int phaseBuffer;
+        unsigned int phaseTexture;
+        unsigned long version = 0;
+        int waveCount = 0;
+};
+
+#endif
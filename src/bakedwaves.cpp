@@ -0,0 +1,196 @@
+#include <bakedwaves.hpp>
+#include <wavecpu.hpp>
+#include <glad/glad.h>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+#include <stdexcept>
+#include <chrono>
+#include <cmath>
+
+// Seconds the spectrum has to stay unchanged before a bake starts, so holding a key does not start one per frame
+#define BAKE_SETTLE_DELAY 0.5f
+
+BakedWaves::BakedWaves( int resolution, int frameCount, float tileSize, float period, unsigned int threadCount ) :
+    resolution( resolution ), frameCount( frameCount ), tileSize( tileSize ), period( period ), pool( threadCount ),
+    cancel( false ), done( false ), framesDone( 0 ), bakeTime( 0.0f )
+{
+    if( resolution < 2 || frameCount < 2 || tileSize <= 0.0f || period <= 0.0f )
+    {
+        throw std::runtime_error( "Baked waves need at least 2 texels, 2 frames, a positive tile size and period" );
+    }
+
+    glGenTextures( 1, &texture );
+    glBindTexture( GL_TEXTURE_3D, texture );
+    glTexImage3D( GL_TEXTURE_3D, 0, GL_RGBA16F, resolution, resolution, frameCount, 0, GL_RGBA, GL_HALF_FLOAT, nullptr );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT );
+    glBindTexture( GL_TEXTURE_3D, 0 );
+}
+
+BakedWaves::~BakedWaves()
+{
+    stopWorker();
+    glDeleteTextures( 1, &texture );
+}
+
+void BakedWaves::update( const WaveSpectrum & spectrum, double now )
+{
+    if( spectrum.getVersion() != targetVersion )
+    {
+        targetVersion = spectrum.getVersion();
+        changeTime = now;
+        // The running bake is outdated, the live path takes over until the next one finishes
+        if( worker.joinable() && bakingVersion != targetVersion )
+            stopWorker();
+    }
+
+    if( worker.joinable() && done )
+    {
+        worker.join();
+        glBindTexture( GL_TEXTURE_3D, texture );
+        glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+        glTexSubImage3D( GL_TEXTURE_3D, 0, 0, 0, 0, resolution, resolution, frameCount, GL_RGBA, GL_HALF_FLOAT, pixels.data() );
+        glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+        glBindTexture( GL_TEXTURE_3D, 0 );
+        std::vector< unsigned short >().swap( pixels );
+        readyVersion = bakingVersion;
+    }
+
+    if( !worker.joinable() && readyVersion != targetVersion && now - changeTime >= BAKE_SETTLE_DELAY )
+    {
+        const float maxWavenumber = glm::pi< float >() / ( 2.0f * tileSize / resolution );
+        bakingVersion = targetVersion;
+        cancel = false;
+        done = false;
+        framesDone = 0;
+        worker = std::thread( &BakedWaves::bake, this, makePeriodic( spectrum.getWaves(), tileSize, period, maxWavenumber ) );
+    }
+}
+
+void BakedWaves::bind( unsigned int unit ) const noexcept
+{
+    glActiveTexture( GL_TEXTURE0 + unit );
+    glBindTexture( GL_TEXTURE_3D, texture );
+    glActiveTexture( GL_TEXTURE0 );
+}
+
+bool BakedWaves::isReady() const noexcept
+{
+    return readyVersion != 0 && readyVersion == targetVersion;
+}
+
+bool BakedWaves::isBaking() const noexcept
+{
+    return worker.joinable();
+}
+
+float BakedWaves::getProgress() const noexcept
+{
+    return static_cast< float >( framesDone ) / frameCount;
+}
+
+float BakedWaves::getCycle( double time ) const noexcept
+{
+    double cycle = time / period;
+    return static_cast< float >( cycle - std::floor( cycle ) );
+}
+
+float BakedWaves::getTileSize() const noexcept
+{
+    return tileSize;
+}
+
+float BakedWaves::getPeriod() const noexcept
+{
+    return period;
+}
+
+size_t BakedWaves::getMemorySize() const noexcept
+{
+    return static_cast< size_t >( resolution ) * resolution * frameCount * 4 * sizeof( unsigned short );
+}
+
+float BakedWaves::getBakeTime() const noexcept
+{
+    return bakeTime;
+}
+
+std::vector< WaveComponent > BakedWaves::makePeriodic( const std::vector< WaveComponent > & waves, float tileSize, float period, float maxWavenumber )
+{
+    const float kStep = glm::two_pi< float >() / tileSize;
+    const float omegaStep = glm::two_pi< float >() / period;
+    std::vector< WaveComponent > periodic;
+    periodic.reserve( waves.size() );
+    for( const WaveComponent & wave : waves )
+    {
+        if( glm::length( wave.k ) > maxWavenumber )
+            continue;
+        glm::vec2 k = glm::round( wave.k / kStep );
+        // Waves longer than the tile keep one period along their main axis instead of becoming a flat bobbing
+        if( k == glm::vec2( 0.0f ) )
+        {
+            if( std::abs( wave.k.x ) >= std::abs( wave.k.y ) )
+                k.x = wave.k.x < 0.0f ? -1.0f : 1.0f;
+            else
+                k.y = wave.k.y < 0.0f ? -1.0f : 1.0f;
+        }
+        periodic.push_back( { k * kStep, wave.amplitude, std::round( wave.omega / omegaStep ) * omegaStep } );
+    }
+    return periodic;
+}
+
+void BakedWaves::bake( std::vector< WaveComponent > waves ) noexcept
+{
+    auto start = std::chrono::steady_clock::now();
+    const int N = resolution;
+    const size_t texels = static_cast< size_t >( N ) * N;
+    const float cellSize = tileSize / N;
+
+    std::vector< float > x( texels ), z( texels ), height( texels ), normalX( texels ), normalY( texels ), normalZ( texels );
+    // Samples sit at the texel centers so the shaders can fetch at pos.xz / tileSize and time / period directly
+    for( size_t i = 0; i < texels; i++ )
+    {
+        x[i] = ( i % N + 0.5f ) * cellSize;
+        z[i] = ( i / N + 0.5f ) * cellSize;
+    }
+    pixels.assign( texels * frameCount * 4, 0 );
+
+    for( int frame = 0; frame < frameCount; frame++ )
+    {
+        if( cancel )
+            return;
+        const float time = ( frame + 0.5f ) * period / frameCount;
+        unsigned short * slice = &pixels[ frame * texels * 4 ];
+        pool.parallelFor( N, [ & ]( int begin, int end )
+        {
+            const size_t first = static_cast< size_t >( begin ) * N;
+            const int count = ( end - begin ) * N;
+            SurfaceBatch batch = { &x[ first ], &z[ first ], &height[ first ], &normalX[ first ], &normalY[ first ], &normalZ[ first ], count };
+            evaluateWaves( waves.data(), static_cast< int >( waves.size() ), time, batch );
+            for( size_t i = first; i < first + count; i++ )
+            {
+                slice[ i * 4 + 0 ] = glm::packHalf1x16( normalX[i] );
+                slice[ i * 4 + 1 ] = glm::packHalf1x16( normalY[i] );
+                slice[ i * 4 + 2 ] = glm::packHalf1x16( normalZ[i] );
+                slice[ i * 4 + 3 ] = glm::packHalf1x16( height[i] );
+            }
+        } );
+        framesDone++;
+    }
+
+    std::chrono::duration< float > elapsed = std::chrono::steady_clock::now() - start;
+    bakeTime = elapsed.count();
+    done = true;
+}
+
+void BakedWaves::stopWorker() noexcept
+{
+    if( !worker.joinable() )
+        return;
+    cancel = true;
+    worker.join();
+    std::vector< unsigned short >().swap( pixels );
+}
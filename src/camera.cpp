@@ -1,6 +1,7 @@
 #include <camera.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <cmath>
 
 Camera::Camera( glm::vec3 position, glm::vec3 up, float yaw, float pitch, float fov, float sensitivity, float moveSpeed ) noexcept :
     position( position ), upWorld( up ), yaw( yaw ), pitch( pitch ), fov( fov ), sensitivity( sensitivity ), moveSpeed( moveSpeed )
@@ -11,19 +12,41 @@ Camera::Camera( glm::vec3 position, glm::vec3 up, float yaw, float pitch, float
 void Camera::onKeyboard( CameraMovement direction, float deltaTime ) noexcept
 {
     float velocity = moveSpeed * deltaTime;
+    glm::vec3 offset = glm::vec3( 0.0f );
     switch( direction )
     {
-        case FORWARD : position += glm::cross( upWorld, right ) * velocity; break;
-        case FORWARD_RIGHT : position += glm::normalize( glm::cross( upWorld, right ) + right ) * velocity; break;
-        case RIGHT : position += right * velocity; break;
-        case BACKWARD_RIGHT : position += glm::normalize( -glm::cross( upWorld, right ) + right ) * velocity; break;
-        case BACKWARD : position -= glm::cross( upWorld, right ) * velocity; break;
-        case BACKWARD_LEFT : position -= glm::normalize( glm::cross( upWorld, right ) + right ) * velocity; break;
-        case LEFT : position -= right * velocity; break;
-        case FORWARD_LEFT : position -= glm::normalize( -glm::cross( upWorld, right ) + right ) * velocity; break;
-        case UP : position += upWorld * velocity; break;
-        case DOWN : position -= upWorld * velocity; break;
+        case FORWARD : offset = glm::cross( upWorld, right ) * velocity; break;
+        case FORWARD_RIGHT : offset = glm::normalize( glm::cross( upWorld, right ) + right ) * velocity; break;
+        case RIGHT : offset = right * velocity; break;
+        case BACKWARD_RIGHT : offset = glm::normalize( -glm::cross( upWorld, right ) + right ) * velocity; break;
+        case BACKWARD : offset = -glm::cross( upWorld, right ) * velocity; break;
+        case BACKWARD_LEFT : offset = -glm::normalize( glm::cross( upWorld, right ) + right ) * velocity; break;
+        case LEFT : offset = -right * velocity; break;
+        case FORWARD_LEFT : offset = -glm::normalize( -glm::cross( upWorld, right ) + right ) * velocity; break;
+        case UP : offset = upWorld * velocity; break;
+        case DOWN : offset = -upWorld * velocity; break;
+        default : break;
     }
+    position += glm::dvec3( offset );
+}
+
+bool Camera::rebase( double step ) noexcept
+{
+    const glm::dvec2 local = glm::dvec2( position.x, position.z ) - origin;
+    if( step <= 0.0 || ( std::abs( local.x ) <= step && std::abs( local.y ) <= step ) )
+        return false;
+    origin = glm::round( glm::dvec2( position.x, position.z ) / step ) * step;
+    return true;
+}
+
+void Camera::setOrigin( glm::dvec2 origin ) noexcept
+{
+    this->origin = origin;
+}
+
+void Camera::translate( glm::dvec3 offset ) noexcept
+{
+    position += offset;
 }
 
 void Camera::onMouseMove( float xOffset, float yOffset, bool constrainPitch ) noexcept
@@ -65,7 +88,8 @@ void Camera::updateCamera() noexcept
 
 glm::mat4 Camera::getViewMat() const noexcept
 {
-    return glm::lookAt( position, position + front, up );
+    const glm::vec3 local = getPosition();
+    return glm::lookAt( local, local + front, up );
 }
 
 float Camera::getFov() const noexcept
@@ -114,6 +138,16 @@ glm::vec3 Camera::getUp() const noexcept
 }
 
 glm::vec3 Camera::getPosition() const noexcept
+{
+    return glm::vec3( position - glm::dvec3( origin.x, 0.0, origin.y ) );
+}
+
+glm::dvec3 Camera::getWorldPosition() const noexcept
 {
     return position;
+}
+
+glm::dvec2 Camera::getOrigin() const noexcept
+{
+    return origin;
 }
\ No newline at end of file
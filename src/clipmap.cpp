@@ -0,0 +1,270 @@
+#include <clipmap.hpp>
+#include <mesh.hpp>
+#include <glad/glad.h>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Attribute the water program reads the instance from, after those of Mesh
+    const unsigned int INSTANCE_ATTRIBUTE = 7;
+
+    // Adds the triangle facing up, the order of Mesh::grid
+    void addTriangle( std::vector< unsigned short > & indices, int side, int a, int b, int c ) noexcept
+    {
+        const int ax = a % side, az = a / side;
+        const int cross = ( b / side - az ) * ( c % side - ax ) - ( b % side - ax ) * ( c / side - az );
+        if( cross < 0 )
+            std::swap( b, c );
+        indices.insert( indices.end(), { static_cast< unsigned short >( a ), static_cast< unsigned short >( b ), static_cast< unsigned short >( c ) } );
+    }
+}
+
+Clipmap::Clipmap( int levels, int ringCells, float cellSize ) :
+    levels( levels ), ringCells( std::max( ( ringCells + 1 ) / 2 * 2, 8 ) ), cellSize( cellSize ), placed( std::max( levels, 0 ) )
+{
+    side = 2 * this->ringCells + 1;
+    if( levels < 1 || cellSize <= 0.0f || side * side > 65536 )
+    {
+        throw std::runtime_error( "Clipmap needs at least one level and at most 126 cells per ring" );
+    }
+
+    // Vertices in cells of the level, ( i, 0, j )
+    std::vector< glm::vec3 > vertices( static_cast< size_t >( side ) * side );
+    for( int j = 0; j < side; j++ )
+        for( int i = 0; i < side; i++ )
+            vertices[ j * side + i ] = glm::vec3( i, 0.0f, j );
+
+    std::vector< unsigned short > indices;
+    for( int layout = 0; layout < LAYOUT_COUNT; layout++ )
+    {
+        layoutFirst[ layout ] = static_cast< unsigned int >( indices.size() );
+        buildLayout( layout, indices );
+        layoutCount[ layout ] = static_cast< unsigned int >( indices.size() ) - layoutFirst[ layout ];
+        std::vector< bool > used( vertices.size(), false );
+        for( unsigned int i = layoutFirst[ layout ]; i < indices.size(); i++ )
+            used[ indices[i] ] = true;
+        layoutVertices[ layout ] = static_cast< unsigned int >( std::count( used.begin(), used.end(), true ) );
+    }
+
+    glGenVertexArrays( 1, &vao );
+    glGenBuffers( 1, &vbo );
+    glGenBuffers( 1, &ebo );
+    glGenBuffers( 1, &instanceBuffer );
+    glBindVertexArray( vao );
+    glBindBuffer( GL_ARRAY_BUFFER, vbo );
+    glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof( glm::vec3 ), vertices.data(), GL_STATIC_DRAW );
+    glEnableVertexAttribArray( 0 );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, sizeof( glm::vec3 ), (void*)0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebo );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof( unsigned short ), indices.data(), GL_STATIC_DRAW );
+    glBindBuffer( GL_ARRAY_BUFFER, instanceBuffer );
+    glBufferData( GL_ARRAY_BUFFER, placed.size() * sizeof( glm::vec3 ), nullptr, GL_DYNAMIC_DRAW );
+    glEnableVertexAttribArray( INSTANCE_ATTRIBUTE );
+    glVertexAttribDivisor( INSTANCE_ATTRIBUTE, 1 );
+
+    // Captured vertices, level after level in the order of the instances
+    glGenBuffers( 1, &feedbackBuffer );
+    glGenVertexArrays( 1, &capturedVao );
+    glBindVertexArray( capturedVao );
+    glBindBuffer( GL_ARRAY_BUFFER, feedbackBuffer );
+    glBufferData( GL_ARRAY_BUFFER, vertices.size() * placed.size() * sizeof( CapturedVertex ), nullptr, GL_DYNAMIC_COPY );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebo );
+    glEnableVertexAttribArray( 0 );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)0 );
+    glEnableVertexAttribArray( 1 );
+    glVertexAttribPointer( 1, 3, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)offsetof( CapturedVertex, normal ) );
+    glEnableVertexAttribArray( 2 );
+    glVertexAttribPointer( 2, 2, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)offsetof( CapturedVertex, uv ) );
+    glBindVertexArray( 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+    update( glm::vec3( 0.0f ) );
+}
+
+Clipmap::~Clipmap()
+{
+    glDeleteVertexArrays( 1, &capturedVao );
+    glDeleteBuffers( 1, &feedbackBuffer );
+    glDeleteBuffers( 1, &instanceBuffer );
+    glDeleteBuffers( 1, &ebo );
+    glDeleteBuffers( 1, &vbo );
+    glDeleteVertexArrays( 1, &vao );
+}
+
+void Clipmap::buildLayout( int layout, std::vector< unsigned short > & indices ) noexcept
+{
+    const int n = ringCells;
+    const int last = 2 * n;
+    // Hole of the rings in cells, from holeX to holeX + n along x and the same along z
+    const bool ring = layout > 0;
+    const int holeX = n / 2 + ( ( layout - 1 ) & 1 );
+    const int holeZ = n / 2 + ( ( layout - 1 ) >> 1 );
+    auto vertex = [ & ]( int i, int j ) { return j * side + i; };
+
+    // Cells off the edge rows, two triangles each
+    for( int j = 1; j < last - 1; j++ )
+    {
+        for( int i = 1; i < last - 1; i++ )
+        {
+            if( ring && i >= holeX && i < holeX + n && j >= holeZ && j < holeZ + n )
+                continue;
+            addTriangle( indices, side, vertex( i, j ), vertex( i, j + 1 ), vertex( i + 1, j ) );
+            addTriangle( indices, side, vertex( i + 1, j ), vertex( i, j + 1 ), vertex( i + 1, j + 1 ) );
+        }
+    }
+    // Edge rows : every other vertex of the edge, fanned to the row inside. Along each side, edge( k, 0 ) is the kth
+    // vertex of the edge and edge( k, 1 ) the one facing it on the row inside
+    for( int sideIndex = 0; sideIndex < 4; sideIndex++ )
+    {
+        auto edge = [ & ]( int k, int depth )
+        {
+            switch( sideIndex )
+            {
+                case 0 : return vertex( k, depth );
+                case 1 : return vertex( k, last - depth );
+                case 2 : return vertex( depth, k );
+                default : return vertex( last - depth, k );
+            }
+        };
+        for( int k = 0; k < last; k += 2 )
+        {
+            addTriangle( indices, side, edge( k, 0 ), edge( k + 2, 0 ), edge( k + 1, 1 ) );
+            if( k > 0 )
+                addTriangle( indices, side, edge( k, 0 ), edge( k + 1, 1 ), edge( k, 1 ) );
+            if( k + 2 < last )
+                addTriangle( indices, side, edge( k + 2, 0 ), edge( k + 2, 1 ), edge( k + 1, 1 ) );
+        }
+    }
+}
+
+int Clipmap::levelsFor( float distance, int ringCells, float cellSize ) noexcept
+{
+    // A level drifts up to about two of its cells off the camera
+    int levels = 1;
+    while( ( ringCells - 2 ) * cellSize * std::ldexp( 1.0f, levels - 1 ) < distance && levels < 24 )
+        levels++;
+    return levels;
+}
+
+void Clipmap::update( glm::vec3 cameraPosition ) noexcept
+{
+    // First corner of each level, a multiple of twice its cell size, with the level inside n / 2 or n / 2 + 1
+    // cells away from it. Doubles keep the snapping exact far from the origin
+    std::vector< glm::dvec2 > corners( levels );
+    glm::dvec2 corner;
+    for( int level = 0; level < levels; level++ )
+    {
+        const double cell = static_cast< double >( cellSize ) * std::ldexp( 1.0, level );
+        const glm::dvec2 target = level == 0 ? glm::dvec2( cameraPosition.x, cameraPosition.z ) - ringCells * cell
+                                             : corner - ringCells / 2 * cell;
+        corner = glm::floor( target / ( 2.0 * cell ) ) * ( 2.0 * cell );
+        corners[ level ] = corner;
+    }
+
+    std::fill( layoutInstances, layoutInstances + LAYOUT_COUNT, 0 );
+    std::vector< Level > levelsPlaced( levels );
+    for( int level = 0; level < levels; level++ )
+    {
+        const double cell = static_cast< double >( cellSize ) * std::ldexp( 1.0, level );
+        int layout = 0;
+        if( level > 0 )
+        {
+            const glm::dvec2 hole = ( corners[ level - 1 ] - corners[ level ] ) / cell - static_cast< double >( ringCells / 2 );
+            layout = 1 + static_cast< int >( hole.x ) + 2 * static_cast< int >( hole.y );
+        }
+        levelsPlaced[ level ] = { glm::vec3( corners[ level ].x, corners[ level ].y, static_cast< float >( cell ) ), layout };
+        layoutInstances[ layout ]++;
+    }
+    // Grouped by layout so that each layout is one range of instances
+    int first = 0;
+    for( int layout = 0; layout < LAYOUT_COUNT; layout++ )
+    {
+        layoutBase[ layout ] = first;
+        first += layoutInstances[ layout ];
+    }
+    int next[ LAYOUT_COUNT ];
+    std::copy( layoutBase, layoutBase + LAYOUT_COUNT, next );
+    for( const Level & level : levelsPlaced )
+        placed[ next[ level.layout ]++ ] = level;
+
+    std::vector< glm::vec3 > instances( placed.size() );
+    for( size_t i = 0; i < placed.size(); i++ )
+        instances[i] = placed[i].instance;
+    glBindBuffer( GL_ARRAY_BUFFER, instanceBuffer );
+    glBufferSubData( GL_ARRAY_BUFFER, 0, instances.size() * sizeof( glm::vec3 ), instances.data() );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+void Clipmap::draw() const noexcept
+{
+    glBindVertexArray( vao );
+    glBindBuffer( GL_ARRAY_BUFFER, instanceBuffer );
+    for( int layout = 0; layout < LAYOUT_COUNT; layout++ )
+    {
+        if( layoutInstances[ layout ] == 0 )
+            continue;
+        // Without base instances in 3.3 the attribute is moved to the first instance of the layout
+        glVertexAttribPointer( INSTANCE_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof( glm::vec3 ), (void*)( layoutBase[ layout ] * sizeof( glm::vec3 ) ) );
+        glDrawElementsInstanced( GL_TRIANGLES, layoutCount[ layout ], GL_UNSIGNED_SHORT, (void*)( layoutFirst[ layout ] * sizeof( unsigned short ) ), layoutInstances[ layout ] );
+    }
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindVertexArray( 0 );
+}
+
+void Clipmap::capture() const noexcept
+{
+    // The vertices in the holes are captured as well, simpler than one range of points per layout
+    glEnable( GL_RASTERIZER_DISCARD );
+    glBindVertexArray( vao );
+    glBindBuffer( GL_ARRAY_BUFFER, instanceBuffer );
+    glVertexAttribPointer( INSTANCE_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof( glm::vec3 ), (void*)0 );
+    glBindBufferBase( GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedbackBuffer );
+    glBeginTransformFeedback( GL_POINTS );
+    glDrawArraysInstanced( GL_POINTS, 0, side * side, levels );
+    glEndTransformFeedback();
+    glBindBufferBase( GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindVertexArray( 0 );
+    glDisable( GL_RASTERIZER_DISCARD );
+}
+
+void Clipmap::drawCaptured() const noexcept
+{
+    glBindVertexArray( capturedVao );
+    for( int i = 0; i < levels; i++ )
+    {
+        const int layout = placed[i].layout;
+        glDrawElementsBaseVertex( GL_TRIANGLES, layoutCount[ layout ], GL_UNSIGNED_SHORT, (void*)( layoutFirst[ layout ] * sizeof( unsigned short ) ), i * side * side );
+    }
+    glBindVertexArray( 0 );
+}
+
+int Clipmap::getLevelCount() const noexcept
+{
+    return levels;
+}
+
+unsigned int Clipmap::getLevelVertexCount( int level ) const noexcept
+{
+    return layoutVertices[ level == 0 ? 0 : 1 ];
+}
+
+unsigned int Clipmap::getVertexCount() const noexcept
+{
+    unsigned int count = 0;
+    for( int level = 0; level < levels; level++ )
+        count += getLevelVertexCount( level );
+    return count;
+}
+
+float Clipmap::getCellSize() const noexcept
+{
+    return cellSize;
+}
+
+float Clipmap::getExtent() const noexcept
+{
+    return 2.0f * ringCells * cellSize * std::ldexp( 1.0f, levels - 1 );
+}
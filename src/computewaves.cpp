@@ -0,0 +1,106 @@
+#include <computewaves.hpp>
+#include <glad/glad.h>
+#include <glm/gtc/constants.hpp>
+#include <stdexcept>
+#include <string>
+#include <cmath>
+
+// Entry points and constants of GL 4.3 missing from the 3.3 glad
+typedef void ( APIENTRYP DispatchComputeProc )( GLuint groupsX, GLuint groupsY, GLuint groupsZ );
+typedef void ( APIENTRYP BindImageTextureProc )( GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format );
+typedef void ( APIENTRYP MemoryBarrierProc )( GLbitfield barriers );
+#define WAVE_MAPS_WRITE_ONLY 0x88B9
+#define WAVE_MAPS_FETCH_BARRIER 0x00000008
+
+// Must match GROUP_SIZE in wave_maps.cs
+#define WAVE_MAPS_GROUP_SIZE 16
+
+ComputeWaves::ComputeWaves( void * ( *loader )( const char * ), int resolution, float size ) :
+    resolution( resolution ), size( size )
+{
+    if( resolution < WAVE_MAPS_GROUP_SIZE || resolution % WAVE_MAPS_GROUP_SIZE != 0 || size <= 0.0f )
+    {
+        throw std::runtime_error( "Compute waves need a resolution multiple of 16 and a positive size" );
+    }
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv( GL_MAJOR_VERSION, &major );
+    glGetIntegerv( GL_MINOR_VERSION, &minor );
+    if( major * 10 + minor < 43 )
+    {
+        throw std::runtime_error( "Compute waves need OpenGL 4.3, the context is " + std::to_string( major ) + "." + std::to_string( minor ) );
+    }
+    dispatchCompute = loader( "glDispatchCompute" );
+    bindImageTexture = loader( "glBindImageTexture" );
+    memoryBarrier = loader( "glMemoryBarrier" );
+    if( !dispatchCompute || !bindImageTexture || !memoryBarrier )
+    {
+        throw std::runtime_error( "Compute waves could not load the GL 4.3 functions" );
+    }
+
+    shader = std::make_unique< Shader >( "../include/shader/wave_maps.cs" );
+
+    glGenTextures( 2, textures );
+    for( int i = 0; i < 2; i++ )
+    {
+        glBindTexture( GL_TEXTURE_2D, textures[i] );
+        glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA32F, resolution, resolution, 0, GL_RGBA, GL_FLOAT, nullptr );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    }
+    glBindTexture( GL_TEXTURE_2D, 0 );
+}
+
+ComputeWaves::~ComputeWaves()
+{
+    glDeleteTextures( 2, textures );
+}
+
+void ComputeWaves::update( int waveCount, unsigned int tableUnit, unsigned int phasesUnit, glm::vec2 center ) noexcept
+{
+    // Snapped to the texels so the sampled surface does not swim while the camera moves
+    const float texelSize = size / resolution;
+    origin = glm::floor( center / texelSize ) * texelSize - glm::vec2( size * 0.5f );
+
+    shader->activate();
+    shader->setInt( "numWaves", waveCount );
+    shader->setInt( "waveTable", tableUnit );
+    shader->setInt( "wavePhases", phasesUnit );
+    shader->setVec2( "origin", origin );
+    shader->setFloat( "texelSize", texelSize );
+    // Waves shorter than two texels cannot be stored in the maps
+    shader->setFloat( "maxWavenumber", glm::pi< float >() / texelSize );
+
+    reinterpret_cast< BindImageTextureProc >( bindImageTexture )( 0, textures[0], 0, GL_FALSE, 0, WAVE_MAPS_WRITE_ONLY, GL_RGBA32F );
+    reinterpret_cast< BindImageTextureProc >( bindImageTexture )( 1, textures[1], 0, GL_FALSE, 0, WAVE_MAPS_WRITE_ONLY, GL_RGBA32F );
+    const GLuint groups = resolution / WAVE_MAPS_GROUP_SIZE;
+    reinterpret_cast< DispatchComputeProc >( dispatchCompute )( groups, groups, 1 );
+    // The vertex stage reads the maps through samplers
+    reinterpret_cast< MemoryBarrierProc >( memoryBarrier )( WAVE_MAPS_FETCH_BARRIER );
+}
+
+void ComputeWaves::bindMaps( unsigned int displacementUnit, unsigned int normalUnit ) const noexcept
+{
+    glActiveTexture( GL_TEXTURE0 + displacementUnit );
+    glBindTexture( GL_TEXTURE_2D, textures[0] );
+    glActiveTexture( GL_TEXTURE0 + normalUnit );
+    glBindTexture( GL_TEXTURE_2D, textures[1] );
+    glActiveTexture( GL_TEXTURE0 );
+}
+
+glm::vec2 ComputeWaves::getOrigin() const noexcept
+{
+    return origin;
+}
+
+float ComputeWaves::getSize() const noexcept
+{
+    return size;
+}
+
+int ComputeWaves::getResolution() const noexcept
+{
+    return resolution;
+}
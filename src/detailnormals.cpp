@@ -0,0 +1,113 @@
+#include <detailnormals.hpp>
+#include <glad/glad.h>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+DetailNormals::DetailNormals( int resolution, float tileSize ) : resolution( resolution ), tileSize( tileSize )
+{
+    if( resolution < 1 || tileSize <= 0.0f )
+    {
+        throw std::runtime_error( "Detail normals need at least one texel and a positive tile size" );
+    }
+
+    glGenVertexArrays( 1, &quadVAO );
+    glGenTextures( 1, &texture );
+    glBindTexture( GL_TEXTURE_2D, texture );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_RG16F, resolution, resolution, 0, GL_RG, GL_FLOAT, nullptr );
+    glGenerateMipmap( GL_TEXTURE_2D );
+    // Far away the mipmaps average the ripples out instead of aliasing them
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+
+    glGenFramebuffers( 1, &framebuffer );
+    glBindFramebuffer( GL_FRAMEBUFFER, framebuffer );
+    glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0 );
+    const bool complete = glCheckFramebufferStatus( GL_FRAMEBUFFER ) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+    if( !complete )
+    {
+        throw std::runtime_error( "Detail normals framebuffer is incomplete" );
+    }
+}
+
+DetailNormals::~DetailNormals()
+{
+    glDeleteFramebuffers( 1, &framebuffer );
+    glDeleteTextures( 1, &texture );
+    glDeleteVertexArrays( 1, &quadVAO );
+}
+
+int DetailNormals::firstDetailWave( const std::vector< WaveComponent > & waves, int waveCount, float meshSpacing, float cellsPerWave ) const noexcept
+{
+    waveCount = std::min( waveCount, static_cast< int >( waves.size() ) );
+    const float cutoff = std::min( cellsPerWave * meshSpacing, tileSize * 0.25f );
+    for( int i = 1; i < waveCount; i++ )
+    {
+        const float wavelength = 6.2831853f / std::max( glm::length( waves[i].k ), 1e-6f );
+        if( wavelength < cutoff )
+            return i;
+    }
+    return waveCount;
+}
+
+void DetailNormals::update( int firstWave, int lastWave, unsigned int tableUnit, unsigned int phasesUnit, glm::vec2 origin ) noexcept
+{
+    // Save the state touched by the pass
+    int viewport[ 4 ];
+    glGetIntegerv( GL_VIEWPORT, viewport );
+    bool depthTest = glIsEnabled( GL_DEPTH_TEST );
+    bool blend = glIsEnabled( GL_BLEND );
+    bool cullFace = glIsEnabled( GL_CULL_FACE );
+    glDisable( GL_DEPTH_TEST );
+    glDisable( GL_BLEND );
+    glDisable( GL_CULL_FACE );
+    glViewport( 0, 0, resolution, resolution );
+    glBindVertexArray( quadVAO );
+    glBindFramebuffer( GL_FRAMEBUFFER, framebuffer );
+
+    shader.activate();
+    shader.setInt( "waveTable", tableUnit );
+    shader.setInt( "wavePhases", phasesUnit );
+    shader.setInt( "firstWave", firstWave );
+    shader.setInt( "lastWave", lastWave );
+    shader.setInt( "resolution", resolution );
+    shader.setFloat( "tileSize", tileSize );
+    shader.setVec2( "origin", origin );
+    glDrawArrays( GL_TRIANGLES, 0, 3 );
+
+    glBindTexture( GL_TEXTURE_2D, texture );
+    glGenerateMipmap( GL_TEXTURE_2D );
+
+    // Restore the state
+    glBindTexture( GL_TEXTURE_2D, 0 );
+    glBindVertexArray( 0 );
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    glViewport( viewport[0], viewport[1], viewport[2], viewport[3] );
+    if( depthTest )
+        glEnable( GL_DEPTH_TEST );
+    if( blend )
+        glEnable( GL_BLEND );
+    if( cullFace )
+        glEnable( GL_CULL_FACE );
+}
+
+void DetailNormals::bind( unsigned int unit ) const noexcept
+{
+    glActiveTexture( GL_TEXTURE0 + unit );
+    glBindTexture( GL_TEXTURE_2D, texture );
+    glActiveTexture( GL_TEXTURE0 );
+}
+
+float DetailNormals::getTileSize() const noexcept
+{
+    return tileSize;
+}
+
+int DetailNormals::getResolution() const noexcept
+{
+    return resolution;
+}
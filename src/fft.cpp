@@ -0,0 +1,212 @@
+#include <fft.hpp>
+#include <simd.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    // Lane operations for the SIMD body and the scalar tail of the butterfly loops
+    struct VectorOps
+    {
+        typedef vfloat T;
+        static const int width = SIMD_WIDTH;
+        static T load( const float * p ) noexcept { return vload( p ); }
+        static void store( float * p, T a ) noexcept { vstore( p, a ); }
+        static T set1( float a ) noexcept { return vset1( a ); }
+        static T add( T a, T b ) noexcept { return vadd( a, b ); }
+        static T sub( T a, T b ) noexcept { return vsub( a, b ); }
+        static T mul( T a, T b ) noexcept { return vmul( a, b ); }
+        static T fmadd( T a, T b, T c ) noexcept { return vfmadd( a, b, c ); }
+        static T fnmadd( T a, T b, T c ) noexcept { return vfnmadd( a, b, c ); }
+    };
+
+    struct ScalarOps
+    {
+        typedef float T;
+        static const int width = 1;
+        static T load( const float * p ) noexcept { return *p; }
+        static void store( float * p, T a ) noexcept { *p = a; }
+        static T set1( float a ) noexcept { return a; }
+        static T add( T a, T b ) noexcept { return a + b; }
+        static T sub( T a, T b ) noexcept { return a - b; }
+        static T mul( T a, T b ) noexcept { return a * b; }
+        static T fmadd( T a, T b, T c ) noexcept { return a * b + c; }
+        static T fnmadd( T a, T b, T c ) noexcept { return c - a * b; }
+    };
+
+    template< class O >
+    inline void twiddle( typename O::T & re, typename O::T & im, typename O::T wr, typename O::T wi ) noexcept
+    {
+        typename O::T r = O::fnmadd( im, wi, O::mul( re, wr ) );
+        im = O::fmadd( re, wi, O::mul( im, wr ) );
+        re = r;
+    }
+
+    // Radix-2 butterflies on lanes [ x, width ), returns where it stopped
+    template< class O >
+    int radix2( int x, int width, const float * inRe[ 2 ], const float * inIm[ 2 ], float * outRe[ 2 ], float * outIm[ 2 ], float wr, float wi ) noexcept
+    {
+        typename O::T vwr = O::set1( wr );
+        typename O::T vwi = O::set1( wi );
+        for( ; x + O::width <= width; x += O::width )
+        {
+            typename O::T aRe = O::load( inRe[0] + x ), aIm = O::load( inIm[0] + x );
+            typename O::T bRe = O::load( inRe[1] + x ), bIm = O::load( inIm[1] + x );
+            twiddle< O >( bRe, bIm, vwr, vwi );
+            O::store( outRe[0] + x, O::add( aRe, bRe ) );
+            O::store( outIm[0] + x, O::add( aIm, bIm ) );
+            O::store( outRe[1] + x, O::sub( aRe, bRe ) );
+            O::store( outIm[1] + x, O::sub( aIm, bIm ) );
+        }
+        return x;
+    }
+
+    template< class O >
+    int radix4( int x, int width, const float * inRe[ 4 ], const float * inIm[ 4 ], float * outRe[ 4 ], float * outIm[ 4 ], const float * wr, const float * wi, float sign ) noexcept
+    {
+        typename O::T vwr[ 3 ] = { O::set1( wr[0] ), O::set1( wr[1] ), O::set1( wr[2] ) };
+        typename O::T vwi[ 3 ] = { O::set1( wi[0] ), O::set1( wi[1] ), O::set1( wi[2] ) };
+        typename O::T vsign = O::set1( sign );
+        for( ; x + O::width <= width; x += O::width )
+        {
+            typename O::T uRe[ 4 ], uIm[ 4 ];
+            for( int m = 0; m < 4; m++ )
+            {
+                uRe[m] = O::load( inRe[m] + x );
+                uIm[m] = O::load( inIm[m] + x );
+            }
+            for( int m = 1; m < 4; m++ )
+                twiddle< O >( uRe[m], uIm[m], vwr[ m - 1 ], vwi[ m - 1 ] );
+
+            typename O::T v0Re = O::add( uRe[0], uRe[2] ), v0Im = O::add( uIm[0], uIm[2] );
+            typename O::T v1Re = O::sub( uRe[0], uRe[2] ), v1Im = O::sub( uIm[0], uIm[2] );
+            typename O::T v2Re = O::add( uRe[1], uRe[3] ), v2Im = O::add( uIm[1], uIm[3] );
+            // v3 = ( u1 - u3 ) * ( sign * i )
+            typename O::T v3Re = O::mul( vsign, O::sub( uIm[3], uIm[1] ) );
+            typename O::T v3Im = O::mul( vsign, O::sub( uRe[1], uRe[3] ) );
+
+            O::store( outRe[0] + x, O::add( v0Re, v2Re ) );
+            O::store( outIm[0] + x, O::add( v0Im, v2Im ) );
+            O::store( outRe[1] + x, O::add( v1Re, v3Re ) );
+            O::store( outIm[1] + x, O::add( v1Im, v3Im ) );
+            O::store( outRe[2] + x, O::sub( v0Re, v2Re ) );
+            O::store( outIm[2] + x, O::sub( v0Im, v2Im ) );
+            O::store( outRe[3] + x, O::sub( v1Re, v3Re ) );
+            O::store( outIm[3] + x, O::sub( v1Im, v3Im ) );
+        }
+        return x;
+    }
+}
+
+const FFTPlan & FFTPlan::get( int size )
+{
+    static std::mutex mutex;
+    static std::map< int, std::unique_ptr< FFTPlan > > plans;
+
+    std::lock_guard< std::mutex > lock( mutex );
+    std::unique_ptr< FFTPlan > & plan = plans[ size ];
+    if( !plan )
+        plan.reset( new FFTPlan( size ) );
+    return *plan;
+}
+
+FFTPlan::FFTPlan( int size ) : size( size )
+{
+    if( size < 1 || ( size & ( size - 1 ) ) != 0 )
+    {
+        throw std::invalid_argument( "FFT size must be a power of two" );
+    }
+
+    // As many radix-4 stages as possible, one radix-2 stage when log2( size ) is odd
+    int span = 1;
+    while( span < size )
+    {
+        Stage stage;
+        stage.radix = ( size / span ) % 4 == 0 ? 4 : 2;
+        stage.span = span;
+        for( int k = 0; k < span; k++ )
+        {
+            for( int m = 1; m < stage.radix; m++ )
+            {
+                double angle = 2.0 * PI * m * k / ( stage.radix * span );
+                stage.twiddleRe.push_back( static_cast< float >( std::cos( angle ) ) );
+                stage.twiddleIm.push_back( static_cast< float >( std::sin( angle ) ) );
+            }
+        }
+        stages.push_back( stage );
+        span *= stage.radix;
+    }
+}
+
+void FFTPlan::execute( float * re, float * im, float * scratchRe, float * scratchIm, int stride, int width, bool inverse ) const noexcept
+{
+    const float sign = inverse ? 1.0f : -1.0f;
+    float * srcRe = re;
+    float * srcIm = im;
+    float * dstRe = scratchRe;
+    float * dstIm = scratchIm;
+
+    for( const Stage & stage : stages )
+    {
+        const int r = stage.radix;
+        const int p = stage.span;
+        const int count = size / r;
+        for( int i = 0; i < count; i++ )
+        {
+            // Stockham autosort : inputs i + m * N / r, outputs ( i - k ) * r + k + m * p
+            const int k = i & ( p - 1 );
+            const int outBase = ( i - k ) * r + k;
+            const float * inRe[ 4 ];
+            const float * inIm[ 4 ];
+            float * outRe[ 4 ];
+            float * outIm[ 4 ];
+            float wr[ 3 ], wi[ 3 ];
+            for( int m = 0; m < r; m++ )
+            {
+                inRe[m] = srcRe + static_cast< size_t >( i + m * count ) * stride;
+                inIm[m] = srcIm + static_cast< size_t >( i + m * count ) * stride;
+                outRe[m] = dstRe + static_cast< size_t >( outBase + m * p ) * stride;
+                outIm[m] = dstIm + static_cast< size_t >( outBase + m * p ) * stride;
+            }
+            for( int m = 0; m < r - 1; m++ )
+            {
+                wr[m] = stage.twiddleRe[ k * ( r - 1 ) + m ];
+                wi[m] = sign * stage.twiddleIm[ k * ( r - 1 ) + m ];
+            }
+
+            if( r == 4 )
+            {
+                int x = radix4< VectorOps >( 0, width, inRe, inIm, outRe, outIm, wr, wi, sign );
+                radix4< ScalarOps >( x, width, inRe, inIm, outRe, outIm, wr, wi, sign );
+            }
+            else
+            {
+                int x = radix2< VectorOps >( 0, width, inRe, inIm, outRe, outIm, wr[0], wi[0] );
+                radix2< ScalarOps >( x, width, inRe, inIm, outRe, outIm, wr[0], wi[0] );
+            }
+        }
+        std::swap( srcRe, dstRe );
+        std::swap( srcIm, dstIm );
+    }
+
+    // Odd number of stages, the result ended in the scratch planes
+    if( srcRe != re )
+    {
+        for( int j = 0; j < size; j++ )
+        {
+            std::memcpy( re + static_cast< size_t >( j ) * stride, srcRe + static_cast< size_t >( j ) * stride, width * sizeof( float ) );
+            std::memcpy( im + static_cast< size_t >( j ) * stride, srcIm + static_cast< size_t >( j ) * stride, width * sizeof( float ) );
+        }
+    }
+}
+
+int FFTPlan::getSize() const noexcept
+{
+    return size;
+}
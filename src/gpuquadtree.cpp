@@ -0,0 +1,274 @@
+#include <gpuquadtree.hpp>
+#include <quadtree.hpp>
+#include <mesh.hpp>
+#include <glad/glad.h>
+#include <stdexcept>
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+// Entry points and constants of GL 4.3 missing from the 3.3 glad
+typedef void ( APIENTRYP DispatchComputeProc )( GLuint groupsX, GLuint groupsY, GLuint groupsZ );
+typedef void ( APIENTRYP MemoryBarrierProc )( GLbitfield barriers );
+typedef void ( APIENTRYP ClearBufferDataProc )( GLenum target, GLenum internalFormat, GLenum format, GLenum type, const void * data );
+typedef void ( APIENTRYP DrawArraysIndirectProc )( GLenum mode, const void * indirect );
+typedef void ( APIENTRYP MultiDrawElementsIndirectProc )( GLenum mode, GLenum type, const void * indirect, GLsizei drawCount, GLsizei stride );
+#define TILES_STORAGE_BUFFER 0x90D2
+#define TILES_INDIRECT_BUFFER 0x8F3F
+#define TILES_DRAW_BARRIER ( 0x00000001 | 0x00000040 )
+
+// Must match GROUP_SIZE and MAX_LEVELS in quadtree_select.cs
+#define TILES_GROUP_SIZE 8
+#define TILES_MAX_LEVELS 16
+
+namespace
+{
+    // Attributes the water program reads the tile from, after those of Mesh
+    const unsigned int CORNER_ATTRIBUTE = 7;
+    const unsigned int STITCH_ATTRIBUTE = 8;
+
+    // Layouts of the indirect commands and of a tile in quadtree_select.cs
+    struct ElementsCommand
+    {
+        unsigned int count;
+        unsigned int instanceCount;
+        unsigned int firstIndex;
+        int baseVertex;
+        unsigned int baseInstance;
+    };
+    struct ArraysCommand
+    {
+        unsigned int count;
+        unsigned int instanceCount;
+        unsigned int first;
+        unsigned int baseInstance;
+    };
+    struct Tile
+    {
+        glm::vec4 corner;
+        glm::vec4 stitch;
+    };
+}
+
+GpuQuadtree::GpuQuadtree( void * ( *loader )( const char * ), int maxLevel, int tileCells, float leafSize, float distance ) :
+    maxLevel( maxLevel ), tileCells( tileCells ), leafSize( leafSize ), distance( distance ), levelBase( std::max( maxLevel + 1, 1 ) ), levelCapacity( std::max( maxLevel + 1, 1 ) )
+{
+    const int side = tileCells + 1;
+    if( maxLevel < 0 || maxLevel >= TILES_MAX_LEVELS || tileCells < 1 || ( tileCells & ( tileCells - 1 ) ) != 0 || side * side > 65536 || leafSize <= 0.0f || distance <= 0.0f )
+    {
+        throw std::runtime_error( "GPU quadtree tiles must have a power of two cells, at most 255, a positive size and at most 16 levels" );
+    }
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv( GL_MAJOR_VERSION, &major );
+    glGetIntegerv( GL_MINOR_VERSION, &minor );
+    if( major * 10 + minor < 43 )
+    {
+        throw std::runtime_error( "The GPU quadtree needs OpenGL 4.3, the context is " + std::to_string( major ) + "." + std::to_string( minor ) );
+    }
+    dispatchCompute = loader( "glDispatchCompute" );
+    memoryBarrier = loader( "glMemoryBarrier" );
+    clearBufferData = loader( "glClearBufferData" );
+    drawArraysIndirect = loader( "glDrawArraysIndirect" );
+    multiDrawElementsIndirect = loader( "glMultiDrawElementsIndirect" );
+    if( !dispatchCompute || !memoryBarrier || !clearBufferData || !drawArraysIndirect || !multiDrawElementsIndirect )
+    {
+        throw std::runtime_error( "The GPU quadtree could not load the GL 4.3 functions" );
+    }
+
+    shader = std::make_unique< Shader >( "../include/shader/quadtree_select.cs" );
+
+    // The roots overlapping the walked square, then at each level the tiles a refined parent can have : the parents
+    // are within REFINE_DISTANCE times their size of the camera, at most 2 * REFINE_DISTANCE + 1 of them across
+    const float rootSize = std::ldexp( leafSize, maxLevel );
+    maxRoots = static_cast< int >( std::ceil( 2.0f * distance / rootSize ) ) + 1;
+    const int refinedAcross = 2 * ( static_cast< int >( std::ceil( 2.0f * Quadtree::REFINE_DISTANCE ) ) + 1 );
+    for( int level = 0; level <= maxLevel; level++ )
+    {
+        const int across = level == 0 ? maxRoots : std::min( maxRoots << level, refinedAcross );
+        levelBase[ level ] = capacity;
+        levelCapacity[ level ] = across * across;
+        capacity += levelCapacity[ level ];
+    }
+
+    std::vector< glm::vec3 > vertices;
+    std::vector< unsigned short > indices;
+    Quadtree::buildTile( tileCells, vertices, indices );
+    indexCount = static_cast< unsigned int >( indices.size() );
+
+    glGenVertexArrays( 1, &vao );
+    glGenBuffers( 1, &vbo );
+    glGenBuffers( 1, &ebo );
+    glGenBuffers( 1, &instanceBuffer );
+    glBindVertexArray( vao );
+    glBindBuffer( GL_ARRAY_BUFFER, vbo );
+    glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof( glm::vec3 ), vertices.data(), GL_STATIC_DRAW );
+    glEnableVertexAttribArray( 0 );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, sizeof( glm::vec3 ), (void*)0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebo );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof( unsigned short ), indices.data(), GL_STATIC_DRAW );
+    // The commands start each level at its base instance, the attributes never move
+    glBindBuffer( GL_ARRAY_BUFFER, instanceBuffer );
+    glBufferData( GL_ARRAY_BUFFER, static_cast< size_t >( capacity ) * sizeof( Tile ), nullptr, GL_DYNAMIC_COPY );
+    glEnableVertexAttribArray( CORNER_ATTRIBUTE );
+    glVertexAttribPointer( CORNER_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof( Tile ), (void*)offsetof( Tile, corner ) );
+    glVertexAttribDivisor( CORNER_ATTRIBUTE, 1 );
+    glEnableVertexAttribArray( STITCH_ATTRIBUTE );
+    glVertexAttribPointer( STITCH_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof( Tile ), (void*)offsetof( Tile, stitch ) );
+    glVertexAttribDivisor( STITCH_ATTRIBUTE, 1 );
+
+    glGenBuffers( 1, &commandBuffer );
+    glBindBuffer( TILES_STORAGE_BUFFER, commandBuffer );
+    glBufferData( TILES_STORAGE_BUFFER, levelBase.size() * sizeof( ElementsCommand ), nullptr, GL_DYNAMIC_DRAW );
+    glGenBuffers( 1, &captureCommandBuffer );
+    glBindBuffer( TILES_STORAGE_BUFFER, captureCommandBuffer );
+    glBufferData( TILES_STORAGE_BUFFER, levelBase.size() * sizeof( ArraysCommand ), nullptr, GL_DYNAMIC_DRAW );
+    glGenBuffers( 1, &capturedCommandBuffer );
+    glBindBuffer( TILES_STORAGE_BUFFER, capturedCommandBuffer );
+    glBufferData( TILES_STORAGE_BUFFER, static_cast< size_t >( capacity ) * sizeof( ElementsCommand ), nullptr, GL_DYNAMIC_COPY );
+    glBindBuffer( TILES_STORAGE_BUFFER, 0 );
+
+    // Captured vertices, the tiles at their slot
+    glGenBuffers( 1, &feedbackBuffer );
+    glGenVertexArrays( 1, &capturedVao );
+    glBindVertexArray( capturedVao );
+    glBindBuffer( GL_ARRAY_BUFFER, feedbackBuffer );
+    glBufferData( GL_ARRAY_BUFFER, vertices.size() * capacity * sizeof( CapturedVertex ), nullptr, GL_DYNAMIC_COPY );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebo );
+    glEnableVertexAttribArray( 0 );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)0 );
+    glEnableVertexAttribArray( 1 );
+    glVertexAttribPointer( 1, 3, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)offsetof( CapturedVertex, normal ) );
+    glEnableVertexAttribArray( 2 );
+    glVertexAttribPointer( 2, 2, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)offsetof( CapturedVertex, uv ) );
+    glBindVertexArray( 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+GpuQuadtree::~GpuQuadtree()
+{
+    glDeleteVertexArrays( 1, &capturedVao );
+    glDeleteBuffers( 1, &feedbackBuffer );
+    glDeleteBuffers( 1, &capturedCommandBuffer );
+    glDeleteBuffers( 1, &captureCommandBuffer );
+    glDeleteBuffers( 1, &commandBuffer );
+    glDeleteBuffers( 1, &instanceBuffer );
+    glDeleteBuffers( 1, &ebo );
+    glDeleteBuffers( 1, &vbo );
+    glDeleteVertexArrays( 1, &vao );
+}
+
+void GpuQuadtree::update( const glm::mat4 & viewProjection, glm::vec3 cameraPosition, float height ) noexcept
+{
+    // Empty commands, the selection counts the instances up
+    const int tileVertices = ( tileCells + 1 ) * ( tileCells + 1 );
+    std::vector< ElementsCommand > commands( levelBase.size() );
+    std::vector< ArraysCommand > captureCommands( levelBase.size() );
+    for( size_t level = 0; level < levelBase.size(); level++ )
+    {
+        commands[ level ] = { indexCount, 0, 0, 0, static_cast< unsigned int >( levelBase[ level ] ) };
+        captureCommands[ level ] = { static_cast< unsigned int >( tileVertices ), 0, 0, static_cast< unsigned int >( levelBase[ level ] ) };
+    }
+    glBindBuffer( TILES_STORAGE_BUFFER, commandBuffer );
+    glBufferSubData( TILES_STORAGE_BUFFER, 0, commands.size() * sizeof( ElementsCommand ), commands.data() );
+    glBindBuffer( TILES_STORAGE_BUFFER, captureCommandBuffer );
+    glBufferSubData( TILES_STORAGE_BUFFER, 0, captureCommands.size() * sizeof( ArraysCommand ), captureCommands.data() );
+    // The slots left empty draw nothing out of the capture
+    glBindBuffer( TILES_STORAGE_BUFFER, capturedCommandBuffer );
+    reinterpret_cast< ClearBufferDataProc >( clearBufferData )( TILES_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr );
+    glBindBuffer( TILES_STORAGE_BUFFER, 0 );
+
+    // Planes of the frustum from the rows of the matrix, as in Quadtree::update
+    const glm::vec4 rows[4] = { glm::vec4( viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0] ),
+                                glm::vec4( viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1] ),
+                                glm::vec4( viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2] ),
+                                glm::vec4( viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3] ) };
+    const float rootSize = std::ldexp( leafSize, maxLevel );
+    const glm::vec2 flat( cameraPosition.x, cameraPosition.z );
+    const glm::ivec2 first( glm::floor( ( flat - distance ) / rootSize ) );
+    const glm::ivec2 last( glm::floor( ( flat + distance ) / rootSize ) );
+    glm::vec2 rootOrigin = glm::vec2( first ) * rootSize;
+
+    shader->activate();
+    shader->setInt( "maxLevel", maxLevel );
+    shader->setInt( "tileCells", tileCells );
+    shader->setFloat( "leafSize", leafSize );
+    shader->setFloat( "refineDistance", Quadtree::REFINE_DISTANCE );
+    shader->setVec2( "rootOrigin", rootOrigin );
+    shader->setInt( "rootsX", last.x - first.x + 1 );
+    shader->setInt( "rootsZ", last.y - first.y + 1 );
+    shader->setVec3( "camera", cameraPosition );
+    shader->setFloat( "height", std::abs( height ) );
+    for( int i = 0; i < 3; i++ )
+    {
+        glm::vec4 low = rows[3] + rows[i];
+        glm::vec4 high = rows[3] - rows[i];
+        shader->setVec4( ( "planes[" + std::to_string( i * 2 ) + "]" ).c_str(), low );
+        shader->setVec4( ( "planes[" + std::to_string( i * 2 + 1 ) + "]" ).c_str(), high );
+    }
+    shader->setIntArray( "levelCapacity", levelCapacity.data(), static_cast< unsigned int >( levelCapacity.size() ) );
+
+    glBindBufferBase( TILES_STORAGE_BUFFER, 0, commandBuffer );
+    glBindBufferBase( TILES_STORAGE_BUFFER, 1, captureCommandBuffer );
+    glBindBufferBase( TILES_STORAGE_BUFFER, 2, capturedCommandBuffer );
+    glBindBufferBase( TILES_STORAGE_BUFFER, 3, instanceBuffer );
+    const GLuint groups = static_cast< GLuint >( ( ( maxRoots << maxLevel ) + TILES_GROUP_SIZE - 1 ) / TILES_GROUP_SIZE );
+    reinterpret_cast< DispatchComputeProc >( dispatchCompute )( groups, groups, static_cast< GLuint >( maxLevel + 1 ) );
+    for( GLuint binding = 0; binding < 4; binding++ )
+        glBindBufferBase( TILES_STORAGE_BUFFER, binding, 0 );
+    // The draws read the commands and the tiles as attributes
+    reinterpret_cast< MemoryBarrierProc >( memoryBarrier )( TILES_DRAW_BARRIER );
+}
+
+void GpuQuadtree::draw() const noexcept
+{
+    glBindVertexArray( vao );
+    glBindBuffer( TILES_INDIRECT_BUFFER, commandBuffer );
+    reinterpret_cast< MultiDrawElementsIndirectProc >( multiDrawElementsIndirect )( GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr, static_cast< GLsizei >( levelBase.size() ), 0 );
+    glBindBuffer( TILES_INDIRECT_BUFFER, 0 );
+    glBindVertexArray( 0 );
+}
+
+void GpuQuadtree::capture() const noexcept
+{
+    // Transform feedback appends, so every level is captured on its own into the range of its slots
+    const size_t tileBytes = static_cast< size_t >( tileCells + 1 ) * ( tileCells + 1 ) * sizeof( CapturedVertex );
+    glEnable( GL_RASTERIZER_DISCARD );
+    glBindVertexArray( vao );
+    glBindBuffer( TILES_INDIRECT_BUFFER, captureCommandBuffer );
+    for( size_t level = 0; level < levelBase.size(); level++ )
+    {
+        glBindBufferRange( GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedbackBuffer, levelBase[ level ] * tileBytes, levelCapacity[ level ] * tileBytes );
+        glBeginTransformFeedback( GL_POINTS );
+        reinterpret_cast< DrawArraysIndirectProc >( drawArraysIndirect )( GL_POINTS, (void*)( level * sizeof( ArraysCommand ) ) );
+        glEndTransformFeedback();
+    }
+    glBindBufferBase( GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0 );
+    glBindBuffer( TILES_INDIRECT_BUFFER, 0 );
+    glBindVertexArray( 0 );
+    glDisable( GL_RASTERIZER_DISCARD );
+}
+
+void GpuQuadtree::drawCaptured() const noexcept
+{
+    glBindVertexArray( capturedVao );
+    glBindBuffer( TILES_INDIRECT_BUFFER, capturedCommandBuffer );
+    reinterpret_cast< MultiDrawElementsIndirectProc >( multiDrawElementsIndirect )( GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr, static_cast< GLsizei >( capacity ), 0 );
+    glBindBuffer( TILES_INDIRECT_BUFFER, 0 );
+    glBindVertexArray( 0 );
+}
+
+int GpuQuadtree::getLevelCount() const noexcept
+{
+    return static_cast< int >( levelBase.size() );
+}
+
+int GpuQuadtree::getCapacity() const noexcept
+{
+    return capacity;
+}
+
+unsigned int GpuQuadtree::getTileVertexCount() const noexcept
+{
+    return static_cast< unsigned int >( ( tileCells + 1 ) * ( tileCells + 1 ) );
+}
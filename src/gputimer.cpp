@@ -0,0 +1,75 @@
+#include <gputimer.hpp>
+#include <glad/glad.h>
+
+GpuTimer::GpuTimer() noexcept
+{
+    glGenQueries( QUERY_COUNT, queries );
+}
+
+GpuTimer::~GpuTimer()
+{
+    glDeleteQueries( QUERY_COUNT, queries );
+}
+
+void GpuTimer::begin() noexcept
+{
+    collect();
+    // Every query still in flight is busy : drop this measure rather than wait for the oldest one
+    if( issued[ next ] )
+        return;
+    glBeginQuery( GL_TIME_ELAPSED, queries[ next ] );
+}
+
+void GpuTimer::end() noexcept
+{
+    if( issued[ next ] )
+        return;
+    glEndQuery( GL_TIME_ELAPSED );
+    issued[ next ] = true;
+    next = ( next + 1 ) % QUERY_COUNT;
+}
+
+void GpuTimer::reset() noexcept
+{
+    collect();
+    totalMilliseconds = 0.0;
+    sampleCount = 0;
+    // Queries issued before the reset must not count
+    for( int i = 0; i < QUERY_COUNT; i++ )
+    {
+        if( issued[i] )
+        {
+            GLuint64 elapsed;
+            glGetQueryObjectui64v( queries[i], GL_QUERY_RESULT, &elapsed );
+            issued[i] = false;
+        }
+    }
+}
+
+float GpuTimer::getMilliseconds() const noexcept
+{
+    return sampleCount > 0 ? static_cast< float >( totalMilliseconds / sampleCount ) : 0.0f;
+}
+
+int GpuTimer::getSampleCount() const noexcept
+{
+    return sampleCount;
+}
+
+void GpuTimer::collect() noexcept
+{
+    for( int i = 0; i < QUERY_COUNT; i++ )
+    {
+        if( !issued[i] )
+            continue;
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv( queries[i], GL_QUERY_RESULT_AVAILABLE, &available );
+        if( !available )
+            continue;
+        GLuint64 elapsed;
+        glGetQueryObjectui64v( queries[i], GL_QUERY_RESULT, &elapsed );
+        totalMilliseconds += elapsed * 1e-6;
+        sampleCount++;
+        issued[i] = false;
+    }
+}
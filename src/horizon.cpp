@@ -0,0 +1,48 @@
+#include <horizon.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+
+Horizon::Horizon( int waveCount ) noexcept : waveCount( std::max( waveCount, 0 ) )
+{
+    glGenVertexArrays( 1, &quadVAO );
+}
+
+Horizon::~Horizon()
+{
+    glDeleteVertexArrays( 1, &quadVAO );
+}
+
+void Horizon::draw( const glm::mat4 & view, const glm::mat4 & projection, int tableWaves, float fadeStart, float fadeEnd ) noexcept
+{
+    int viewport[ 4 ];
+    glGetIntegerv( GL_VIEWPORT, viewport );
+    // The far field lies under everything else, it neither tests nor writes the depth
+    bool depthTest = glIsEnabled( GL_DEPTH_TEST );
+    glDisable( GL_DEPTH_TEST );
+    glDepthMask( GL_FALSE );
+    glBindVertexArray( quadVAO );
+
+    shader.activate();
+    // Without the translation the rays come out relative to the camera, whatever the depth convention
+    glm::mat4 inverseViewProjection = glm::inverse( projection * glm::mat4( glm::mat3( view ) ) );
+    shader.setMat4( "inverseViewProjection", inverseViewProjection );
+    shader.setVec2( "screenSize", static_cast< float >( viewport[2] ), static_cast< float >( viewport[3] ) );
+    shader.setInt( "numWaves", std::min( waveCount, tableWaves ) );
+    shader.setVec2( "meshFade", fadeStart, fadeEnd );
+    glDrawArrays( GL_TRIANGLES, 0, 3 );
+
+    glBindVertexArray( 0 );
+    glDepthMask( GL_TRUE );
+    if( depthTest )
+        glEnable( GL_DEPTH_TEST );
+}
+
+Shader & Horizon::getShader() noexcept
+{
+    return shader;
+}
+
+int Horizon::getWaveCount() const noexcept
+{
+    return waveCount;
+}
@@ -10,12 +10,38 @@
 #include <stb_image.h>
 #include <model.hpp>
 #include <hud.hpp>
+#include <oceanfft.hpp>
+#include <simulation.hpp>
+#include <streamtexture.hpp>
+#include <wavespectrum.hpp>
+#include <wavetable.hpp>
+#include <wavephases.hpp>
+#include <bakedwaves.hpp>
+#include <gputimer.hpp>
+#include <wakefield.hpp>
+#include <vertexprobe.hpp>
+#include <computewaves.hpp>
+#include <spray.hpp>
+#include <sprayrenderer.hpp>
+#include <detailnormals.hpp>
+#include <projectedgrid.hpp>
+#include <clipmap.hpp>
+#include <quadtree.hpp>
+#include <gpuquadtree.hpp>
+#include <waterpatches.hpp>
+#include <primitivecounter.hpp>
+#include <horizon.hpp>
+#include <reverseddepth.hpp>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <cmath>
 
 #define FAR_PLANE 100.0f
 #define NEAR_PLANE 0.1f
 
 float deltaTime = 0.0f;
-float lastFrame = 0.0f;
+double lastFrame = 0.0;
 float lastMouseX = 0.0f;
 float lastMouseY = 0.0f;
 Camera cam( glm::vec3( 0.0f, 5.0f, 0.0f ) );
@@ -37,6 +63,166 @@ float fresnel = 0.4f;
 
 bool displayHUD = true;
 
+enum WaveMode
+{
+    SUM_OF_SINES,
+    FFT_GPU,
+    FFT_CPU,
+    BAKED,
+    WAVE_MODE_COUNT
+};
+const char * waveModeNames[ WAVE_MODE_COUNT ] = { "Sum of sines", "FFT ( GPU )", "FFT ( CPU )", "Baked loop" };
+int waveMode = SUM_OF_SINES;
+bool fftAvailable = true;
+int spectrumType = SPECTRUM_LEGACY;
+float windSpeed = 20.0f; // FFT ocean
+float spectrumWindSpeed = SpectrumParameters().windSpeed; // physical spectra of the sum of waves
+float choppiness = 1.0f;
+
+// Wind the O and P keys change, that of the mode displayed
+float & activeWindSpeed()
+{
+    return waveMode == SUM_OF_SINES || waveMode == BAKED ? spectrumWindSpeed : windSpeed;
+}
+
+// Waves whose wavelength covers fewer than lodPixels pixels on screen are faded out of the sum of waves
+bool waveLOD = true;
+float lodPixels = 2.0f;
+
+// Vertex stage cost measurement : for each wave count, LOD off then on, the water is drawn once more per frame
+// with the rasterizer disabled inside a timer query
+const unsigned int lodBenchWaveCounts[] = { 16, 64, 256, 1024 };
+const int LOD_BENCH_STEPS = 8;
+const int LOD_BENCH_FRAMES = 60;
+int lodBenchStep = -1; // wave count index * 2 + LOD on, -1 when idle
+int lodBenchFrame = 0;
+float lodBenchResults[ LOD_BENCH_STEPS ] = {};
+bool lodBenchDone = false;
+
+// Soak test : the wave clock runs ahead of the real one to show how the animation holds after a long uptime
+const double clockOffsets[] = { 0.0, 86400.0, 30.0 * 86400.0, 365.0 * 86400.0 };
+const char * clockOffsetNames[] = { "none", "1 day", "30 days", "1 year" };
+const int CLOCK_OFFSET_COUNT = 4;
+int clockOffset = 0;
+
+// Ripples simulated around the camera, pushed by a boat circling the origin and by splashes where the camera looks
+bool wakeEnabled = true;
+bool boatEnabled = true;
+bool splashRequested = false;
+const float BOAT_RADIUS = 20.0f;
+const float BOAT_SPEED = 6.0f;
+
+// Precision tiers of the water shaders : polynomial approximations of the transcendental functions in place of
+// the built-in ones, see WATER_FAST_MATH in wavemodel.glsl and water.fs
+enum MathTier
+{
+    MATH_EXACT,
+    MATH_FAST,
+    MATH_FASTEST,
+    MATH_TIER_COUNT
+};
+const char * mathTierNames[ MATH_TIER_COUNT ] = { "exact", "fast", "fastest" };
+const char * mathTierDefines[ MATH_TIER_COUNT ] = { "", "#define WATER_FAST_MATH 1", "#define WATER_FAST_MATH 2" };
+int mathTier = MATH_EXACT;
+const int MATH_PROBE_PERIOD = 30; // frames between two error measures of the selected tier
+
+// Tier comparison : the sum of waves is drawn with each tier in turn, timing the water draw and the whole frame,
+// then the error of the tier against the exact path is measured
+const int MATH_BENCH_FRAMES = 120;
+int mathBenchStep = -1; // tier measured, -1 when idle
+int mathBenchFrame = 0;
+double mathBenchFrameTime = 0.0;
+float mathBenchDrawResults[ MATH_TIER_COUNT ] = {};
+float mathBenchFrameResults[ MATH_TIER_COUNT ] = {};
+VertexError mathBenchErrors[ MATH_TIER_COUNT ];
+bool mathBenchDone = false;
+
+// Water passes : the displaced surface is captured once per frame with transform feedback and every pass draws it
+// with a pass-through vertex stage, instead of running the sum of waves again. The depth pre-pass is a second
+// consumer of the surface, it spares the shading of the hidden water fragments
+enum WaterPass
+{
+    PASS_CAPTURE,
+    PASS_DEPTH,
+    PASS_COLOR,
+    WATER_PASS_COUNT
+};
+const char * waterPassNames[ WATER_PASS_COUNT ] = { "capture", "depth", "color" };
+bool surfaceCache = true;
+bool depthPrepass = false;
+const int PASS_TIMING_FRAMES = 60; // frames averaged by the pass timings shown
+
+// The CPU ocean ticks are written to a memory-mapped ring file for external tools, see RingExport
+bool exportEnabled = false;
+const char * EXPORT_PATH = "ocean.ring";
+
+// Spray and foam thrown by the crests of the sum of waves, simulated on the CPU and drawn over the scene
+bool sprayEnabled = false;
+float sprayThreshold = 0.8f; // slope over which a crest breaks, the physical spectra need a lower one than the legacy waves
+const int SPRAY_FOAM_WAVES = 8; // largest waves of the table the foam floats on
+
+// The short waves of the sum of waves are shaded from a tiling slope map rendered once per frame instead of
+// displacing the mesh, so a coarse mesh keeps the shading detail of a dense one, see DetailNormals
+bool detailEnabled = true;
+
+// Water meshes : the model file, then flat grids of increasing density over the same square, then the grid
+// projected from the screen, see ProjectedGrid, the rings of the clipmap, see Clipmap, the tiles of the quadtree,
+// see Quadtree, and the patches subdivided by the tessellation stages when the context is 4.0, see WaterPatches
+const int WATER_GRID_CELLS[] = { 32, 64, 128, 256, 512 };
+const int WATER_GRID_COUNT = 5;
+const float WATER_GRID_SIZE = 256.0f;
+const int WATER_MESH_PROJECTED = WATER_GRID_COUNT + 1;
+const int WATER_MESH_CLIPMAP = WATER_GRID_COUNT + 2;
+const int WATER_MESH_QUADTREE = WATER_GRID_COUNT + 3;
+const int WATER_MESH_TESSELLATED = WATER_GRID_COUNT + 4;
+bool tessellationAvailable = false;
+float pixelsPerTriangle = 8.0f; // target area of the tessellated triangles on screen
+int waterMesh = WATER_MESH_PROJECTED; // 0 the model file, i + 1 the grid i
+// Cells of the innermost level of the clipmap and of the finest tiles, the spacing of the densest grid
+const float CLIPMAP_CELL_SIZE = 0.5f;
+const int QUADTREE_LEVELS = 5;
+const int QUADTREE_TILE_CELLS = 32;
+// Columns of the projected grid, the rows follow the aspect ratio of the window
+const int PROJECTED_GRID_COLUMNS[] = { 64, 128, 256, 512 };
+const int PROJECTED_GRID_COUNT = 4;
+int projectedGridIndex = 2;
+
+// Mesh comparison : frame time and GPU time of the water on every grid then on the clipmap, as detailed as the
+// densest grid near the camera, with all the waves in the vertex stage then with the short ones in the detail map
+const int MESH_BENCH_MESHES = WATER_GRID_COUNT + 1;
+const int MESH_BENCH_STEPS = MESH_BENCH_MESHES * 2;
+const int MESH_BENCH_FRAMES = 60;
+int meshBenchStep = -1; // mesh index * 2 + detail map on, -1 when idle
+int meshBenchFrame = 0;
+double meshBenchFrameTime = 0.0;
+float meshBenchFrameResults[ MESH_BENCH_STEPS ] = {};
+float meshBenchGpuResults[ MESH_BENCH_STEPS ] = {};
+int meshBenchVertexWaves[ MESH_BENCH_STEPS ] = {};
+bool meshBenchDone = false;
+
+// Sum of waves computed into maps by compute shaders when the context is 4.3 or newer, in the vertex stage otherwise
+bool computeWavesEnabled = true;
+// Quadtree tiles selected by a compute shader and drawn indirectly when the context is 4.3 or newer, on the CPU otherwise
+bool gpuTilesEnabled = true;
+// The sea past the water mesh is shaded per pixel out to the horizon, see Horizon, and the fog recedes with it
+bool horizonEnabled = true;
+const int HORIZON_WAVES = 8; // longest waves of the table in the far field
+const float HORIZON_FADE_START = 0.6f; // fractions of the far plane the mesh fades into the far field between
+const float HORIZON_FADE_END = 0.9f;
+const float HORIZON_FOG_SCALE = 20.0f; // stretch of the fog distances while the sea reaches the horizon
+
+// Floating origin : the camera position is kept in double precision and the scene is drawn relative to an origin
+// moved near it in steps, the wave phases take up the move. The step is a multiple of every tiling texture and
+// of the quadtree roots, so the surface is the same on both sides of a move
+bool floatingOrigin = true;
+const double ORIGIN_STEP = 1024.0;
+const double JUMP_DISTANCE = 10000.0; // the camera can be sent this far along x at once to look at the precision
+
+// Reversed-Z float depth when the context has clip control, see ReversedDepth, the far plane of the projection is
+// then pushed this far out, the meshes keep reaching FAR_PLANE
+bool reversedDepthEnabled = true;
+const float REVERSED_FAR_PLANE = FAR_PLANE * 1000.0f;
+
 void move( GLFWwindow * window )
 {
     CameraMovement direction = NONE;
@@ -73,12 +259,13 @@ void keyCallBack( GLFWwindow * window, int key, int scancode, int action, int mo
             glfwSetWindowShouldClose( window, true );
             break;
         case GLFW_KEY_1:
+            // Steps grow with the count so thousands of waves stay reachable
             if( numWaves > 0 )
-                numWaves--;
+                numWaves -= std::max( 1u, numWaves / 17 );
             break;
         case GLFW_KEY_2:
-            if( numWaves < 64 )
-                numWaves++;
+            if( numWaves < MAX_WAVES )
+                numWaves = std::min( numWaves + std::max( 1u, numWaves / 16 ), static_cast< unsigned int >( MAX_WAVES ) );
             break;
         case GLFW_KEY_0:
             if( gammaCorrection < 5.0f )
@@ -184,6 +371,171 @@ void keyCallBack( GLFWwindow * window, int key, int scancode, int action, int mo
             if( fresnel < 1.0f )
                 fresnel += 0.01f;
             break;
+        case GLFW_KEY_M:
+            if( action == GLFW_PRESS )
+            {
+                waveMode = ( waveMode + 1 ) % WAVE_MODE_COUNT;
+                if( waveMode == FFT_GPU && !fftAvailable )
+                    waveMode = FFT_CPU;
+            }
+            break;
+        case GLFW_KEY_T:
+            if( action == GLFW_PRESS )
+                spectrumType = ( spectrumType + 1 ) % SPECTRUM_COUNT;
+            break;
+        case GLFW_KEY_O:
+            if( activeWindSpeed() > 1.0f )
+                activeWindSpeed() -= 0.5f;
+            break;
+        case GLFW_KEY_P:
+            if( activeWindSpeed() < 50.0f )
+                activeWindSpeed() += 0.5f;
+            break;
+        case GLFW_KEY_Y:
+            if( choppiness > 0.0f )
+                choppiness -= 0.05f;
+            break;
+        case GLFW_KEY_U:
+            if( choppiness < 3.0f )
+                choppiness += 0.05f;
+            break;
+        case GLFW_KEY_B:
+            if( action == GLFW_PRESS )
+                waveLOD = !waveLOD;
+            break;
+        case GLFW_KEY_3:
+            if( lodPixels > 0.5f )
+                lodPixels /= 1.25f;
+            break;
+        case GLFW_KEY_4:
+            if( lodPixels < 32.0f )
+                lodPixels *= 1.25f;
+            break;
+        case GLFW_KEY_5:
+            if( action == GLFW_PRESS && lodBenchStep < 0 )
+            {
+                lodBenchStep = 0;
+                lodBenchFrame = 0;
+                lodBenchDone = false;
+                waveMode = SUM_OF_SINES;
+            }
+            break;
+        case GLFW_KEY_I:
+            if( action == GLFW_PRESS )
+                wakeEnabled = !wakeEnabled;
+            break;
+        case GLFW_KEY_N:
+            if( action == GLFW_PRESS )
+                boatEnabled = !boatEnabled;
+            break;
+        case GLFW_KEY_R:
+            if( action == GLFW_PRESS )
+                splashRequested = true;
+            break;
+        case GLFW_KEY_6:
+            if( action == GLFW_PRESS )
+                clockOffset = ( clockOffset + 1 ) % CLOCK_OFFSET_COUNT;
+            break;
+        case GLFW_KEY_7:
+            if( action == GLFW_PRESS )
+                mathTier = ( mathTier + 1 ) % MATH_TIER_COUNT;
+            break;
+        case GLFW_KEY_F1:
+            if( action == GLFW_PRESS )
+                surfaceCache = !surfaceCache;
+            break;
+        case GLFW_KEY_F2:
+            if( action == GLFW_PRESS )
+                depthPrepass = !depthPrepass;
+            break;
+        case GLFW_KEY_F3:
+            if( action == GLFW_PRESS )
+                computeWavesEnabled = !computeWavesEnabled;
+            break;
+        case GLFW_KEY_F4:
+            if( action == GLFW_PRESS )
+                exportEnabled = !exportEnabled;
+            break;
+        case GLFW_KEY_F5:
+            if( action == GLFW_PRESS )
+                sprayEnabled = !sprayEnabled;
+            break;
+        case GLFW_KEY_F6:
+            if( sprayThreshold > 0.1f )
+                sprayThreshold -= 0.05f;
+            break;
+        case GLFW_KEY_F7:
+            if( sprayThreshold < 2.0f )
+                sprayThreshold += 0.05f;
+            break;
+        case GLFW_KEY_F8:
+            if( action == GLFW_PRESS )
+            {
+                waterMesh = ( waterMesh + 1 ) % ( WATER_MESH_TESSELLATED + 1 );
+                if( waterMesh == WATER_MESH_TESSELLATED && !tessellationAvailable )
+                    waterMesh = 0;
+            }
+            break;
+        case GLFW_KEY_PAGE_UP:
+            if( action == GLFW_PRESS && projectedGridIndex < PROJECTED_GRID_COUNT - 1 )
+                projectedGridIndex++;
+            break;
+        case GLFW_KEY_PAGE_DOWN:
+            if( action == GLFW_PRESS && projectedGridIndex > 0 )
+                projectedGridIndex--;
+            break;
+        case GLFW_KEY_F11:
+            if( action == GLFW_PRESS )
+                gpuTilesEnabled = !gpuTilesEnabled;
+            break;
+        case GLFW_KEY_F12:
+            if( action == GLFW_PRESS )
+                horizonEnabled = !horizonEnabled;
+            break;
+        case GLFW_KEY_INSERT:
+            if( action == GLFW_PRESS )
+                cam.translate( glm::dvec3( JUMP_DISTANCE, 0.0, 0.0 ) );
+            break;
+        case GLFW_KEY_DELETE:
+            if( action == GLFW_PRESS )
+                floatingOrigin = !floatingOrigin;
+            break;
+        case GLFW_KEY_KP_0:
+            if( action == GLFW_PRESS )
+                reversedDepthEnabled = !reversedDepthEnabled;
+            break;
+        case GLFW_KEY_HOME:
+            if( action == GLFW_PRESS && pixelsPerTriangle > 1.0f )
+                pixelsPerTriangle *= 0.5f;
+            break;
+        case GLFW_KEY_END:
+            if( action == GLFW_PRESS && pixelsPerTriangle < 256.0f )
+                pixelsPerTriangle *= 2.0f;
+            break;
+        case GLFW_KEY_F9:
+            if( action == GLFW_PRESS )
+                detailEnabled = !detailEnabled;
+            break;
+        case GLFW_KEY_F10:
+            if( action == GLFW_PRESS && meshBenchStep < 0 )
+            {
+                meshBenchStep = 0;
+                meshBenchFrame = 0;
+                meshBenchFrameTime = 0.0;
+                meshBenchDone = false;
+                waveMode = SUM_OF_SINES;
+            }
+            break;
+        case GLFW_KEY_8:
+            if( action == GLFW_PRESS && mathBenchStep < 0 )
+            {
+                mathBenchStep = 0;
+                mathBenchFrame = 0;
+                mathBenchFrameTime = 0.0;
+                mathBenchDone = false;
+                waveMode = SUM_OF_SINES;
+            }
+            break;
     }
 }
 
@@ -213,9 +565,6 @@ int main()
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return -1;
     }
-    // Set OpenGL version to 3.3
-    glfwWindowHint( GLFW_CONTEXT_VERSION_MAJOR, 3 );
-    glfwWindowHint( GLFW_CONTEXT_VERSION_MINOR, 3 );
     glfwWindowHint( GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE );
 
     // Create window
@@ -230,7 +579,17 @@ int main()
     lastMouseX = W_WIDTH / 2.0f;
     lastMouseY = W_HEIGHT / 2.0f;
 
-    GLFWwindow * window = glfwCreateWindow( W_WIDTH, W_HEIGHT, "Ocean", nullptr, nullptr );
+    // OpenGL 4.3 enables the compute path of the sum of waves, everything else only needs 3.3
+    const int contextVersions[][ 2 ] = { { 4, 3 }, { 3, 3 } };
+    GLFWwindow * window = nullptr;
+    for( const auto & version : contextVersions )
+    {
+        glfwWindowHint( GLFW_CONTEXT_VERSION_MAJOR, version[ 0 ] );
+        glfwWindowHint( GLFW_CONTEXT_VERSION_MINOR, version[ 1 ] );
+        window = glfwCreateWindow( W_WIDTH, W_HEIGHT, "Ocean", nullptr, nullptr );
+        if( window )
+            break;
+    }
     if( !window )
     {
         std::cerr << "Failed to create window" << std::endl;
@@ -270,7 +629,147 @@ int main()
 
     // Water surface model
     Model water( "../include/water.obj" );
-    Shader waterShader( "../include/shader/water.vs", "../include/shader/water.fs" );
+    std::vector< Model > waterGrids;
+    waterGrids.reserve( WATER_GRID_COUNT );
+    for( int cells : WATER_GRID_CELLS )
+        waterGrids.emplace_back( std::vector< Mesh >{ Mesh::grid( cells, WATER_GRID_SIZE ) } );
+    std::vector< ProjectedGrid > projectedGrids;
+    projectedGrids.reserve( PROJECTED_GRID_COUNT );
+    for( int columns : PROJECTED_GRID_COLUMNS )
+        projectedGrids.emplace_back( columns, std::max( columns * W_HEIGHT / W_WIDTH, 1 ) );
+    // As many levels as needed to reach the far plane
+    Clipmap clipmap( Clipmap::levelsFor( FAR_PLANE, 64, CLIPMAP_CELL_SIZE ), 64, CLIPMAP_CELL_SIZE );
+    Quadtree quadtree( QUADTREE_LEVELS - 1, QUADTREE_TILE_CELLS, QUADTREE_TILE_CELLS * CLIPMAP_CELL_SIZE );
+    Shader waterShaders[ MATH_TIER_COUNT ] = {
+        { "../include/shader/water.vs", "../include/shader/water.fs", nullptr, mathTierDefines[ MATH_EXACT ] },
+        { "../include/shader/water.vs", "../include/shader/water.fs", nullptr, mathTierDefines[ MATH_FAST ] },
+        { "../include/shader/water.vs", "../include/shader/water.fs", nullptr, mathTierDefines[ MATH_FASTEST ] }
+    };
+    // Vertex stages alone capturing the surface, for the passes and to measure the error of each tier
+    const std::vector< std::string > surfaceVaryings = { "VS_OUT.pos", "VS_OUT.normal", "VS_OUT.uv" };
+    Shader captureShaders[ MATH_TIER_COUNT ] = {
+        { "../include/shader/water.vs", surfaceVaryings, mathTierDefines[ MATH_EXACT ] },
+        { "../include/shader/water.vs", surfaceVaryings, mathTierDefines[ MATH_FAST ] },
+        { "../include/shader/water.vs", surfaceVaryings, mathTierDefines[ MATH_FASTEST ] }
+    };
+    Shader cachedShaders[ MATH_TIER_COUNT ] = {
+        { "../include/shader/water_cached.vs", "../include/shader/water.fs", nullptr, mathTierDefines[ MATH_EXACT ] },
+        { "../include/shader/water_cached.vs", "../include/shader/water.fs", nullptr, mathTierDefines[ MATH_FAST ] },
+        { "../include/shader/water_cached.vs", "../include/shader/water.fs", nullptr, mathTierDefines[ MATH_FASTEST ] }
+    };
+    Shader depthShaders[ MATH_TIER_COUNT ] = {
+        { "../include/shader/water.vs", "../include/shader/depth.fs", nullptr, mathTierDefines[ MATH_EXACT ] },
+        { "../include/shader/water.vs", "../include/shader/depth.fs", nullptr, mathTierDefines[ MATH_FAST ] },
+        { "../include/shader/water.vs", "../include/shader/depth.fs", nullptr, mathTierDefines[ MATH_FASTEST ] }
+    };
+    Shader cachedDepthShader( "../include/shader/water_cached.vs", "../include/shader/depth.fs" );
+    VertexProbe probe;
+    VertexError mathError;
+
+    // Spectral ocean
+    std::unique_ptr< OceanFFT > ocean;
+    try
+    {
+        ocean = std::make_unique< OceanFFT >( 256, 128.0f );
+    }
+    catch( std::exception & e )
+    {
+        std::cerr << e.what() << std::endl;
+        fftAvailable = false;
+    }
+    // The CPU ocean runs at a fixed rate on its own thread, the frames blend its last two ticks
+    Simulation simulation( 60.0, 256, 128.0f );
+    std::vector< glm::vec4 > cpuDisplacement;
+    std::vector< glm::vec4 > cpuNormals;
+
+    // Sum of waves table, rebuilt and uploaded only when a parameter changes
+    WaveSpectrum spectrum;
+    WaveTable waveTable;
+    WavePhases wavePhases;
+    StreamTexture cpuDisplacementMap( simulation.getResolution(), simulation.getResolution(), GL_RGBA16F );
+    StreamTexture cpuNormalMap( simulation.getResolution(), simulation.getResolution(), GL_RGBA16F, true );
+    // Looping copy of the sum of waves, baked in the background whenever the parameters settle
+    BakedWaves baked;
+    std::unique_ptr< WakeField > wake;
+    try
+    {
+        wake = std::make_unique< WakeField >( 1024, 256.0f );
+    }
+    catch( std::exception & e )
+    {
+        std::cerr << e.what() << std::endl;
+        wakeEnabled = false;
+    }
+    std::unique_ptr< ComputeWaves > computeWaves;
+    try
+    {
+        computeWaves = std::make_unique< ComputeWaves >( reinterpret_cast< void * ( * )( const char * ) >( glfwGetProcAddress ), 1024, 256.0f );
+    }
+    catch( std::exception & e )
+    {
+        std::cerr << e.what() << std::endl;
+        computeWavesEnabled = false;
+    }
+    std::unique_ptr< GpuQuadtree > gpuQuadtree;
+    try
+    {
+        gpuQuadtree = std::make_unique< GpuQuadtree >( reinterpret_cast< void * ( * )( const char * ) >( glfwGetProcAddress ), QUADTREE_LEVELS - 1, QUADTREE_TILE_CELLS, QUADTREE_TILE_CELLS * CLIPMAP_CELL_SIZE, FAR_PLANE );
+    }
+    catch( std::exception & e )
+    {
+        std::cerr << e.what() << std::endl;
+        gpuTilesEnabled = false;
+    }
+    std::unique_ptr< WaterPatches > waterPatches;
+    std::unique_ptr< Shader > tessellatedShaders[ MATH_TIER_COUNT ];
+    std::unique_ptr< Shader > tessellatedDepthShaders[ MATH_TIER_COUNT ];
+    try
+    {
+        waterPatches = std::make_unique< WaterPatches >( reinterpret_cast< void * ( * )( const char * ) >( glfwGetProcAddress ), FAR_PLANE );
+        for( int tier = 0; tier < MATH_TIER_COUNT; tier++ )
+        {
+            tessellatedShaders[ tier ] = std::make_unique< Shader >( "../include/shader/water_patch.vs", "../include/shader/water.tcs", "../include/shader/water.tes", "../include/shader/water.fs", mathTierDefines[ tier ] );
+            tessellatedDepthShaders[ tier ] = std::make_unique< Shader >( "../include/shader/water_patch.vs", "../include/shader/water.tcs", "../include/shader/water.tes", "../include/shader/depth.fs", mathTierDefines[ tier ] );
+        }
+        tessellationAvailable = true;
+    }
+    catch( std::exception & e )
+    {
+        std::cerr << e.what() << std::endl;
+    }
+    std::unique_ptr< ReversedDepth > reversedDepth;
+    try
+    {
+        reversedDepth = std::make_unique< ReversedDepth >( reinterpret_cast< void * ( * )( const char * ) >( glfwGetProcAddress ), W_WIDTH, W_HEIGHT );
+    }
+    catch( std::exception & e )
+    {
+        std::cerr << e.what() << std::endl;
+        reversedDepthEnabled = false;
+    }
+    PrimitiveCounter primitiveCounter;
+    Horizon horizon( HORIZON_WAVES );
+    Spray spray;
+    SprayRenderer sprayRenderer( spray.getCapacity() );
+    float sprayUpdateMilliseconds = 0.0f;
+    float sprayEmitMilliseconds = 0.0f;
+    std::unique_ptr< DetailNormals > detailNormals;
+    try
+    {
+        detailNormals = std::make_unique< DetailNormals >( 512, 64.0f );
+    }
+    catch( std::exception & e )
+    {
+        std::cerr << e.what() << std::endl;
+        detailEnabled = false;
+    }
+    GpuTimer detailTimer;
+    float detailMilliseconds = 0.0f;
+    GpuTimer computeTimer;
+    float computeMilliseconds = 0.0f;
+    GpuTimer lodTimer;
+    GpuTimer passTimers[ WATER_PASS_COUNT ];
+    float passMilliseconds[ WATER_PASS_COUNT ] = {};
 
     // Skybox mesh
     float skyboxVertices [] = {
@@ -374,11 +873,14 @@ int main()
     float sumFPS = 0.0f;
     float avgFPS = 0.0f;
     unsigned long countFPS = 1;
+    float frameTime = 0.0f;
     while( !glfwWindowShouldClose( window ) )
     {
-        float currentFrame = static_cast<float>( glfwGetTime() );
-        deltaTime = currentFrame - lastFrame;
+        // The clocks stay in double precision, a float one loses milliseconds after a few hours
+        double currentFrame = glfwGetTime();
+        deltaTime = static_cast<float>( currentFrame - lastFrame );
         lastFrame = currentFrame;
+        const double waveTime = currentFrame + clockOffsets[ clockOffset ];
         frameCount++;
         if( frameCount % 60 == 59 )
         {
@@ -387,51 +889,504 @@ int main()
             sumFPS = 0.0f;
         }
         sumFPS += 1.0f / deltaTime;
+        frameTime = frameTime * 0.95f + deltaTime * 1000.0f * 0.05f;
 
         move( window );
-        glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+        // Everything kept in world coordinates follows a move of the origin, the rest is rebuilt every frame
+        const glm::dvec2 previousOrigin = cam.getOrigin();
+        if( floatingOrigin )
+            cam.rebase( ORIGIN_STEP );
+        else
+            cam.setOrigin( glm::dvec2( 0.0 ) );
+        const glm::dvec2 worldOrigin = cam.getOrigin();
+        if( worldOrigin != previousOrigin && wake )
+            wake->rebase( glm::vec2( worldOrigin - previousOrigin ) );
+        spray.setOrigin( worldOrigin );
+
+        SpectrumParameters spectrumParameters;
+        spectrumParameters.type = static_cast< SpectrumType >( spectrumType );
+        // The LOD measurement overrides the wave count while it runs
+        const unsigned int activeWaves = lodBenchStep >= 0 ? lodBenchWaveCounts[ lodBenchStep / 2 ] : numWaves;
+        const bool activeLOD = lodBenchStep >= 0 ? lodBenchStep % 2 == 1 : waveLOD;
+        spectrumParameters.waveCount = activeWaves;
+        spectrumParameters.amplitude = amplitude;
+        spectrumParameters.frequency = frequency;
+        spectrumParameters.speed = speed;
+        spectrumParameters.amplitudeDecay = amplDecay;
+        spectrumParameters.frequencyIncrease = waveLenIncrease;
+        spectrumParameters.directionFactor = k;
+        spectrumParameters.windSpeed = spectrumWindSpeed;
+        spectrum.setParameters( spectrumParameters );
+        waveTable.update( spectrum );
+
+        SimulationSettings simulationSettings;
+        // The export keeps the CPU ocean running whatever the mode displayed
+        simulationSettings.oceanEnabled = waveMode == FFT_CPU || exportEnabled;
+        simulationSettings.amplitude = amplitude;
+        simulationSettings.windSpeed = windSpeed;
+        simulationSettings.choppiness = choppiness;
+        simulationSettings.speed = speed;
+        simulationSettings.timeOffset = clockOffsets[ clockOffset ];
+        if( exportEnabled )
+            simulationSettings.exportPath = EXPORT_PATH;
+        simulation.setSettings( simulationSettings );
+        waveTable.bind( 3 );
+        wavePhases.advance( spectrum.getWaves(), waveTime, worldOrigin );
+        waveTable.updatePhases( wavePhases.getPhases() );
+        waveTable.bindPhases( 5 );
+
+        if( waveMode == FFT_GPU )
+        {
+            ocean->setSpectrum( amplitude, windSpeed, glm::vec2( 1.0f, 0.0f ) );
+            ocean->setChoppiness( choppiness );
+            ocean->update( waveTime * speed );
+            ocean->bindMaps( 1, 2 );
+        }
+        else if( waveMode == FFT_CPU )
+        {
+            if( simulation.interpolate( cpuDisplacement, cpuNormals ) )
+            {
+                cpuDisplacementMap.upload( &cpuDisplacement[0].x );
+                cpuNormalMap.upload( &cpuNormals[0].x );
+            }
+            cpuDisplacementMap.bind( 1 );
+            cpuNormalMap.bind( 2 );
+        }
+        else if( waveMode == BAKED )
+        {
+            baked.update( spectrum, currentFrame );
+            baked.bind( 4 );
+        }
+        glm::vec3 camPos = cam.getPosition();
+        // The measurements of the vertex stage keep the sum of waves in it
+        const bool useComputeWaves = computeWaves && computeWavesEnabled && waveMode == SUM_OF_SINES && lodBenchStep < 0 && mathBenchStep < 0 && meshBenchStep < 0;
+        // The mesh comparison overrides the mesh and the detail map while it runs
+        int activeMesh = waterMesh;
+        if( meshBenchStep >= 0 )
+            activeMesh = meshBenchStep / 2 < WATER_GRID_COUNT ? meshBenchStep / 2 + 1 : WATER_MESH_CLIPMAP;
+        const bool useProjectedGrid = activeMesh == WATER_MESH_PROJECTED;
+        const bool useClipmap = activeMesh == WATER_MESH_CLIPMAP;
+        const bool useQuadtree = activeMesh == WATER_MESH_QUADTREE;
+        const bool useGpuTiles = useQuadtree && gpuQuadtree && gpuTilesEnabled;
+        const bool useTessellation = activeMesh == WATER_MESH_TESSELLATED && waterPatches;
+        ProjectedGrid & projectedGrid = projectedGrids[ projectedGridIndex ];
+        const Model * waterModel = nullptr;
+        if( useProjectedGrid )
+            waterModel = &projectedGrid.getModel();
+        else if( !useClipmap && !useQuadtree && !useTessellation )
+            waterModel = activeMesh == 0 ? &water : &waterGrids[ activeMesh - 1 ];
+        if( useClipmap )
+            clipmap.update( camPos );
+        if( useTessellation )
+            waterPatches->update( camPos );
 
         glm::mat4 view = cam.getViewMat();
         glm::mat4 projection = glm::mat4( 1.0f );
-        projection = glm::perspective( glm::radians( cam.getFov() ), (float)W_WIDTH / (float)W_HEIGHT, NEAR_PLANE, FAR_PLANE );
-
-        waterShader.activate();
-        waterShader.setMat4( "view", view );
-        waterShader.setMat4( "projection", projection );
-        waterShader.setInt( "numWaves", numWaves );
-        waterShader.setFloat( "time", currentFrame );
-        waterShader.setFloat( "amplitude", amplitude );
-        waterShader.setFloat( "frequency", frequency );
-        waterShader.setFloat( "speed", speed );
-        waterShader.setFloat( "ADecay", amplDecay );
-        waterShader.setFloat( "wIncrease", waveLenIncrease );
-        waterShader.setFloat( "kFactor", k );
-        glm::vec3 camPos = cam.getPosition();
-        waterShader.setVec3( "viewPos", camPos );
-        waterShader.setVec3( "fogColor", fogColor );
-        waterShader.setFloat( "fogStart", fogStart );
-        waterShader.setFloat( "fogEnd", fogEnd );
-        waterShader.setFloat( "gamma", gammaCorrection );
-        waterShader.setFloat( "ambientStrength", ambient );
-        waterShader.setFloat( "shininess", shininess );
-        waterShader.setFloat( "fresnelStrength", fresnel );
-
-        water.draw( waterShader );
-
-        glDepthFunc( GL_LEQUAL );
-        view = glm::mat4( glm::mat3( cam.getViewMat() ) ); // remove translation from the view matrix
-        skyboxShader.activate();
-        skyboxShader.setMat4( "view", view );
-        skyboxShader.setMat4( "projection", projection );
-        skyboxShader.setVec3( "fogColor", fogColor );
-        skyboxShader.setFloat( "fogHeight", fogHeight );
-        skyboxShader.setFloat( "gamma", gammaCorrection );
-
-        glBindVertexArray( skyboxVAO );
-        glActiveTexture( GL_TEXTURE0 );
-        glBindTexture( GL_TEXTURE_CUBE_MAP, skyTextID );
-        glDrawArrays( GL_TRIANGLES, 0, 36 );
-        glDepthFunc( GL_LESS );
+        const bool useReversedDepth = reversedDepth && reversedDepthEnabled;
+        if( useReversedDepth )
+            projection = ReversedDepth::perspective( glm::radians( cam.getFov() ), (float)W_WIDTH / (float)W_HEIGHT, NEAR_PLANE, REVERSED_FAR_PLANE );
+        else
+            projection = glm::perspective( glm::radians( cam.getFov() ), (float)W_WIDTH / (float)W_HEIGHT, NEAR_PLANE, FAR_PLANE );
+        // Nearer is greater with the reversed depth
+        const GLenum depthLess = useReversedDepth ? GL_GREATER : GL_LESS;
+        const GLenum depthLessEqual = useReversedDepth ? GL_GEQUAL : GL_LEQUAL;
+
+        bool drawWater = true;
+        float waveHeight = 0.0f;
+        if( useProjectedGrid || useQuadtree || useTessellation )
+        {
+            // Highest crest the meshes fitted to the view leave room for : the sum of the amplitudes of the waves,
+            // or the significant height of a fully developed sea for the spectral ocean
+            waveHeight = 0.22f * windSpeed * windSpeed / 9.81f;
+            if( waveMode == SUM_OF_SINES || waveMode == BAKED )
+            {
+                waveHeight = 0.0f;
+                const std::vector< WaveComponent > & waves = spectrum.getWaves();
+                for( size_t i = 0; i < std::min< size_t >( activeWaves, waves.size() ); i++ )
+                    waveHeight += std::abs( waves[i].amplitude );
+            }
+            if( useProjectedGrid )
+                drawWater = projectedGrid.update( view, projection, camPos, FAR_PLANE, waveHeight );
+            else if( useGpuTiles )
+                gpuQuadtree->update( projection * view, camPos, waveHeight );
+            else if( useQuadtree )
+                quadtree.update( projection * view, camPos, FAR_PLANE, waveHeight );
+        }
+        float meshSpacing = 0.0f;
+        if( useProjectedGrid )
+            meshSpacing = projectedGrid.getSpacing();
+        else if( useClipmap )
+            meshSpacing = clipmap.getCellSize();
+        else if( useQuadtree )
+            meshSpacing = quadtree.getCellSize();
+        else if( useTessellation )
+            meshSpacing = waterPatches->getMinSpacing();
+        else
+            meshSpacing = waterModel->getSpacing();
+        const bool activeDetail = detailNormals && ( meshBenchStep >= 0 ? meshBenchStep % 2 == 1 : detailEnabled );
+        // Waves the mesh can follow stay in the vertex stage, the shorter ones go to the detail map
+        int vertexWaves = activeWaves;
+        if( activeDetail && waveMode == SUM_OF_SINES )
+            vertexWaves = detailNormals->firstDetailWave( spectrum.getWaves(), activeWaves, meshSpacing );
+        const bool useDetail = vertexWaves < static_cast< int >( activeWaves );
+        if( useDetail )
+        {
+            detailTimer.begin();
+            detailNormals->update( vertexWaves, activeWaves, 3, 5, glm::vec2( worldOrigin ) );
+            detailTimer.end();
+            detailNormals->bind( 7 );
+        }
+        if( useComputeWaves )
+        {
+            computeTimer.begin();
+            computeWaves->update( vertexWaves, 3, 5, glm::vec2( camPos.x, camPos.z ) );
+            computeTimer.end();
+            computeWaves->bindMaps( 1, 2 );
+        }
+        if( wake && wakeEnabled )
+        {
+            wake->setCenter( glm::vec2( camPos.x, camPos.z ) );
+            if( boatEnabled )
+            {
+                const float angle = static_cast< float >( currentFrame ) * BOAT_SPEED / BOAT_RADIUS;
+                // The boat circles the world origin
+                wake->addSource( glm::vec2( glm::dvec2( std::cos( angle ), std::sin( angle ) ) * static_cast< double >( BOAT_RADIUS ) - worldOrigin ), 1.5f, -2.0f );
+            }
+            // Splash where the view ray meets the rest plane
+            const glm::vec3 front = cam.getFront();
+            if( splashRequested && front.y < 0.0f && -camPos.y / front.y < 100.0f )
+            {
+                const glm::vec3 hit = camPos - front * ( camPos.y / front.y );
+                wake->addSource( glm::vec2( hit.x, hit.z ), 2.0f, -4.0f, 0.2f );
+            }
+            wake->update( deltaTime );
+            wake->bind( 6 );
+        }
+        splashRequested = false;
+        // The crests are those of the sum of waves, the spray pauses in the spectral modes
+        const bool sprayActive = sprayEnabled && ( waveMode == SUM_OF_SINES || waveMode == BAKED );
+        if( sprayActive )
+        {
+            SprayParameters sprayParameters;
+            sprayParameters.steepness = sprayThreshold;
+            sprayParameters.wind = spectrumParameters.windDirection * spectrumWindSpeed;
+            spray.setParameters( sprayParameters );
+            spray.setWaves( spectrum );
+            spray.setCenter( glm::vec2( camPos.x, camPos.z ) );
+            auto sprayStart = std::chrono::steady_clock::now();
+            spray.emit( waveTime, deltaTime, wavePhases.getPhases() );
+            auto sprayEmitted = std::chrono::steady_clock::now();
+            spray.update( deltaTime );
+            std::chrono::duration< float, std::milli > emitTime = sprayEmitted - sprayStart;
+            std::chrono::duration< float, std::milli > updateTime = std::chrono::steady_clock::now() - sprayEmitted;
+            sprayEmitMilliseconds = sprayEmitMilliseconds * 0.95f + emitTime.count() * 0.05f;
+            sprayUpdateMilliseconds = sprayUpdateMilliseconds * 0.95f + updateTime.count() * 0.05f;
+            sprayRenderer.upload( spray.getPool() );
+        }
+
+        // The live sum of waves is drawn until the bake of the current parameters is uploaded
+        const bool playBaked = waveMode == BAKED && baked.isReady();
+        const float activeFogStart = horizonEnabled ? fogStart * HORIZON_FOG_SCALE : fogStart;
+        const float activeFogEnd = horizonEnabled ? fogEnd * HORIZON_FOG_SCALE : fogEnd;
+        const glm::vec2 meshFade = horizonEnabled ? glm::vec2( HORIZON_FADE_START, HORIZON_FADE_END ) * FAR_PLANE : glm::vec2( 0.0f );
+
+        if( useReversedDepth )
+            reversedDepth->begin();
+        glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+        // The same uniforms feed the drawn program and the probe ones, the probe evaluates its own points
+        auto setWaterUniforms = [&]( const Shader & shader, bool onWaterMesh = true )
+        {
+            shader.activate();
+            shader.setMat4( "view", view );
+            shader.setMat4( "projection", projection );
+            shader.setInt( "numWaves", vertexWaves );
+            shader.setInt( "waveTable", 3 );
+            shader.setInt( "wavePhases", 5 );
+            shader.setVec3( "viewPos", camPos );
+            shader.setVec3( "fogColor", fogColor );
+            shader.setFloat( "fogStart", activeFogStart );
+            shader.setFloat( "fogEnd", activeFogEnd );
+            shader.setFloat( "gamma", gammaCorrection );
+            shader.setVec2( "meshFade", meshFade.x, meshFade.y );
+            shader.setFloat( "ambientStrength", ambient );
+            shader.setFloat( "shininess", shininess );
+            shader.setFloat( "fresnelStrength", fresnel );
+            shader.setInt( "waveMode", playBaked ? 2 : ( waveMode == FFT_GPU || waveMode == FFT_CPU ? 1 : ( useComputeWaves ? 3 : 0 ) ) );
+            shader.setInt( "displacementMap", 1 );
+            shader.setInt( "normalMap", 2 );
+            shader.setInt( "bakedWaves", 4 );
+            shader.setFloat( "bakedCycle", baked.getCycle( waveTime ) );
+            shader.setFloat( "lodPixels", activeLOD ? lodPixels : 0.0f );
+            shader.setFloat( "lodScale", W_HEIGHT / ( 2.0f * std::tan( glm::radians( cam.getFov() ) * 0.5f ) ) );
+            shader.setBool( "clipmap", useClipmap && onWaterMesh );
+            shader.setBool( "quadtree", useQuadtree && onWaterMesh );
+            shader.setInt( "tileCells", QUADTREE_TILE_CELLS );
+            shader.setFloat( "pixelsPerTriangle", pixelsPerTriangle );
+            shader.setFloat( "waveHeight", waveHeight );
+            if( useTessellation )
+                waterPatches->setUniforms( shader );
+            shader.setBool( "wakeEnabled", wake && wakeEnabled );
+            shader.setInt( "wakeField", 6 );
+            shader.setBool( "detailEnabled", useDetail );
+            shader.setInt( "detailMap", 7 );
+            if( detailNormals )
+                shader.setFloat( "detailSize", detailNormals->getTileSize() );
+            if( computeWaves )
+            {
+                glm::vec2 mapOrigin = computeWaves->getOrigin();
+                shader.setVec2( "mapOrigin", mapOrigin );
+                shader.setFloat( "mapSize", computeWaves->getSize() );
+            }
+            if( wake )
+            {
+                glm::vec2 wakeOrigin = wake->getOrigin();
+                shader.setVec2( "wakeOrigin", wakeOrigin );
+                shader.setFloat( "wakeSize", wake->getSize() );
+            }
+            if( useProjectedGrid && onWaterMesh )
+                projectedGrid.setUniforms( shader );
+            else
+                shader.setBool( "projectedGrid", false );
+            if( waveMode == BAKED )
+                shader.setFloat( "patchSize", baked.getTileSize() );
+            else
+                shader.setFloat( "patchSize", waveMode == FFT_GPU ? ocean->getPatchSize() : simulation.getPatchSize() );
+        };
+        // The clipmap and the quadtree draw their own instances, the patches are tessellated, the other meshes are models
+        auto drawWaterMesh = [&]( Shader & shader )
+        {
+            if( useTessellation )
+                waterPatches->draw();
+            else if( useClipmap )
+                clipmap.draw();
+            else if( useGpuTiles )
+                gpuQuadtree->draw();
+            else if( useQuadtree )
+                quadtree.draw();
+            else
+                waterModel->draw( shader );
+        };
+        auto captureWaterMesh = [&]()
+        {
+            if( useClipmap )
+                clipmap.capture();
+            else if( useGpuTiles )
+                gpuQuadtree->capture();
+            else if( useQuadtree )
+                quadtree.capture();
+            else
+                waterModel->capture();
+        };
+        auto drawCapturedWaterMesh = [&]()
+        {
+            if( useClipmap )
+                clipmap.drawCaptured();
+            else if( useGpuTiles )
+                gpuQuadtree->drawCaptured();
+            else if( useQuadtree )
+                quadtree.drawCaptured();
+            else
+                waterModel->drawCaptured();
+        };
+        // Last when nothing lies under the water, so it only fills the pixels left. The far field goes under the
+        // water instead, the sky is drawn first then and the sea over it out to the horizon
+        auto drawSkybox = [&]()
+        {
+            glDepthFunc( depthLessEqual );
+            glm::mat4 skyView = glm::mat4( glm::mat3( view ) ); // remove translation from the view matrix
+            skyboxShader.activate();
+            skyboxShader.setMat4( "view", skyView );
+            skyboxShader.setMat4( "projection", projection );
+            skyboxShader.setVec3( "fogColor", fogColor );
+            skyboxShader.setFloat( "fogHeight", fogHeight );
+            skyboxShader.setFloat( "gamma", gammaCorrection );
+            skyboxShader.setBool( "reversedDepth", useReversedDepth );
+
+            glBindVertexArray( skyboxVAO );
+            glActiveTexture( GL_TEXTURE0 );
+            glBindTexture( GL_TEXTURE_CUBE_MAP, skyTextID );
+            glDrawArrays( GL_TRIANGLES, 0, 36 );
+            glDepthFunc( depthLess );
+        };
+        // The tier comparison overrides the selected tier while it runs
+        const int activeTier = mathBenchStep >= 0 ? mathBenchStep : mathTier;
+        Shader & waterShader = useTessellation ? *tessellatedShaders[ activeTier ] : waterShaders[ activeTier ];
+        // The tessellated surface is generated in every pass, it is too dense to be captured
+        const bool cacheSurface = surfaceCache && !useTessellation;
+
+        // Each pass is timed on its own, the averages shown are refreshed every PASS_TIMING_FRAMES frames
+        if( mathBenchStep >= 0 ? mathBenchFrame == 0 : ( meshBenchStep >= 0 ? meshBenchFrame == 0 : frameCount % PASS_TIMING_FRAMES == 0 ) )
+        {
+            for( int i = 0; i < WATER_PASS_COUNT; i++ )
+            {
+                passMilliseconds[i] = passTimers[i].getMilliseconds();
+                passTimers[i].reset();
+            }
+            computeMilliseconds = computeTimer.getMilliseconds();
+            computeTimer.reset();
+            detailMilliseconds = detailTimer.getMilliseconds();
+            detailTimer.reset();
+        }
+        if( cacheSurface && drawWater )
+        {
+            setWaterUniforms( captureShaders[ activeTier ] );
+            passTimers[ PASS_CAPTURE ].begin();
+            captureWaterMesh();
+            passTimers[ PASS_CAPTURE ].end();
+        }
+        if( horizonEnabled )
+        {
+            drawSkybox();
+            setWaterUniforms( horizon.getShader(), false );
+            horizon.draw( view, projection, activeWaves, meshFade.x, meshFade.y );
+        }
+        if( depthPrepass && drawWater )
+        {
+            Shader & depthShader = cacheSurface ? cachedDepthShader : ( useTessellation ? *tessellatedDepthShaders[ activeTier ] : depthShaders[ activeTier ] );
+            setWaterUniforms( depthShader );
+            glColorMask( GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE );
+            passTimers[ PASS_DEPTH ].begin();
+            if( cacheSurface )
+                drawCapturedWaterMesh();
+            else
+                drawWaterMesh( depthShader );
+            passTimers[ PASS_DEPTH ].end();
+            glColorMask( GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE );
+            // Only the nearest water fragments pass, shaded once
+            glDepthFunc( depthLessEqual );
+        }
+        Shader & colorShader = cacheSurface ? cachedShaders[ activeTier ] : waterShader;
+        if( drawWater )
+        {
+            setWaterUniforms( colorShader );
+            passTimers[ PASS_COLOR ].begin();
+            if( useTessellation )
+                primitiveCounter.begin();
+            if( cacheSurface )
+                drawCapturedWaterMesh();
+            else
+                drawWaterMesh( colorShader );
+            if( useTessellation )
+                primitiveCounter.end();
+            passTimers[ PASS_COLOR ].end();
+        }
+        glDepthFunc( depthLess );
+
+        if( mathBenchStep >= 0 )
+        {
+            mathBenchFrameTime += deltaTime;
+            if( ++mathBenchFrame == MATH_BENCH_FRAMES )
+            {
+                float drawTime = 0.0f;
+                for( int i = 0; i < WATER_PASS_COUNT; i++ )
+                    drawTime += passTimers[i].getMilliseconds();
+                mathBenchDrawResults[ mathBenchStep ] = drawTime;
+                mathBenchFrameResults[ mathBenchStep ] = static_cast< float >( mathBenchFrameTime * 1000.0 / MATH_BENCH_FRAMES );
+                setWaterUniforms( captureShaders[ MATH_EXACT ], false );
+                setWaterUniforms( captureShaders[ mathBenchStep ], false );
+                mathBenchErrors[ mathBenchStep ] = probe.measure( captureShaders[ MATH_EXACT ], captureShaders[ mathBenchStep ], glm::vec2( camPos.x, camPos.z ) );
+                mathBenchFrame = 0;
+                mathBenchFrameTime = 0.0;
+                if( ++mathBenchStep == MATH_TIER_COUNT )
+                {
+                    mathBenchStep = -1;
+                    mathBenchDone = true;
+                    std::cout << "Math tiers, " << activeWaves << " waves : water draw ms, frame ms, height error max / rms m, normal error max / rms degrees" << std::endl;
+                    for( int i = 0; i < MATH_TIER_COUNT; i++ )
+                        std::cout << mathTierNames[i] << " : " << mathBenchDrawResults[i] << ", " << mathBenchFrameResults[i] << ", "
+                                  << mathBenchErrors[i].maxHeight << " / " << mathBenchErrors[i].rmsHeight << ", "
+                                  << mathBenchErrors[i].maxNormal << " / " << mathBenchErrors[i].rmsNormal << std::endl;
+                }
+            }
+        }
+        // The error of the selected tier is measured against the exact path on the points around the camera
+        else if( mathTier != MATH_EXACT && waveMode == SUM_OF_SINES && frameCount % MATH_PROBE_PERIOD == 0 )
+        {
+            setWaterUniforms( captureShaders[ MATH_EXACT ], false );
+            setWaterUniforms( captureShaders[ mathTier ], false );
+            mathError = probe.measure( captureShaders[ MATH_EXACT ], captureShaders[ mathTier ], glm::vec2( camPos.x, camPos.z ) );
+        }
+
+        if( meshBenchStep >= 0 )
+        {
+            meshBenchFrameTime += deltaTime;
+            if( ++meshBenchFrame == MESH_BENCH_FRAMES )
+            {
+                float gpuTime = detailTimer.getMilliseconds();
+                for( int i = 0; i < WATER_PASS_COUNT; i++ )
+                    gpuTime += passTimers[i].getMilliseconds();
+                meshBenchGpuResults[ meshBenchStep ] = gpuTime;
+                meshBenchFrameResults[ meshBenchStep ] = static_cast< float >( meshBenchFrameTime * 1000.0 / MESH_BENCH_FRAMES );
+                meshBenchVertexWaves[ meshBenchStep ] = vertexWaves;
+                meshBenchFrame = 0;
+                meshBenchFrameTime = 0.0;
+                if( ++meshBenchStep == MESH_BENCH_STEPS )
+                {
+                    meshBenchStep = -1;
+                    meshBenchDone = true;
+                    std::cout << "Water meshes, " << activeWaves << " waves : vertices, waves in the vertex stage, frame ms, water GPU ms ( vertex stage only, then with the detail map )" << std::endl;
+                    for( int i = 0; i < MESH_BENCH_MESHES; i++ )
+                    {
+                        if( i < WATER_GRID_COUNT )
+                            std::cout << waterGrids[i].getVertexCount() << " : ";
+                        else
+                            std::cout << "clipmap " << clipmap.getVertexCount() << " : ";
+                        for( int detail = 0; detail < 2; detail++ )
+                            std::cout << meshBenchVertexWaves[ i * 2 + detail ] << ", " << meshBenchFrameResults[ i * 2 + detail ] << ", " << meshBenchGpuResults[ i * 2 + detail ] << ( detail ? "\n" : " / " );
+                    }
+                    std::cout << std::flush;
+                }
+            }
+        }
+
+        if( lodBenchStep >= 0 )
+        {
+            // Same draw again without rasterization, so only the vertex stage is timed
+            if( lodBenchFrame == 0 )
+                lodTimer.reset();
+            setWaterUniforms( waterShader );
+            glEnable( GL_RASTERIZER_DISCARD );
+            lodTimer.begin();
+            drawWaterMesh( waterShader );
+            lodTimer.end();
+            glDisable( GL_RASTERIZER_DISCARD );
+            if( ++lodBenchFrame == LOD_BENCH_FRAMES )
+            {
+                lodBenchResults[ lodBenchStep ] = lodTimer.getMilliseconds();
+                lodBenchFrame = 0;
+                if( ++lodBenchStep == LOD_BENCH_STEPS )
+                {
+                    lodBenchStep = -1;
+                    lodBenchDone = true;
+                    std::cout << "Vertex stage, ms, LOD off / on ( " << lodPixels << " px )" << std::endl;
+                    for( int i = 0; i < LOD_BENCH_STEPS / 2; i++ )
+                        std::cout << lodBenchWaveCounts[i] << " waves : " << lodBenchResults[ i * 2 ] << " / " << lodBenchResults[ i * 2 + 1 ] << std::endl;
+                }
+            }
+        }
+
+        if( !horizonEnabled )
+            drawSkybox();
+
+        if( sprayActive )
+        {
+            Shader & sprayShader = sprayRenderer.getShader();
+            glm::mat4 sprayView = cam.getViewMat();
+            sprayShader.activate();
+            sprayShader.setMat4( "view", sprayView );
+            sprayShader.setMat4( "projection", projection );
+            sprayShader.setInt( "numWaves", std::min( activeWaves, static_cast< unsigned int >( SPRAY_FOAM_WAVES ) ) );
+            sprayShader.setInt( "waveTable", 3 );
+            sprayShader.setInt( "wavePhases", 5 );
+            sprayShader.setFloat( "spraySize", 0.08f );
+            sprayShader.setFloat( "foamSize", 0.35f );
+            sprayShader.setVec3( "fogColor", fogColor );
+            sprayShader.setFloat( "fogStart", activeFogStart );
+            sprayShader.setFloat( "fogEnd", activeFogEnd );
+            sprayShader.setFloat( "gamma", gammaCorrection );
+            sprayRenderer.draw();
+        }
 
         if( displayHUD )
         {
@@ -440,9 +1395,137 @@ int main()
             hud.renderText( "Ambient Strength : " + std::to_string( ambient ) + "\nShininess : " + std::to_string( shininess ) + "\nFresnel Strength : " + std::to_string( fresnel ) + "\nGamma Correction : " + std::to_string( gammaCorrection ) + "\nFog Start : " + std::to_string( fogStart ) + "\nFog End : " + std::to_string( fogEnd ) + "\nFog Height : " + std::to_string( fogHeight ),
                             W_WIDTH * 0.85f, W_HEIGHT * 0.9f, 0.08f, textColor );
             hud.renderText( "FPS : " + std::to_string( (int)avgFPS / countFPS ), W_WIDTH * 0.9f, W_HEIGHT * 0.01f, 0.08f, textColor );
-            hud.renderText( "Current position : " + std::to_string( camPos.x ) + " " + std::to_string( camPos.y ) + " " + std::to_string( camPos.z ), W_WIDTH * 0.01f, W_HEIGHT * 0.01f, 0.08f, textColor );
+            hud.renderText( "Wave mode : " + std::string( waveModeNames[ waveMode ] ) + "\nFrame time : " + std::to_string( frameTime ) + " ms", W_WIDTH * 0.01f, W_HEIGHT * 0.6f, 0.08f, textColor );
+            if( waveMode == SUM_OF_SINES )
+            {
+                std::string path = computeWaves ? ( computeWavesEnabled ? "compute maps, " + std::to_string( computeMilliseconds ) + " ms" : "vertex stage" ) : "vertex stage ( no GL 4.3 )";
+                hud.renderText( "Wave LOD : " + std::string( waveLOD ? "on, " + std::to_string( lodPixels ) + " px" : "off" ) + "\nWave path : " + path, W_WIDTH * 0.01f, W_HEIGHT * 0.45f, 0.08f, textColor );
+            }
+            if( lodBenchStep >= 0 )
+                hud.renderText( "Measuring the vertex stage : " + std::to_string( lodBenchWaveCounts[ lodBenchStep / 2 ] ) + " waves, LOD " + ( lodBenchStep % 2 ? "on" : "off" ), W_WIDTH * 0.01f, W_HEIGHT * 0.3f, 0.08f, textColor );
+            else if( lodBenchDone )
+            {
+                std::string results = "Vertex stage ms, LOD off / on";
+                for( int i = 0; i < LOD_BENCH_STEPS / 2; i++ )
+                    results += "\n" + std::to_string( lodBenchWaveCounts[i] ) + " waves : " + std::to_string( lodBenchResults[ i * 2 ] ) + " / " + std::to_string( lodBenchResults[ i * 2 + 1 ] );
+                hud.renderText( results, W_WIDTH * 0.01f, W_HEIGHT * 0.3f, 0.08f, textColor );
+            }
+            if( waveMode == SUM_OF_SINES || waveMode == BAKED )
+                hud.renderText( "Spectrum : " + std::string( WaveSpectrum::getTypeName( static_cast< SpectrumType >( spectrumType ) ) ) + "\nWind Speed : " + std::to_string( spectrumWindSpeed ), W_WIDTH * 0.01f, W_HEIGHT * 0.5f, 0.08f, textColor );
+            if( waveMode == FFT_GPU || waveMode == FFT_CPU )
+                hud.renderText( "Wind Speed : " + std::to_string( windSpeed ) + "\nChoppiness : " + std::to_string( choppiness ), W_WIDTH * 0.01f, W_HEIGHT * 0.5f, 0.08f, textColor );
+            if( waveMode == FFT_CPU )
+                hud.renderText( "Simulation : " + std::to_string( static_cast< int >( simulation.getTickRate() ) ) + " Hz, " + std::to_string( simulation.getTickTime() ) + " ms per tick\nDropped ticks : " + std::to_string( simulation.getDroppedTicks() ),
+                                W_WIDTH * 0.01f, W_HEIGHT * 0.4f, 0.08f, textColor );
+            if( waveMode == BAKED )
+            {
+                std::string status = baked.isBaking() ? "baking " + std::to_string( static_cast< int >( baked.getProgress() * 100.0f ) ) + " %, live meanwhile" : ( baked.isReady() ? "playing" : "waiting for the parameters to settle" );
+                hud.renderText( "Bake : " + status + "\nBake memory : " + std::to_string( baked.getMemorySize() / ( 1024 * 1024 ) ) + " MB\nLast bake time : " + std::to_string( baked.getBakeTime() ) + " s", W_WIDTH * 0.01f, W_HEIGHT * 0.4f, 0.08f, textColor );
+            }
+            if( clockOffset > 0 )
+            {
+                // Step between two consecutive float values at the current clock, what the old float time base was limited to
+                const float floatTime = static_cast< float >( waveTime );
+                hud.renderText( "Clock offset : " + std::string( clockOffsetNames[ clockOffset ] ) + "\nFloat clock step : " + std::to_string( ( std::nextafter( floatTime, INFINITY ) - floatTime ) * 1000.0f ) + " ms",
+                                W_WIDTH * 0.85f, W_HEIGHT * 0.6f, 0.08f, textColor );
+            }
+            if( wake )
+                hud.renderText( "Wake : " + std::string( wakeEnabled ? "on, " + std::to_string( wake->getResolution() ) + " x " + std::to_string( wake->getResolution() ) + " cells over " + std::to_string( static_cast< int >( wake->getSize() ) ) + " m" : "off" ) + "\nBoat : " + ( boatEnabled ? "on" : "off" ),
+                                W_WIDTH * 0.85f, W_HEIGHT * 0.45f, 0.08f, textColor );
+            hud.renderText( "Horizon : " + std::string( horizonEnabled ? "far field past " + std::to_string( static_cast< int >( meshFade.x ) ) + " m, " + std::to_string( std::min( horizon.getWaveCount(), static_cast< int >( activeWaves ) ) ) + " waves per pixel\nFog : " + std::to_string( static_cast< int >( activeFogStart ) ) + " to " + std::to_string( static_cast< int >( activeFogEnd ) ) + " m" : "off" ) +
+                            "\nDepth : " + ( useReversedDepth ? "reversed float, far plane " + std::to_string( static_cast< int >( REVERSED_FAR_PLANE ) ) + " m" : std::string( reversedDepth ? "standard" : "standard ( no clip control )" ) + ", far plane " + std::to_string( static_cast< int >( FAR_PLANE ) ) + " m" ),
+                            W_WIDTH * 0.85f, W_HEIGHT * 0.36f, 0.08f, textColor );
+            std::string passText = "Water passes, GPU ms : " + std::string( cacheSurface ? "cached surface" : "direct" );
+            for( int i = 0; i < WATER_PASS_COUNT; i++ )
+            {
+                if( ( i == PASS_CAPTURE && !cacheSurface ) || ( i == PASS_DEPTH && !depthPrepass ) )
+                    continue;
+                passText += "\n" + std::string( waterPassNames[i] ) + " : " + std::to_string( passMilliseconds[i] );
+            }
+            hud.renderText( passText, W_WIDTH * 0.4f, W_HEIGHT * 0.9f, 0.08f, textColor );
+            if( exportEnabled )
+                hud.renderText( "Export : " + std::string( simulation.hasExportFailed() ? "failed" : std::string( EXPORT_PATH ) + ", " + std::to_string( simulation.getExportedFrames() ) + " frames, " + std::to_string( simulation.getExportTime() ) + " ms per frame" ),
+                                W_WIDTH * 0.4f, W_HEIGHT * 0.75f, 0.08f, textColor );
+            std::string meshName = useProjectedGrid ? "projected " + std::to_string( projectedGrid.getColumns() ) + " x " + std::to_string( projectedGrid.getRows() ) :
+                                   ( activeMesh == 0 ? "model file" : "grid " + std::to_string( WATER_GRID_CELLS[ activeMesh - 1 ] ) );
+            std::string levelText;
+            if( useClipmap )
+            {
+                meshName = "clipmap " + std::to_string( static_cast< int >( clipmap.getExtent() ) ) + " m";
+                levelText = "\nLevel vertices :";
+                for( int level = 0; level < clipmap.getLevelCount(); level++ )
+                    levelText += " " + std::to_string( clipmap.getLevelVertexCount( level ) );
+            }
+            else if( useTessellation )
+            {
+                meshName = "tessellated " + std::to_string( waterPatches->getPatchesAcross() ) + " x " + std::to_string( waterPatches->getPatchesAcross() ) + " patches";
+                levelText = "\nPrimitives : " + std::to_string( primitiveCounter.getCount() ) + ", target " + std::to_string( static_cast< int >( pixelsPerTriangle ) ) + " px per triangle";
+            }
+            else if( useGpuTiles )
+            {
+                // The selection is never read back, only the room for it is known
+                meshName = "quadtree";
+                levelText = "\nTiles : selected on the GPU, one indirect draw for " + std::to_string( gpuQuadtree->getLevelCount() ) + " levels";
+            }
+            else if( useQuadtree )
+            {
+                meshName = "quadtree";
+                levelText = "\nTiles : " + std::to_string( quadtree.getVisibleCount() ) + " drawn, " + std::to_string( quadtree.getCulledCount() ) + " culled, per level";
+                for( int level = 0; level < quadtree.getLevelCount(); level++ )
+                    levelText += " " + std::to_string( quadtree.getVisibleCount( level ) );
+            }
+            std::string detailText = useDetail ? std::to_string( activeWaves - vertexWaves ) + " of " + std::to_string( activeWaves ) + " waves, " + std::to_string( detailMilliseconds ) + " ms" : ( activeDetail ? "no wave short enough" : "off" );
+            unsigned int meshVertices = 0;
+            std::string vertexBound;
+            if( useClipmap )
+                meshVertices = clipmap.getVertexCount();
+            else if( useTessellation )
+                meshVertices = waterPatches->getVertexCount();
+            else if( useGpuTiles )
+            {
+                meshVertices = gpuQuadtree->getCapacity() * gpuQuadtree->getTileVertexCount();
+                vertexBound = "up to ";
+            }
+            else if( useQuadtree )
+                meshVertices = quadtree.getVertexCount();
+            else
+                meshVertices = waterModel->getVertexCount();
+            hud.renderText( "Water mesh : " + meshName + ", " + vertexBound + std::to_string( meshVertices ) + " vertices, " + std::to_string( meshSpacing ) + " m" + levelText + "\nDetail map : " + detailText,
+                            W_WIDTH * 0.4f, W_HEIGHT * 0.45f, 0.08f, textColor );
+            if( meshBenchStep >= 0 )
+                hud.renderText( "Measuring the " + ( useClipmap ? std::string( "clipmap" ) : std::to_string( WATER_GRID_CELLS[ meshBenchStep / 2 ] ) + " grid" ) + ", detail map " + ( meshBenchStep % 2 ? "on" : "off" ),
+                                W_WIDTH * 0.4f, W_HEIGHT * 0.3f, 0.08f, textColor );
+            else if( meshBenchDone )
+            {
+                // The GPU times are printed with the results, the HUD batches too few glyphs for both
+                std::string results = "Frame ms, detail off / on";
+                for( int i = 0; i < MESH_BENCH_MESHES; i++ )
+                    results += "\n" + std::to_string( i < WATER_GRID_COUNT ? waterGrids[i].getVertexCount() : clipmap.getVertexCount() ) + " : " + std::to_string( meshBenchFrameResults[ i * 2 ] ) + " / " + std::to_string( meshBenchFrameResults[ i * 2 + 1 ] );
+                hud.renderText( results, W_WIDTH * 0.4f, W_HEIGHT * 0.3f, 0.08f, textColor );
+            }
+            if( sprayEnabled )
+                hud.renderText( "Spray : " + std::string( sprayActive ? std::to_string( spray.getLiveCount() ) + " particles, " + std::to_string( spray.getCrestCount() ) + " crest points over " + std::to_string( sprayThreshold ) : "paused, sum of waves only" ) +
+                                "\nUpdate : " + std::to_string( sprayUpdateMilliseconds ) + " ms, emission : " + std::to_string( sprayEmitMilliseconds ) + " ms", W_WIDTH * 0.4f, W_HEIGHT * 0.6f, 0.08f, textColor );
+            std::string mathText = "Math tier : " + std::string( mathTierNames[ mathTier ] );
+            if( mathTier != MATH_EXACT && waveMode == SUM_OF_SINES )
+                mathText += "\nHeight error : " + std::to_string( mathError.maxHeight ) + " m\nNormal error : " + std::to_string( mathError.maxNormal ) + " deg";
+            hud.renderText( mathText, W_WIDTH * 0.85f, W_HEIGHT * 0.3f, 0.08f, textColor );
+            if( mathBenchStep >= 0 )
+                hud.renderText( "Measuring the " + std::string( mathTierNames[ mathBenchStep ] ) + " tier", W_WIDTH * 0.85f, W_HEIGHT * 0.15f, 0.08f, textColor );
+            else if( mathBenchDone )
+            {
+                std::string results = "draw ms, frame ms, m, deg";
+                for( int i = 0; i < MATH_TIER_COUNT; i++ )
+                    results += "\n" + std::string( mathTierNames[i] ) + " : " + std::to_string( mathBenchDrawResults[i] ) + ", " + std::to_string( mathBenchFrameResults[i] ) + ", " + std::to_string( mathBenchErrors[i].maxHeight ) + ", " + std::to_string( mathBenchErrors[i].maxNormal );
+                hud.renderText( results, W_WIDTH * 0.85f, W_HEIGHT * 0.15f, 0.08f, textColor );
+            }
+            const glm::dvec3 worldPosition = cam.getWorldPosition();
+            hud.renderText( "Current position : " + std::to_string( worldPosition.x ) + " " + std::to_string( worldPosition.y ) + " " + std::to_string( worldPosition.z ) + ", origin " +
+                            ( floatingOrigin ? std::to_string( static_cast< long long >( worldOrigin.x ) ) + " " + std::to_string( static_cast< long long >( worldOrigin.y ) ) : std::string( "fixed" ) ), W_WIDTH * 0.01f, W_HEIGHT * 0.01f, 0.08f, textColor );
         }
 
+        if( useReversedDepth )
+            reversedDepth->end();
         glfwSwapBuffers( window );
         glfwPollEvents();
     }
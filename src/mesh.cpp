@@ -1,5 +1,7 @@
 #include <mesh.hpp>
 #include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
 
 Mesh::Mesh( std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures ) noexcept :
     vertices( vertices ), indices( indices ), textures( textures )
@@ -38,6 +40,20 @@ Mesh::Mesh( std::vector<Vertex> vertices, std::vector<unsigned int> indices, std
     glEnableVertexAttribArray( 6 );
     glVertexAttribPointer( 6, 4, GL_FLOAT, GL_FALSE, sizeof( Vertex ), (void*)offsetof( Vertex, weights ) );
 
+    // captured vertices, drawn with the same indices
+    glGenBuffers( 1, &feedbackBuffer );
+    glGenVertexArrays( 1, &capturedVao );
+    glBindVertexArray( capturedVao );
+    glBindBuffer( GL_ARRAY_BUFFER, feedbackBuffer );
+    glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof( CapturedVertex ), nullptr, GL_DYNAMIC_COPY );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebo );
+    glEnableVertexAttribArray( 0 );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)0 );
+    glEnableVertexAttribArray( 1 );
+    glVertexAttribPointer( 1, 3, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)offsetof( CapturedVertex, normal ) );
+    glEnableVertexAttribArray( 2 );
+    glVertexAttribPointer( 2, 2, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)offsetof( CapturedVertex, uv ) );
+
     glBindVertexArray( 0 );
 }
 
@@ -83,4 +99,115 @@ void Mesh::draw( Shader & shader ) const noexcept
     glDrawElements( GL_TRIANGLES, static_cast<unsigned int>( indices.size() ), GL_UNSIGNED_INT, 0 );
     glBindVertexArray( 0 );
     glActiveTexture( GL_TEXTURE0 );
-}
\ No newline at end of file
+}
+
+void Mesh::capture() const noexcept
+{
+    // Every vertex once as a point, nothing reaches the rasterizer
+    glEnable( GL_RASTERIZER_DISCARD );
+    glBindVertexArray( vao );
+    glBindBufferBase( GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedbackBuffer );
+    glBeginTransformFeedback( GL_POINTS );
+    glDrawArrays( GL_POINTS, 0, static_cast<int>( vertices.size() ) );
+    glEndTransformFeedback();
+    glBindBufferBase( GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0 );
+    glBindVertexArray( 0 );
+    glDisable( GL_RASTERIZER_DISCARD );
+}
+
+void Mesh::drawCaptured() const noexcept
+{
+    glBindVertexArray( capturedVao );
+    glDrawElements( GL_TRIANGLES, static_cast<unsigned int>( indices.size() ), GL_UNSIGNED_INT, 0 );
+    glBindVertexArray( 0 );
+}
+
+Mesh Mesh::grid( int cells, float size ) noexcept
+{
+    cells = std::max( cells, 1 );
+    const int side = cells + 1;
+    std::vector<Vertex> vertices( static_cast<size_t>( side ) * side );
+    for( int j = 0; j < side; j++ )
+    {
+        for( int i = 0; i < side; i++ )
+        {
+            Vertex & vertex = vertices[ static_cast<size_t>( j ) * side + i ];
+            vertex = Vertex();
+            vertex.pos = glm::vec3( ( static_cast<float>( i ) / cells - 0.5f ) * size, 0.0f, ( static_cast<float>( j ) / cells - 0.5f ) * size );
+            vertex.normal = glm::vec3( 0.0f, 1.0f, 0.0f );
+            vertex.uv = glm::vec2( static_cast<float>( i ) / cells, static_cast<float>( j ) / cells );
+            vertex.tangent = glm::vec3( 1.0f, 0.0f, 0.0f );
+            vertex.bitangent = glm::vec3( 0.0f, 0.0f, 1.0f );
+        }
+    }
+    // Counter clockwise seen from above
+    std::vector<unsigned int> indices;
+    indices.reserve( static_cast<size_t>( cells ) * cells * 6 );
+    for( int j = 0; j < cells; j++ )
+    {
+        for( int i = 0; i < cells; i++ )
+        {
+            unsigned int corner = j * side + i;
+            indices.insert( indices.end(), { corner, corner + side, corner + 1, corner + 1, corner + side, corner + side + 1 } );
+        }
+    }
+    return Mesh( vertices, indices, std::vector<Texture>() );
+}
+
+Mesh Mesh::screenGrid( int columns, int rows ) noexcept
+{
+    columns = std::max( columns, 1 );
+    rows = std::max( rows, 1 );
+    const int side = columns + 1;
+    std::vector<Vertex> vertices( static_cast<size_t>( side ) * ( rows + 1 ) );
+    for( int j = 0; j <= rows; j++ )
+    {
+        for( int i = 0; i < side; i++ )
+        {
+            Vertex & vertex = vertices[ static_cast<size_t>( j ) * side + i ];
+            vertex = Vertex();
+            vertex.pos = glm::vec3( static_cast<float>( i ) / columns, static_cast<float>( j ) / rows, 0.0f );
+            vertex.normal = glm::vec3( 0.0f, 0.0f, 1.0f );
+            vertex.uv = glm::vec2( vertex.pos );
+            vertex.tangent = glm::vec3( 1.0f, 0.0f, 0.0f );
+            vertex.bitangent = glm::vec3( 0.0f, 1.0f, 0.0f );
+        }
+    }
+    // Counter clockwise on screen, x to the right and y up
+    std::vector<unsigned int> indices;
+    indices.reserve( static_cast<size_t>( columns ) * rows * 6 );
+    for( int j = 0; j < rows; j++ )
+    {
+        for( int i = 0; i < columns; i++ )
+        {
+            unsigned int corner = j * side + i;
+            indices.insert( indices.end(), { corner, corner + 1, corner + side, corner + side, corner + 1, corner + side + 1 } );
+        }
+    }
+    return Mesh( vertices, indices, std::vector<Texture>() );
+}
+
+unsigned int Mesh::getVertexCount() const noexcept
+{
+    return static_cast<unsigned int>( vertices.size() );
+}
+
+unsigned int Mesh::getTriangleCount() const noexcept
+{
+    return static_cast<unsigned int>( indices.size() / 3 );
+}
+
+float Mesh::getSpacing() const noexcept
+{
+    if( vertices.size() < 2 )
+        return 0.0f;
+    glm::vec2 low( vertices[0].pos.x, vertices[0].pos.z );
+    glm::vec2 high = low;
+    for( const Vertex & vertex : vertices )
+    {
+        low = glm::min( low, glm::vec2( vertex.pos.x, vertex.pos.z ) );
+        high = glm::max( high, glm::vec2( vertex.pos.x, vertex.pos.z ) );
+    }
+    glm::vec2 extent = high - low;
+    return std::sqrt( extent.x * extent.y / vertices.size() );
+}
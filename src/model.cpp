@@ -20,6 +20,10 @@ Model::Model( std::string path, bool gamma ) noexcept : gammaCorrection( gamma )
     processNode( scene->mRootNode, scene );
 }
 
+Model::Model( std::vector< Mesh > meshes ) noexcept : meshes( meshes ), gammaCorrection( false )
+{
+}
+
 void Model::draw( Shader & shader ) const noexcept
 {
     for( int i = 0; i < meshes.size(); i++ )
@@ -28,6 +32,54 @@ void Model::draw( Shader & shader ) const noexcept
     }
 }
 
+void Model::capture() const noexcept
+{
+    for( int i = 0; i < meshes.size(); i++ )
+    {
+        meshes[i].capture();
+    }
+}
+
+void Model::drawCaptured() const noexcept
+{
+    for( int i = 0; i < meshes.size(); i++ )
+    {
+        meshes[i].drawCaptured();
+    }
+}
+
+unsigned int Model::getVertexCount() const noexcept
+{
+    unsigned int count = 0;
+    for( int i = 0; i < meshes.size(); i++ )
+    {
+        count += meshes[i].getVertexCount();
+    }
+    return count;
+}
+
+unsigned int Model::getTriangleCount() const noexcept
+{
+    unsigned int count = 0;
+    for( int i = 0; i < meshes.size(); i++ )
+    {
+        count += meshes[i].getTriangleCount();
+    }
+    return count;
+}
+
+float Model::getSpacing() const noexcept
+{
+    float spacing = 0.0f;
+    for( int i = 0; i < meshes.size(); i++ )
+    {
+        float meshSpacing = meshes[i].getSpacing();
+        if( spacing == 0.0f || ( meshSpacing > 0.0f && meshSpacing < spacing ) )
+            spacing = meshSpacing;
+    }
+    return spacing;
+}
+
 void Model::processNode( aiNode * node, const aiScene * scene ) noexcept
 {
     // process all the node's meshes (if any)
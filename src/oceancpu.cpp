@@ -0,0 +1,266 @@
+#include <oceancpu.hpp>
+#include <fft.hpp>
+#include <wavephases.hpp>
+#include <glm/gtc/constants.hpp>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+#define TRANSPOSE_BLOCK 32
+
+float dispersion( float kLength ) noexcept
+{
+    const float step = static_cast< float >( glm::two_pi< double >() / OCEAN_PERIOD );
+    return std::floor( std::sqrt( GRAVITY * kLength ) / step ) * step;
+}
+
+double oceanCycle( double time ) noexcept
+{
+    const double cycle = std::fmod( time, OCEAN_PERIOD );
+    return cycle < 0.0 ? cycle + OCEAN_PERIOD : cycle;
+}
+
+std::vector< glm::vec4 > generateInitialSpectrum( int resolution, float patchSize, float amplitude, float windSpeed, glm::vec2 windDirection )
+{
+    // Phillips spectrum with gaussian random amplitudes, the seed is fixed so the sea looks the same on every run
+    std::mt19937 generator( 1337 );
+    std::normal_distribution< float > gaussian( 0.0f, 1.0f );
+
+    const float L = windSpeed * windSpeed / GRAVITY; // largest wave arising from the wind
+    const float l = L * 0.001f; // waves smaller than this are damped
+    std::vector< glm::vec2 > h0( resolution * resolution );
+    double variance = 0.0;
+    for( int z = 0; z < resolution; z++ )
+    {
+        for( int x = 0; x < resolution; x++ )
+        {
+            glm::vec2 k = glm::two_pi< float >() * glm::vec2( x - resolution / 2, z - resolution / 2 ) / patchSize;
+            float kLen = glm::length( k );
+            float phillips = 0.0f;
+            // The Nyquist row and column have no symmetric counterpart and would leak between the packed spectra
+            if( kLen > 1e-6f && x > 0 && z > 0 )
+            {
+                float kDotW = glm::dot( k / kLen, windDirection );
+                float kLen2 = kLen * kLen;
+                phillips = std::exp( -1.0f / ( kLen2 * L * L ) ) / ( kLen2 * kLen2 ) * kDotW * kDotW * std::exp( -kLen2 * l * l );
+                // Waves moving against the wind are mostly suppressed
+                if( kDotW < 0.0f )
+                    phillips *= 0.07f;
+            }
+            glm::vec2 value = glm::vec2( gaussian( generator ), gaussian( generator ) ) * std::sqrt( phillips * 0.5f );
+            h0[ z * resolution + x ] = value;
+            variance += glm::dot( value, value );
+        }
+    }
+
+    // Normalize so that "amplitude" is the root mean square height of the surface, independently of N and the patch size
+    float scale = variance > 0.0 ? amplitude * 0.5f / static_cast< float >( std::sqrt( 2.0 * variance ) ) : 0.0f;
+
+    // Store h0( k ) and conj( h0( -k ) ) side by side so the animation reads a single texel
+    std::vector< glm::vec4 > texels( resolution * resolution );
+    for( int z = 0; z < resolution; z++ )
+    {
+        for( int x = 0; x < resolution; x++ )
+        {
+            glm::vec2 h = h0[ z * resolution + x ] * scale;
+            glm::vec2 hMinus = h0[ ( ( resolution - z ) % resolution ) * resolution + ( resolution - x ) % resolution ] * scale;
+            texels[ z * resolution + x ] = glm::vec4( h.x, h.y, hMinus.x, -hMinus.y );
+        }
+    }
+    return texels;
+}
+
+OceanCPU::OceanCPU( int resolution, float patchSize, unsigned int threadCount ) : resolution( resolution ), patchSize( patchSize ), pool( threadCount )
+{
+    if( resolution < 2 || ( resolution & ( resolution - 1 ) ) != 0 )
+    {
+        throw std::runtime_error( "FFT resolution must be a power of two" );
+    }
+    // Builds the plan up front so the first frame does not pay for it
+    FFTPlan::get( resolution );
+
+    const size_t size = static_cast< size_t >( resolution ) * resolution;
+    omega.resize( size );
+    for( int z = 0; z < resolution; z++ )
+    {
+        for( int x = 0; x < resolution; x++ )
+        {
+            glm::vec2 k = glm::two_pi< float >() * glm::vec2( x - resolution / 2, z - resolution / 2 ) / patchSize;
+            omega[ z * resolution + x ] = dispersion( glm::length( k ) );
+        }
+    }
+    for( int i = 0; i < FIELD_COUNT; i++ )
+    {
+        fieldRe[i].resize( size );
+        fieldIm[i].resize( size );
+        scratchRe[i].resize( size );
+        scratchIm[i].resize( size );
+    }
+    displacement.resize( size );
+    normals.resize( size );
+
+    setSpectrum( 1.0f, 20.0f, glm::vec2( 1.0f, 0.0f ) );
+}
+
+void OceanCPU::setSpectrum( float amplitude, float windSpeed, glm::vec2 windDirection ) noexcept
+{
+    windDirection = glm::normalize( windDirection );
+    if( amplitude == this->amplitude && windSpeed == this->windSpeed && windDirection == this->windDirection )
+        return;
+
+    this->amplitude = amplitude;
+    this->windSpeed = windSpeed;
+    this->windDirection = windDirection;
+    h0 = generateInitialSpectrum( resolution, patchSize, amplitude, windSpeed, windDirection );
+}
+
+void OceanCPU::setChoppiness( float value ) noexcept
+{
+    choppiness = value;
+}
+
+void OceanCPU::update( double time ) noexcept
+{
+    const int N = resolution;
+    const double cycle = oceanCycle( time );
+
+    // 1. Animate h0 into the packed spectra, same math as fft_spectrum.fs
+    pool.parallelFor( N, [ & ]( int begin, int end )
+    {
+        for( int z = begin; z < end; z++ )
+        {
+            for( int x = 0; x < N; x++ )
+            {
+                const int i = z * N + x;
+                glm::vec2 k = glm::two_pi< float >() * glm::vec2( x - N / 2, z - N / 2 ) / patchSize;
+                float kLen = glm::length( k );
+                if( kLen < 1e-6f )
+                {
+                    for( int f = 0; f < FIELD_COUNT; f++ )
+                    {
+                        fieldRe[f][i] = 0.0f;
+                        fieldIm[f][i] = 0.0f;
+                    }
+                    continue;
+                }
+                const float phase = wavePhase( omega[i], cycle );
+                float c = std::cos( phase );
+                float s = std::sin( phase );
+                const glm::vec4 & h0Value = h0[i];
+                // h = h0 * e^( i w t ) + conj( h0( -k ) ) * e^( -i w t )
+                float hRe = h0Value.x * c - h0Value.y * s + h0Value.z * c + h0Value.w * s;
+                float hIm = h0Value.x * s + h0Value.y * c - h0Value.z * s + h0Value.w * c;
+                // dx = -i kx / |k| h, dz = -i kz / |k| h, slope x = i kx h, slope z = i kz h
+                float dxRe = hIm * k.x / kLen, dxIm = -hRe * k.x / kLen;
+                float dzRe = hIm * k.y / kLen, dzIm = -hRe * k.y / kLen;
+                float sxRe = -hIm * k.x, sxIm = hRe * k.x;
+                float szRe = -hIm * k.y, szIm = hRe * k.y;
+                // A + i B
+                fieldRe[0][i] = hRe - dxIm;
+                fieldIm[0][i] = hIm + dxRe;
+                fieldRe[1][i] = dzRe - sxIm;
+                fieldIm[1][i] = dzIm + sxRe;
+                fieldRe[2][i] = szRe;
+                fieldIm[2][i] = szIm;
+            }
+        }
+    } );
+
+    // 2. Inverse FFT along z, transpose, inverse FFT along x. The result stays transposed, [ x ][ z ]
+    transformColumns();
+    transpose();
+    transformColumns();
+
+    // 3. Unpack the real fields
+    pool.parallelFor( N, [ & ]( int begin, int end )
+    {
+        for( int z = begin; z < end; z++ )
+        {
+            for( int x = 0; x < N; x++ )
+            {
+                const int t = x * N + z;
+                // The spectrum is centered on k = 0, which shifts every output sample by ( -1 )^( x + z )
+                float sign = ( ( x + z ) & 1 ) ? -1.0f : 1.0f;
+                float h = fieldRe[0][t] * sign;
+                float dx = fieldIm[0][t] * sign;
+                float dz = fieldRe[1][t] * sign;
+                float sx = fieldIm[1][t] * sign;
+                float sz = fieldRe[2][t] * sign;
+                displacement[ z * N + x ] = glm::vec4( choppiness * dx, h, choppiness * dz, 1.0f );
+                normals[ z * N + x ] = glm::vec4( glm::normalize( glm::vec3( -sx, 1.0f, -sz ) ), 1.0f );
+            }
+        }
+    } );
+}
+
+const std::vector< glm::vec4 > & OceanCPU::getDisplacement() const noexcept
+{
+    return displacement;
+}
+
+const std::vector< glm::vec4 > & OceanCPU::getNormals() const noexcept
+{
+    return normals;
+}
+
+int OceanCPU::getResolution() const noexcept
+{
+    return resolution;
+}
+
+float OceanCPU::getPatchSize() const noexcept
+{
+    return patchSize;
+}
+
+unsigned int OceanCPU::getThreadCount() const noexcept
+{
+    return pool.getThreadCount();
+}
+
+void OceanCPU::transformColumns() noexcept
+{
+    const FFTPlan & plan = FFTPlan::get( resolution );
+    // Every worker owns a band of lanes in the data and in the scratch planes, 16 lanes keep bands on separate cache lines
+    pool.parallelFor( resolution, [ & ]( int begin, int end )
+    {
+        for( int f = 0; f < FIELD_COUNT; f++ )
+        {
+            plan.execute( &fieldRe[f][ begin ], &fieldIm[f][ begin ], &scratchRe[f][ begin ], &scratchIm[f][ begin ], resolution, end - begin, true );
+        }
+    }, 16 );
+}
+
+void OceanCPU::transpose() noexcept
+{
+    const int N = resolution;
+    const int blocks = ( N + TRANSPOSE_BLOCK - 1 ) / TRANSPOSE_BLOCK;
+    pool.parallelFor( blocks, [ & ]( int begin, int end )
+    {
+        for( int f = 0; f < FIELD_COUNT; f++ )
+        {
+            for( int by = begin; by < end; by++ )
+            {
+                for( int bx = 0; bx < blocks; bx++ )
+                {
+                    const int yEnd = std::min( N, ( by + 1 ) * TRANSPOSE_BLOCK );
+                    const int xEnd = std::min( N, ( bx + 1 ) * TRANSPOSE_BLOCK );
+                    for( int y = by * TRANSPOSE_BLOCK; y < yEnd; y++ )
+                    {
+                        for( int x = bx * TRANSPOSE_BLOCK; x < xEnd; x++ )
+                        {
+                            scratchRe[f][ x * N + y ] = fieldRe[f][ y * N + x ];
+                            scratchIm[f][ x * N + y ] = fieldIm[f][ y * N + x ];
+                        }
+                    }
+                }
+            }
+        }
+    } );
+    for( int f = 0; f < FIELD_COUNT; f++ )
+    {
+        std::swap( fieldRe[f], scratchRe[f] );
+        std::swap( fieldIm[f], scratchIm[f] );
+    }
+}
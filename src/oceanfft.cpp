@@ -0,0 +1,214 @@
+#include <oceanfft.hpp>
+#include <glad/glad.h>
+#include <oceancpu.hpp>
+#include <stdexcept>
+
+OceanFFT::OceanFFT( int resolution, float patchSize ) : resolution( resolution ), patchSize( patchSize )
+{
+    if( resolution < 2 || ( resolution & ( resolution - 1 ) ) != 0 )
+    {
+        throw std::runtime_error( "FFT resolution must be a power of two" );
+    }
+    log2Resolution = 0;
+    while( ( 1 << log2Resolution ) < resolution )
+        log2Resolution++;
+
+    // The fullscreen triangle is generated from gl_VertexID but core profile still needs a bound VAO
+    glGenVertexArrays( 1, &quadVAO );
+
+    h0Texture = createTexture( resolution, GL_RGBA32F, false );
+
+    glGenFramebuffers( 2, pingPongFBO );
+    for( int i = 0; i < 2; i++ )
+    {
+        glBindFramebuffer( GL_FRAMEBUFFER, pingPongFBO[i] );
+        for( int j = 0; j < 2; j++ )
+        {
+            pingPongTextures[i][j] = createTexture( resolution, GL_RGBA32F, false );
+            glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + j, GL_TEXTURE_2D, pingPongTextures[i][j], 0 );
+        }
+        unsigned int attachments[ 2 ] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers( 2, attachments );
+        if( glCheckFramebufferStatus( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
+        {
+            glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+            throw std::runtime_error( "FFT ping-pong framebuffer is incomplete" );
+        }
+    }
+
+    displacementMap = createTexture( resolution, GL_RGBA16F, true );
+    normalMap = createTexture( resolution, GL_RGBA16F, true );
+    glBindTexture( GL_TEXTURE_2D, normalMap );
+    glGenerateMipmap( GL_TEXTURE_2D );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    glGenFramebuffers( 1, &mapsFBO );
+    glBindFramebuffer( GL_FRAMEBUFFER, mapsFBO );
+    glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, displacementMap, 0 );
+    glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalMap, 0 );
+    unsigned int attachments[ 2 ] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers( 2, attachments );
+    if( glCheckFramebufferStatus( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
+    {
+        glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+        throw std::runtime_error( "FFT output framebuffer is incomplete" );
+    }
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+
+    setSpectrum( 1.0f, 20.0f, glm::vec2( 1.0f, 0.0f ) );
+}
+
+OceanFFT::~OceanFFT()
+{
+    glDeleteFramebuffers( 2, pingPongFBO );
+    glDeleteFramebuffers( 1, &mapsFBO );
+    glDeleteTextures( 4, &pingPongTextures[0][0] );
+    glDeleteTextures( 1, &h0Texture );
+    glDeleteTextures( 1, &displacementMap );
+    glDeleteTextures( 1, &normalMap );
+    glDeleteVertexArrays( 1, &quadVAO );
+}
+
+void OceanFFT::setSpectrum( float amplitude, float windSpeed, glm::vec2 windDirection ) noexcept
+{
+    windDirection = glm::normalize( windDirection );
+    if( amplitude == this->amplitude && windSpeed == this->windSpeed && windDirection == this->windDirection )
+        return;
+
+    this->amplitude = amplitude;
+    this->windSpeed = windSpeed;
+    this->windDirection = windDirection;
+    generateH0();
+}
+
+void OceanFFT::setChoppiness( float value ) noexcept
+{
+    choppiness = value;
+}
+
+void OceanFFT::update( double time ) noexcept
+{
+    // Save the state touched by the passes
+    int viewport[ 4 ];
+    glGetIntegerv( GL_VIEWPORT, viewport );
+    bool depthTest = glIsEnabled( GL_DEPTH_TEST );
+    bool blend = glIsEnabled( GL_BLEND );
+    bool cullFace = glIsEnabled( GL_CULL_FACE );
+    glDisable( GL_DEPTH_TEST );
+    glDisable( GL_BLEND );
+    glDisable( GL_CULL_FACE );
+
+    glViewport( 0, 0, resolution, resolution );
+    glBindVertexArray( quadVAO );
+
+    // 1. Animate h0 into the packed spectra of the height, displacement and slopes
+    glBindFramebuffer( GL_FRAMEBUFFER, pingPongFBO[0] );
+    spectrumShader.activate();
+    spectrumShader.setInt( "h0", 0 );
+    spectrumShader.setInt( "resolution", resolution );
+    spectrumShader.setFloat( "patchSize", patchSize );
+    spectrumShader.setFloat( "time", static_cast< float >( oceanCycle( time ) ) );
+    spectrumShader.setFloat( "period", static_cast< float >( OCEAN_PERIOD ) );
+    glActiveTexture( GL_TEXTURE0 );
+    glBindTexture( GL_TEXTURE_2D, h0Texture );
+    glDrawArrays( GL_TRIANGLES, 0, 3 );
+
+    // 2. Inverse FFT, log2( N ) passes along the rows then log2( N ) passes along the columns
+    int source = 0;
+    fftShader.activate();
+    fftShader.setInt( "inputA", 0 );
+    fftShader.setInt( "inputB", 1 );
+    fftShader.setInt( "resolution", resolution );
+    for( int direction = 0; direction < 2; direction++ )
+    {
+        fftShader.setInt( "direction", direction );
+        for( int stage = 0; stage < log2Resolution; stage++ )
+        {
+            glBindFramebuffer( GL_FRAMEBUFFER, pingPongFBO[ 1 - source ] );
+            glActiveTexture( GL_TEXTURE0 );
+            glBindTexture( GL_TEXTURE_2D, pingPongTextures[ source ][ 0 ] );
+            glActiveTexture( GL_TEXTURE1 );
+            glBindTexture( GL_TEXTURE_2D, pingPongTextures[ source ][ 1 ] );
+            fftShader.setInt( "stage", stage );
+            glDrawArrays( GL_TRIANGLES, 0, 3 );
+            source = 1 - source;
+        }
+    }
+
+    // 3. Unpack the real fields into the displacement and normal maps
+    glBindFramebuffer( GL_FRAMEBUFFER, mapsFBO );
+    resolveShader.activate();
+    resolveShader.setInt( "inputA", 0 );
+    resolveShader.setInt( "inputB", 1 );
+    resolveShader.setFloat( "choppiness", choppiness );
+    glActiveTexture( GL_TEXTURE0 );
+    glBindTexture( GL_TEXTURE_2D, pingPongTextures[ source ][ 0 ] );
+    glActiveTexture( GL_TEXTURE1 );
+    glBindTexture( GL_TEXTURE_2D, pingPongTextures[ source ][ 1 ] );
+    glDrawArrays( GL_TRIANGLES, 0, 3 );
+
+    glBindTexture( GL_TEXTURE_2D, normalMap );
+    glGenerateMipmap( GL_TEXTURE_2D );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+    glActiveTexture( GL_TEXTURE0 );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    // Restore the state
+    glBindVertexArray( 0 );
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    glViewport( viewport[0], viewport[1], viewport[2], viewport[3] );
+    if( depthTest )
+        glEnable( GL_DEPTH_TEST );
+    if( blend )
+        glEnable( GL_BLEND );
+    if( cullFace )
+        glEnable( GL_CULL_FACE );
+}
+
+void OceanFFT::bindMaps( unsigned int displacementUnit, unsigned int normalUnit ) const noexcept
+{
+    glActiveTexture( GL_TEXTURE0 + displacementUnit );
+    glBindTexture( GL_TEXTURE_2D, displacementMap );
+    glActiveTexture( GL_TEXTURE0 + normalUnit );
+    glBindTexture( GL_TEXTURE_2D, normalMap );
+    glActiveTexture( GL_TEXTURE0 );
+}
+
+int OceanFFT::getResolution() const noexcept
+{
+    return resolution;
+}
+
+float OceanFFT::getPatchSize() const noexcept
+{
+    return patchSize;
+}
+
+float OceanFFT::getChoppiness() const noexcept
+{
+    return choppiness;
+}
+
+void OceanFFT::generateH0() noexcept
+{
+    std::vector< glm::vec4 > texels = generateInitialSpectrum( resolution, patchSize, amplitude, windSpeed, windDirection );
+    glBindTexture( GL_TEXTURE_2D, h0Texture );
+    glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, resolution, resolution, GL_RGBA, GL_FLOAT, &texels[0] );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+}
+
+unsigned int OceanFFT::createTexture( int size, int internalFormat, bool repeat ) noexcept
+{
+    unsigned int texture;
+    glGenTextures( 1, &texture );
+    glBindTexture( GL_TEXTURE_2D, texture );
+    glTexImage2D( GL_TEXTURE_2D, 0, internalFormat, size, size, 0, GL_RGBA, GL_FLOAT, nullptr );
+    // Intermediate spectra are read with texelFetch only, the final maps are filtered and tiled
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, repeat ? GL_LINEAR : GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, repeat ? GL_LINEAR : GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+    return texture;
+}
@@ -0,0 +1,58 @@
+#include <primitivecounter.hpp>
+#include <glad/glad.h>
+
+PrimitiveCounter::PrimitiveCounter() noexcept
+{
+    glGenQueries( QUERY_COUNT, queries );
+}
+
+PrimitiveCounter::~PrimitiveCounter()
+{
+    glDeleteQueries( QUERY_COUNT, queries );
+}
+
+void PrimitiveCounter::begin() noexcept
+{
+    collect();
+    // Every query still in flight is busy : drop this count rather than wait for the oldest one
+    if( issued[ next ] )
+        return;
+    glBeginQuery( GL_PRIMITIVES_GENERATED, queries[ next ] );
+}
+
+void PrimitiveCounter::end() noexcept
+{
+    if( issued[ next ] )
+        return;
+    glEndQuery( GL_PRIMITIVES_GENERATED );
+    issued[ next ] = true;
+    serials[ next ] = serial++;
+    next = ( next + 1 ) % QUERY_COUNT;
+}
+
+unsigned long long PrimitiveCounter::getCount() const noexcept
+{
+    return count;
+}
+
+void PrimitiveCounter::collect() noexcept
+{
+    for( int i = 0; i < QUERY_COUNT; i++ )
+    {
+        if( !issued[i] )
+            continue;
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv( queries[i], GL_QUERY_RESULT_AVAILABLE, &available );
+        if( !available )
+            continue;
+        GLuint64 primitives;
+        glGetQueryObjectui64v( queries[i], GL_QUERY_RESULT, &primitives );
+        issued[i] = false;
+        // Results can come back out of order, an older one must not replace a newer count
+        if( serials[i] > latest )
+        {
+            latest = serials[i];
+            count = primitives;
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#include <projectedgrid.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Smallest overlap of the grid past the screen edges, in NDC, for the horizontal motion of the choppy waves
+    const float MIN_MARGIN = 0.05f;
+}
+
+ProjectedGrid::ProjectedGrid( int columns, int rows ) noexcept :
+    columns( std::max( columns, 1 ) ), rows( std::max( rows, 1 ) ), model( std::vector< Mesh >{ Mesh::screenGrid( columns, rows ) } )
+{
+}
+
+glm::vec3 ProjectedGrid::cast( glm::vec2 ndc, glm::vec3 cameraPosition ) const noexcept
+{
+    glm::vec4 far = inverseViewProjection * glm::vec4( ndc, 1.0f, 1.0f );
+    glm::vec3 direction = glm::vec3( far ) / far.w - cameraPosition;
+    // Rays toward the plane meet it, unless farther than the distance, where the others stop as well
+    if( direction.y * cameraPosition.y < 0.0f )
+    {
+        glm::vec3 hit = cameraPosition - direction * ( cameraPosition.y / direction.y );
+        if( glm::length( glm::vec2( hit.x - cameraPosition.x, hit.z - cameraPosition.z ) ) <= distance )
+            return glm::vec3( hit.x, 0.0f, hit.z );
+    }
+    glm::vec2 horizontal( direction.x, direction.z );
+    const float length = glm::length( horizontal );
+    if( length > 0.0f )
+        horizontal *= distance / length;
+    return glm::vec3( cameraPosition.x + horizontal.x, 0.0f, cameraPosition.z + horizontal.y );
+}
+
+bool ProjectedGrid::update( const glm::mat4 & view, const glm::mat4 & projection, glm::vec3 cameraPosition, float distance, float height ) noexcept
+{
+    this->distance = distance;
+    const glm::mat4 viewProjection = projection * view;
+    inverseViewProjection = glm::inverse( viewProjection );
+
+    // A crest moves the surface on screen by about its height over its depth, the most at the bottom of the screen
+    const float depth = std::max( glm::distance( cast( glm::vec2( 0.0f, -1.0f ), cameraPosition ), cameraPosition ), 1e-3f );
+    const float margin = glm::clamp( std::abs( height ) * projection[1][1] / depth, MIN_MARGIN, 1.0f );
+    float top = 1.0f + margin;
+    if( cameraPosition.y > 0.0f )
+    {
+        // From above, the sea ends below the horizon, on the circle at the distance
+        const glm::vec2 ahead = -glm::vec2( view[0][2], view[2][2] );
+        if( glm::length( ahead ) > 1e-4f )
+        {
+            const glm::vec2 edge = glm::vec2( cameraPosition.x, cameraPosition.z ) + glm::normalize( ahead ) * distance;
+            const glm::vec4 clip = viewProjection * glm::vec4( edge.x, 0.0f, edge.y, 1.0f );
+            if( clip.w <= 0.0f )
+                return false;
+            top = std::min( top, clip.y / clip.w + margin );
+        }
+    }
+    if( top <= -1.0f - margin )
+        return false;
+    range = glm::vec4( -1.0f - margin, -1.0f - margin, 1.0f + margin, top );
+
+    const float rowHeight = ( range.w - range.y ) / rows;
+    spacing = glm::distance( cast( glm::vec2( 0.0f, range.y ), cameraPosition ), cast( glm::vec2( 0.0f, range.y + rowHeight ), cameraPosition ) );
+    return true;
+}
+
+void ProjectedGrid::setUniforms( const Shader & shader ) const noexcept
+{
+    glm::mat4 inverse = inverseViewProjection;
+    glm::vec4 gridRange = range;
+    shader.setBool( "projectedGrid", true );
+    shader.setMat4( "gridInverseViewProjection", inverse );
+    shader.setVec4( "gridRange", gridRange );
+    shader.setFloat( "gridDistance", distance );
+}
+
+const Model & ProjectedGrid::getModel() const noexcept
+{
+    return model;
+}
+
+int ProjectedGrid::getColumns() const noexcept
+{
+    return columns;
+}
+
+int ProjectedGrid::getRows() const noexcept
+{
+    return rows;
+}
+
+float ProjectedGrid::getSpacing() const noexcept
+{
+    return spacing;
+}
@@ -0,0 +1,300 @@
+#include <quadtree.hpp>
+#include <mesh.hpp>
+#include <glad/glad.h>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Attributes the water program reads the tile from, after those of Mesh
+    const unsigned int CORNER_ATTRIBUTE = 7;
+    const unsigned int STITCH_ATTRIBUTE = 8;
+}
+
+void Quadtree::buildTile( int tileCells, std::vector< glm::vec3 > & vertices, std::vector< unsigned short > & indices ) noexcept
+{
+    // Vertices in cells of the tile, ( i, 0, j ), in the order of Mesh::grid
+    const int side = tileCells + 1;
+    vertices.resize( static_cast< size_t >( side ) * side );
+    for( int j = 0; j < side; j++ )
+        for( int i = 0; i < side; i++ )
+            vertices[ j * side + i ] = glm::vec3( i, 0.0f, j );
+    indices.clear();
+    indices.reserve( static_cast< size_t >( tileCells ) * tileCells * 6 );
+    for( int j = 0; j < tileCells; j++ )
+    {
+        for( int i = 0; i < tileCells; i++ )
+        {
+            unsigned short corner = static_cast< unsigned short >( j * side + i );
+            // The last cell is split along its other diagonal, which would otherwise join the two edges it touches
+            // and leave the inner vertex on it when both edges fold
+            if( i == tileCells - 1 && j == tileCells - 1 )
+                indices.insert( indices.end(), { corner, static_cast< unsigned short >( corner + side ), static_cast< unsigned short >( corner + side + 1 ),
+                                                 corner, static_cast< unsigned short >( corner + side + 1 ), static_cast< unsigned short >( corner + 1 ) } );
+            else
+                indices.insert( indices.end(), { corner, static_cast< unsigned short >( corner + side ), static_cast< unsigned short >( corner + 1 ),
+                                                 static_cast< unsigned short >( corner + 1 ), static_cast< unsigned short >( corner + side ), static_cast< unsigned short >( corner + side + 1 ) } );
+        }
+    }
+}
+
+Quadtree::Quadtree( int maxLevel, int tileCells, float leafSize, int maxTiles ) :
+    maxLevel( maxLevel ), tileCells( tileCells ), leafSize( leafSize ), maxTiles( maxTiles ), levels( std::max( maxLevel + 1, 1 ) ), levelBase( std::max( maxLevel + 1, 1 ) )
+{
+    const int side = tileCells + 1;
+    if( maxLevel < 0 || tileCells < 1 || ( tileCells & ( tileCells - 1 ) ) != 0 || side * side > 65536 || leafSize <= 0.0f || maxTiles < 1 )
+    {
+        throw std::runtime_error( "Quadtree tiles must have a power of two cells, at most 255, and a positive size" );
+    }
+
+    std::vector< glm::vec3 > vertices;
+    std::vector< unsigned short > indices;
+    buildTile( tileCells, vertices, indices );
+    indexCount = static_cast< unsigned int >( indices.size() );
+
+    glGenVertexArrays( 1, &vao );
+    glGenBuffers( 1, &vbo );
+    glGenBuffers( 1, &ebo );
+    glGenBuffers( 1, &instanceBuffer );
+    glBindVertexArray( vao );
+    glBindBuffer( GL_ARRAY_BUFFER, vbo );
+    glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof( glm::vec3 ), vertices.data(), GL_STATIC_DRAW );
+    glEnableVertexAttribArray( 0 );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, sizeof( glm::vec3 ), (void*)0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebo );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof( unsigned short ), indices.data(), GL_STATIC_DRAW );
+    glBindBuffer( GL_ARRAY_BUFFER, instanceBuffer );
+    glBufferData( GL_ARRAY_BUFFER, static_cast< size_t >( maxTiles ) * sizeof( Tile ), nullptr, GL_DYNAMIC_DRAW );
+    glEnableVertexAttribArray( CORNER_ATTRIBUTE );
+    glVertexAttribDivisor( CORNER_ATTRIBUTE, 1 );
+    glEnableVertexAttribArray( STITCH_ATTRIBUTE );
+    glVertexAttribDivisor( STITCH_ATTRIBUTE, 1 );
+
+    // Captured vertices, tile after tile in the order of the instances
+    glGenBuffers( 1, &feedbackBuffer );
+    glGenVertexArrays( 1, &capturedVao );
+    glBindVertexArray( capturedVao );
+    glBindBuffer( GL_ARRAY_BUFFER, feedbackBuffer );
+    glBufferData( GL_ARRAY_BUFFER, vertices.size() * maxTiles * sizeof( CapturedVertex ), nullptr, GL_DYNAMIC_COPY );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebo );
+    glEnableVertexAttribArray( 0 );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)0 );
+    glEnableVertexAttribArray( 1 );
+    glVertexAttribPointer( 1, 3, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)offsetof( CapturedVertex, normal ) );
+    glEnableVertexAttribArray( 2 );
+    glVertexAttribPointer( 2, 2, GL_FLOAT, GL_FALSE, sizeof( CapturedVertex ), (void*)offsetof( CapturedVertex, uv ) );
+    glBindVertexArray( 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+Quadtree::~Quadtree()
+{
+    glDeleteVertexArrays( 1, &capturedVao );
+    glDeleteBuffers( 1, &feedbackBuffer );
+    glDeleteBuffers( 1, &instanceBuffer );
+    glDeleteBuffers( 1, &ebo );
+    glDeleteBuffers( 1, &vbo );
+    glDeleteVertexArrays( 1, &vao );
+}
+
+float Quadtree::tileSize( int level ) const noexcept
+{
+    return std::ldexp( leafSize, maxLevel - level );
+}
+
+bool Quadtree::refine( glm::vec2 corner, int level ) const noexcept
+{
+    if( level >= maxLevel )
+        return false;
+    // Distance from the camera to the box the surface of the node moves in
+    const float size = tileSize( level );
+    const glm::vec2 flat = glm::vec2( camera.x, camera.z );
+    const glm::vec2 offset = flat - glm::clamp( flat, corner, corner + size );
+    const float vertical = std::max( std::abs( camera.y ) - height, 0.0f );
+    return glm::length( glm::vec3( offset.x, vertical, offset.y ) ) < REFINE_DISTANCE * size;
+}
+
+int Quadtree::levelAt( glm::vec2 point ) const noexcept
+{
+    // The same walk as select, down to the tile holding the point
+    float size = tileSize( 0 );
+    glm::vec2 corner = glm::floor( point / size ) * size;
+    int level = 0;
+    while( refine( corner, level ) )
+    {
+        size *= 0.5f;
+        corner += glm::floor( ( point - corner ) / size ) * size;
+        level++;
+    }
+    return level;
+}
+
+bool Quadtree::inFrustum( glm::vec2 corner, float size ) const noexcept
+{
+    const glm::vec3 low( corner.x - height, -height, corner.y - height );
+    const glm::vec3 high( corner.x + size + height, height, corner.y + size + height );
+    for( const glm::vec4 & plane : planes )
+    {
+        // Corner of the box the furthest along the normal of the plane
+        const glm::vec3 farthest( plane.x > 0.0f ? high.x : low.x, plane.y > 0.0f ? high.y : low.y, plane.z > 0.0f ? high.z : low.z );
+        if( glm::dot( glm::vec3( plane ), farthest ) + plane.w < 0.0f )
+            return false;
+    }
+    return true;
+}
+
+void Quadtree::select( glm::vec2 corner, int level ) noexcept
+{
+    const float size = tileSize( level );
+    if( !inFrustum( corner, size ) )
+    {
+        culled++;
+        return;
+    }
+    if( refine( corner, level ) )
+    {
+        const float half = size * 0.5f;
+        for( int child = 0; child < 4; child++ )
+            select( corner + glm::vec2( child & 1, child >> 1 ) * half, level + 1 );
+        return;
+    }
+    if( visible == maxTiles )
+        return;
+
+    // Level of the tile across the middle of each edge, -x, +x, -z then +z
+    const glm::vec2 center = corner + size * 0.5f;
+    const float reach = ( size + leafSize ) * 0.5f;
+    const glm::vec2 sides[4] = { glm::vec2( -reach, 0.0f ), glm::vec2( reach, 0.0f ), glm::vec2( 0.0f, -reach ), glm::vec2( 0.0f, reach ) };
+    glm::vec4 stitch;
+    for( int side = 0; side < 4; side++ )
+    {
+        const int coarser = std::max( level - levelAt( center + sides[ side ] ), 0 );
+        stitch[ side ] = static_cast< float >( std::min( 1 << coarser, tileCells ) );
+    }
+    levels[ level ].push_back( { glm::vec3( corner.x, corner.y, size / tileCells ), stitch } );
+    visible++;
+}
+
+void Quadtree::update( const glm::mat4 & viewProjection, glm::vec3 cameraPosition, float distance, float height ) noexcept
+{
+    camera = cameraPosition;
+    this->height = std::abs( height );
+    // Planes of the frustum from the rows of the matrix, inside when dot( plane.xyz, p ) + plane.w >= 0
+    const glm::vec4 rows[4] = { glm::vec4( viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0] ),
+                                glm::vec4( viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1] ),
+                                glm::vec4( viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2] ),
+                                glm::vec4( viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3] ) };
+    for( int i = 0; i < 3; i++ )
+    {
+        planes[ i * 2 ] = rows[3] + rows[i];
+        planes[ i * 2 + 1 ] = rows[3] - rows[i];
+    }
+
+    for( std::vector< Tile > & tiles : levels )
+        tiles.clear();
+    visible = 0;
+    culled = 0;
+    const float rootSize = tileSize( 0 );
+    const glm::vec2 flat( cameraPosition.x, cameraPosition.z );
+    const glm::ivec2 first( glm::floor( ( flat - distance ) / rootSize ) );
+    const glm::ivec2 last( glm::floor( ( flat + distance ) / rootSize ) );
+    for( int z = first.y; z <= last.y; z++ )
+        for( int x = first.x; x <= last.x; x++ )
+            select( glm::vec2( x, z ) * rootSize, 0 );
+
+    // Instances level after level
+    std::vector< Tile > instances;
+    instances.reserve( visible );
+    for( size_t level = 0; level < levels.size(); level++ )
+    {
+        levelBase[ level ] = static_cast< int >( instances.size() );
+        instances.insert( instances.end(), levels[ level ].begin(), levels[ level ].end() );
+    }
+    glBindBuffer( GL_ARRAY_BUFFER, instanceBuffer );
+    glBufferSubData( GL_ARRAY_BUFFER, 0, instances.size() * sizeof( Tile ), instances.data() );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+    const int tileVertices = ( tileCells + 1 ) * ( tileCells + 1 );
+    capturedCounts.assign( visible, static_cast< int >( indexCount ) );
+    capturedOffsets.assign( visible, nullptr );
+    capturedBases.resize( visible );
+    for( int i = 0; i < visible; i++ )
+        capturedBases[i] = i * tileVertices;
+}
+
+void Quadtree::draw() const noexcept
+{
+    glBindVertexArray( vao );
+    glBindBuffer( GL_ARRAY_BUFFER, instanceBuffer );
+    for( size_t level = 0; level < levels.size(); level++ )
+    {
+        if( levels[ level ].empty() )
+            continue;
+        // Without base instances in 3.3 the attributes are moved to the first tile of the level
+        const size_t offset = levelBase[ level ] * sizeof( Tile );
+        glVertexAttribPointer( CORNER_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof( Tile ), (void*)( offset + offsetof( Tile, corner ) ) );
+        glVertexAttribPointer( STITCH_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof( Tile ), (void*)( offset + offsetof( Tile, stitch ) ) );
+        glDrawElementsInstanced( GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, 0, static_cast< int >( levels[ level ].size() ) );
+    }
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindVertexArray( 0 );
+}
+
+void Quadtree::capture() const noexcept
+{
+    if( visible == 0 )
+        return;
+    glEnable( GL_RASTERIZER_DISCARD );
+    glBindVertexArray( vao );
+    glBindBuffer( GL_ARRAY_BUFFER, instanceBuffer );
+    glVertexAttribPointer( CORNER_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof( Tile ), (void*)offsetof( Tile, corner ) );
+    glVertexAttribPointer( STITCH_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof( Tile ), (void*)offsetof( Tile, stitch ) );
+    glBindBufferBase( GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedbackBuffer );
+    glBeginTransformFeedback( GL_POINTS );
+    glDrawArraysInstanced( GL_POINTS, 0, ( tileCells + 1 ) * ( tileCells + 1 ), visible );
+    glEndTransformFeedback();
+    glBindBufferBase( GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindVertexArray( 0 );
+    glDisable( GL_RASTERIZER_DISCARD );
+}
+
+void Quadtree::drawCaptured() const noexcept
+{
+    if( visible == 0 )
+        return;
+    glBindVertexArray( capturedVao );
+    glMultiDrawElementsBaseVertex( GL_TRIANGLES, capturedCounts.data(), GL_UNSIGNED_SHORT, capturedOffsets.data(), visible, capturedBases.data() );
+    glBindVertexArray( 0 );
+}
+
+int Quadtree::getLevelCount() const noexcept
+{
+    return static_cast< int >( levels.size() );
+}
+
+int Quadtree::getVisibleCount( int level ) const noexcept
+{
+    return static_cast< int >( levels[ level ].size() );
+}
+
+int Quadtree::getVisibleCount() const noexcept
+{
+    return visible;
+}
+
+int Quadtree::getCulledCount() const noexcept
+{
+    return culled;
+}
+
+unsigned int Quadtree::getVertexCount() const noexcept
+{
+    return static_cast< unsigned int >( visible ) * ( tileCells + 1 ) * ( tileCells + 1 );
+}
+
+float Quadtree::getCellSize() const noexcept
+{
+    return leafSize / tileCells;
+}
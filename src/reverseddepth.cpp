@@ -0,0 +1,97 @@
+#include <reverseddepth.hpp>
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+
+// Entry point and constants of GL 4.5 missing from the 3.3 glad
+typedef void ( APIENTRYP ClipControlProc )( GLenum origin, GLenum depth );
+#define REVERSED_NEGATIVE_ONE_TO_ONE 0x935E
+#define REVERSED_ZERO_TO_ONE 0x935F
+
+ReversedDepth::ReversedDepth( void * ( *loader )( const char * ), int width, int height ) : width( width ), height( height )
+{
+    if( width < 1 || height < 1 )
+    {
+        throw std::runtime_error( "Reversed depth needs a framebuffer of at least one pixel" );
+    }
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv( GL_MAJOR_VERSION, &major );
+    glGetIntegerv( GL_MINOR_VERSION, &minor );
+    bool supported = major * 10 + minor >= 45;
+    GLint extensionCount = 0;
+    glGetIntegerv( GL_NUM_EXTENSIONS, &extensionCount );
+    for( GLint i = 0; i < extensionCount && !supported; i++ )
+    {
+        const char * extension = reinterpret_cast< const char * >( glGetStringi( GL_EXTENSIONS, i ) );
+        supported = extension && std::strcmp( extension, "GL_ARB_clip_control" ) == 0;
+    }
+    if( !supported )
+    {
+        throw std::runtime_error( "Reversed depth needs OpenGL 4.5 or ARB_clip_control, the context is " + std::to_string( major ) + "." + std::to_string( minor ) );
+    }
+    clipControl = loader( "glClipControl" );
+    if( !clipControl )
+    {
+        throw std::runtime_error( "Reversed depth could not load glClipControl" );
+    }
+
+    glGenRenderbuffers( 1, &colorBuffer );
+    glBindRenderbuffer( GL_RENDERBUFFER, colorBuffer );
+    glRenderbufferStorage( GL_RENDERBUFFER, GL_RGBA8, width, height );
+    glGenRenderbuffers( 1, &depthBuffer );
+    glBindRenderbuffer( GL_RENDERBUFFER, depthBuffer );
+    glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, width, height );
+    glBindRenderbuffer( GL_RENDERBUFFER, 0 );
+
+    glGenFramebuffers( 1, &framebuffer );
+    glBindFramebuffer( GL_FRAMEBUFFER, framebuffer );
+    glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer );
+    glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer );
+    const bool complete = glCheckFramebufferStatus( GL_FRAMEBUFFER ) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    if( !complete )
+    {
+        glDeleteFramebuffers( 1, &framebuffer );
+        glDeleteRenderbuffers( 1, &depthBuffer );
+        glDeleteRenderbuffers( 1, &colorBuffer );
+        throw std::runtime_error( "Reversed depth framebuffer is incomplete" );
+    }
+}
+
+ReversedDepth::~ReversedDepth()
+{
+    glDeleteFramebuffers( 1, &framebuffer );
+    glDeleteRenderbuffers( 1, &depthBuffer );
+    glDeleteRenderbuffers( 1, &colorBuffer );
+}
+
+void ReversedDepth::begin() const noexcept
+{
+    glBindFramebuffer( GL_FRAMEBUFFER, framebuffer );
+    reinterpret_cast< ClipControlProc >( clipControl )( GL_LOWER_LEFT, REVERSED_ZERO_TO_ONE );
+    glClearDepth( 0.0 );
+    glDepthFunc( GL_GREATER );
+}
+
+void ReversedDepth::end() const noexcept
+{
+    glBindFramebuffer( GL_READ_FRAMEBUFFER, framebuffer );
+    glBindFramebuffer( GL_DRAW_FRAMEBUFFER, 0 );
+    glBlitFramebuffer( 0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST );
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    reinterpret_cast< ClipControlProc >( clipControl )( GL_LOWER_LEFT, REVERSED_NEGATIVE_ONE_TO_ONE );
+    glClearDepth( 1.0 );
+    glDepthFunc( GL_LESS );
+}
+
+glm::mat4 ReversedDepth::perspective( float fovy, float aspect, float nearPlane, float farPlane ) noexcept
+{
+    // Only the depth row changes : z / w runs from 1 at -nearPlane down to 0 at -farPlane
+    glm::mat4 projection = glm::perspective( fovy, aspect, nearPlane, farPlane );
+    projection[2][2] = nearPlane / ( farPlane - nearPlane );
+    projection[3][2] = nearPlane * farPlane / ( farPlane - nearPlane );
+    return projection;
+}
@@ -0,0 +1,200 @@
+#include <ringexport.hpp>
+#include <stdexcept>
+#include <cstring>
+#include <new>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Slots start on page boundaries so a reader can map a single one
+#define RING_EXPORT_PAGE 4096
+
+namespace
+{
+    size_t roundUp( size_t value, size_t multiple )
+    {
+        return ( value + multiple - 1 ) / multiple * multiple;
+    }
+
+    // Maps the whole file, creating it with the given size when writable
+    unsigned char * mapFile( const std::string & path, size_t & size, bool writable )
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA( path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                   nullptr, writable ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+        if( file == INVALID_HANDLE_VALUE )
+            throw std::runtime_error( "Could not open the ring file " + path );
+        if( !writable )
+        {
+            LARGE_INTEGER fileSize;
+            GetFileSizeEx( file, &fileSize );
+            size = static_cast< size_t >( fileSize.QuadPart );
+        }
+        HANDLE mapping = CreateFileMappingA( file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                             static_cast< DWORD >( static_cast< unsigned long long >( size ) >> 32 ), static_cast< DWORD >( size ), nullptr );
+        void * view = mapping ? MapViewOfFile( mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size ) : nullptr;
+        // The view keeps the file and the mapping alive
+        if( mapping )
+            CloseHandle( mapping );
+        CloseHandle( file );
+        if( !view )
+            throw std::runtime_error( "Could not map the ring file " + path );
+        return static_cast< unsigned char * >( view );
+#else
+        // A fresh file rather than the old one truncated : readers still mapping the previous export keep its inode
+        // and read a stale ring instead of faulting on pages cut off under them
+        if( writable )
+            unlink( path.c_str() );
+        int file = writable ? open( path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644 ) : open( path.c_str(), O_RDONLY );
+        if( file < 0 )
+            throw std::runtime_error( "Could not open the ring file " + path );
+        struct stat status;
+        if( writable ? ftruncate( file, static_cast< off_t >( size ) ) != 0 : fstat( file, &status ) != 0 )
+        {
+            close( file );
+            throw std::runtime_error( "Could not size the ring file " + path );
+        }
+        if( !writable )
+            size = static_cast< size_t >( status.st_size );
+        void * view = mmap( nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0 );
+        // The mapping keeps the file alive
+        close( file );
+        if( view == MAP_FAILED )
+            throw std::runtime_error( "Could not map the ring file " + path );
+        return static_cast< unsigned char * >( view );
+#endif
+    }
+
+    void unmapFile( const void * data, size_t size )
+    {
+#ifdef _WIN32
+        UnmapViewOfFile( data );
+#else
+        munmap( const_cast< void * >( data ), size );
+#endif
+    }
+}
+
+RingExport::RingExport( const std::string & path, int resolution, float patchSize, float dt, int slotCount )
+{
+    if( resolution < 1 || slotCount < 2 )
+    {
+        throw std::runtime_error( "Ring export needs a positive resolution and at least 2 slots" );
+    }
+    const size_t texels = static_cast< size_t >( resolution ) * resolution;
+    const size_t frameOffset = roundUp( sizeof( RingExportFrame ), 64 );
+    const size_t slotSize = roundUp( frameOffset + texels * 4 * sizeof( float ), RING_EXPORT_PAGE );
+    const size_t headerSize = roundUp( sizeof( RingExportHeader ), RING_EXPORT_PAGE );
+    size = headerSize + slotSize * slotCount;
+    data = mapFile( path, size, true );
+
+    header = new( data ) RingExportHeader;
+    header->version = RING_EXPORT_VERSION;
+    header->resolution = resolution;
+    header->slotCount = slotCount;
+    header->headerSize = static_cast< std::uint32_t >( headerSize );
+    header->slotSize = slotSize;
+    header->frameOffset = frameOffset;
+    header->patchSize = patchSize;
+    header->dt = dt;
+    header->frameCount.store( 0, std::memory_order_relaxed );
+    for( int i = 0; i < slotCount; i++ )
+        new( data + headerSize + slotSize * i ) RingExportFrame{ { 0 }, 0, 0.0, RingExportParameters() };
+    // Readers only trust the file once the magic is there
+    std::atomic_thread_fence( std::memory_order_release );
+    std::memcpy( header->magic, RING_EXPORT_MAGIC, sizeof( header->magic ) );
+}
+
+RingExport::~RingExport()
+{
+    unmapFile( data, size );
+}
+
+void RingExport::write( double time, const RingExportParameters & parameters, const std::vector< glm::vec4 > & displacement,
+                        const std::vector< glm::vec4 > & normals ) noexcept
+{
+    const size_t texels = static_cast< size_t >( header->resolution ) * header->resolution;
+    if( displacement.size() < texels || normals.size() < texels )
+        return;
+    const std::uint64_t frame = header->frameCount.load( std::memory_order_relaxed );
+    unsigned char * slot = data + header->headerSize + header->slotSize * ( frame % header->slotCount );
+    RingExportFrame * info = reinterpret_cast< RingExportFrame * >( slot );
+
+    info->sequence.store( 2 * frame + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    info->frame = frame;
+    info->time = time;
+    info->parameters = parameters;
+    float * heights = reinterpret_cast< float * >( slot + header->frameOffset );
+    float * normalData = heights + texels;
+    for( size_t i = 0; i < texels; i++ )
+    {
+        heights[i] = displacement[i].y;
+        normalData[ i * 3 ] = normals[i].x;
+        normalData[ i * 3 + 1 ] = normals[i].y;
+        normalData[ i * 3 + 2 ] = normals[i].z;
+    }
+    info->sequence.store( 2 * frame + 2, std::memory_order_release );
+    header->frameCount.store( frame + 1, std::memory_order_release );
+}
+
+std::uint64_t RingExport::getFrameCount() const noexcept
+{
+    return header->frameCount.load( std::memory_order_relaxed );
+}
+
+size_t RingExport::getFileSize() const noexcept
+{
+    return size;
+}
+
+RingView::RingView( const std::string & path )
+{
+    data = mapFile( path, size, false );
+    if( size < sizeof( RingExportHeader ) || std::memcmp( getHeader().magic, RING_EXPORT_MAGIC, sizeof( getHeader().magic ) ) != 0 ||
+        getHeader().version != RING_EXPORT_VERSION ||
+        size < getHeader().headerSize + getHeader().slotSize * getHeader().slotCount )
+    {
+        unmapFile( data, size );
+        throw std::runtime_error( "Not a complete ring file : " + path );
+    }
+    std::atomic_thread_fence( std::memory_order_acquire );
+}
+
+RingView::~RingView()
+{
+    unmapFile( data, size );
+}
+
+const RingExportHeader & RingView::getHeader() const noexcept
+{
+    return *reinterpret_cast< const RingExportHeader * >( data );
+}
+
+bool RingView::acquireLatest( FrameRef & ref ) const noexcept
+{
+    const RingExportHeader & header = getHeader();
+    const std::uint64_t count = header.frameCount.load( std::memory_order_acquire );
+    if( count == 0 )
+        return false;
+    const std::uint64_t frame = count - 1;
+    const unsigned char * slot = data + header.headerSize + header.slotSize * ( frame % header.slotCount );
+    ref.frame = reinterpret_cast< const RingExportFrame * >( slot );
+    ref.sequence = ref.frame->sequence.load( std::memory_order_acquire );
+    if( ref.sequence != 2 * frame + 2 )
+        return false;
+    ref.heights = reinterpret_cast< const float * >( slot + header.frameOffset );
+    ref.normals = ref.heights + static_cast< size_t >( header.resolution ) * header.resolution;
+    return true;
+}
+
+bool RingView::isValid( const FrameRef & ref ) const noexcept
+{
+    std::atomic_thread_fence( std::memory_order_acquire );
+    return ref.frame && ref.frame->sequence.load( std::memory_order_relaxed ) == ref.sequence;
+}
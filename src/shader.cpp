@@ -4,7 +4,30 @@
 #include <fstream>
 #include <sstream>
 
-Shader::Shader( const char* vertexPath, const char* fragmentPath, const char* geometryPath )
+// glad is generated for GL 3.3, tessellation shaders are only created on 4.0 contexts and compute shaders on 4.3 ones
+#ifndef GL_TESS_EVALUATION_SHADER
+#define GL_TESS_EVALUATION_SHADER 0x8E87
+#endif
+#ifndef GL_TESS_CONTROL_SHADER
+#define GL_TESS_CONTROL_SHADER 0x8E88
+#endif
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
+// Maximum nesting of #include, deeper means a file includes itself
+#define MAX_INCLUDE_DEPTH 8
+
+namespace
+{
+    std::string directoryOf( const std::string & path )
+    {
+        size_t slash = path.find_last_of( "/\\" );
+        return slash == std::string::npos ? std::string() : path.substr( 0, slash + 1 );
+    }
+}
+
+Shader::Shader( const char* vertexPath, const char* fragmentPath, const char* geometryPath, const std::string & defines )
 {
     // 1. retrieve the vertex/fragment/geometry source code from filePath
     std::string vertexCode;
@@ -30,13 +53,13 @@ Shader::Shader( const char* vertexPath, const char* fragmentPath, const char* ge
         vShaderFile.close();
         fShaderFile.close();
         // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+        vertexCode = insertDefines( resolveIncludes( vShaderStream.str(), directoryOf( vertexPath ) ), defines );
+        fragmentCode = insertDefines( resolveIncludes( fShaderStream.str(), directoryOf( fragmentPath ) ), defines );
         if( geometryPath != nullptr )
         {
             gShaderFile.open(geometryPath);
             gShaderStream << fShaderFile.rdbuf();
-            geometryCode = gShaderStream.str();
+            geometryCode = insertDefines( resolveIncludes( gShaderStream.str(), directoryOf( geometryPath ) ), defines );
             gShaderFile.close(); 
         }
     }
@@ -82,6 +105,84 @@ Shader::Shader( const char* vertexPath, const char* fragmentPath, const char* ge
         glDeleteShader( geometry );
 }
 
+Shader::Shader( const char * vertexPath, const std::vector< std::string > & feedbackVaryings, const std::string & defines )
+{
+    std::ifstream file( vertexPath );
+    if( !file )
+        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << vertexPath << std::endl;
+    std::stringstream stream;
+    stream << file.rdbuf();
+    const std::string code = insertDefines( resolveIncludes( stream.str(), directoryOf( vertexPath ) ), defines );
+    const char * vShaderCode = code.c_str();
+
+    unsigned int vertex = glCreateShader( GL_VERTEX_SHADER );
+    glShaderSource( vertex, 1, &vShaderCode, NULL );
+    glCompileShader( vertex );
+    compileErrors( vertex, "VERTEX" );
+
+    id = glCreateProgram();
+    glAttachShader( id, vertex );
+    // The names have to be given before linking
+    std::vector< const char * > names;
+    for( const std::string & varying : feedbackVaryings )
+        names.push_back( varying.c_str() );
+    glTransformFeedbackVaryings( id, static_cast< int >( names.size() ), names.data(), GL_INTERLEAVED_ATTRIBS );
+    glLinkProgram( id );
+    compileErrors( id, "PROGRAM" );
+    glDeleteShader( vertex );
+}
+
+Shader::Shader( const char * vertexPath, const char * controlPath, const char * evaluationPath, const char * fragmentPath, const std::string & defines )
+{
+    const char * paths[4] = { vertexPath, controlPath, evaluationPath, fragmentPath };
+    const unsigned int types[4] = { GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_FRAGMENT_SHADER };
+    const char * names[4] = { "VERTEX", "TESS_CONTROL", "TESS_EVALUATION", "FRAGMENT" };
+    unsigned int stages[4];
+    id = glCreateProgram();
+    for( int i = 0; i < 4; i++ )
+    {
+        std::ifstream file( paths[i] );
+        if( !file )
+            std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << paths[i] << std::endl;
+        std::stringstream stream;
+        stream << file.rdbuf();
+        const std::string code = insertDefines( resolveIncludes( stream.str(), directoryOf( paths[i] ) ), defines );
+        const char * shaderCode = code.c_str();
+
+        stages[i] = glCreateShader( types[i] );
+        glShaderSource( stages[i], 1, &shaderCode, NULL );
+        glCompileShader( stages[i] );
+        compileErrors( stages[i], names[i] );
+        glAttachShader( id, stages[i] );
+    }
+    glLinkProgram( id );
+    compileErrors( id, "PROGRAM" );
+    for( int i = 0; i < 4; i++ )
+        glDeleteShader( stages[i] );
+}
+
+Shader::Shader( const char * computePath )
+{
+    std::ifstream file( computePath );
+    if( !file )
+        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << computePath << std::endl;
+    std::stringstream stream;
+    stream << file.rdbuf();
+    const std::string code = resolveIncludes( stream.str(), directoryOf( computePath ) );
+    const char * cShaderCode = code.c_str();
+
+    unsigned int compute = glCreateShader( GL_COMPUTE_SHADER );
+    glShaderSource( compute, 1, &cShaderCode, NULL );
+    glCompileShader( compute );
+    compileErrors( compute, "COMPUTE" );
+
+    id = glCreateProgram();
+    glAttachShader( id, compute );
+    glLinkProgram( id );
+    compileErrors( id, "PROGRAM" );
+    glDeleteShader( compute );
+}
+
 void Shader::activate() const noexcept
 {
     glUseProgram( id );
@@ -179,4 +280,60 @@ void Shader::compileErrors( unsigned int shader, const char * type )
             std::cerr << "ERROR - Could not compile shader : " << type << "\n" << infoLog << std::endl;
         }
     }
-}
\ No newline at end of file
+}
+
+std::string Shader::resolveIncludes( const std::string & code, const std::string & directory, int depth )
+{
+    if( depth > MAX_INCLUDE_DEPTH )
+    {
+        std::cerr << "ERROR::SHADER::INCLUDE_TOO_DEEP in " << directory << std::endl;
+        return std::string();
+    }
+    std::istringstream lines( code );
+    std::ostringstream result;
+    std::string line;
+    while( std::getline( lines, line ) )
+    {
+        size_t start = line.find_first_not_of( " \t" );
+        if( start == std::string::npos || line.compare( start, 8, "#include" ) != 0 )
+        {
+            result << line << '\n';
+            continue;
+        }
+        size_t open = line.find( '"', start );
+        size_t close = open == std::string::npos ? std::string::npos : line.find( '"', open + 1 );
+        if( close == std::string::npos )
+        {
+            std::cerr << "ERROR::SHADER::INCLUDE_MALFORMED: " << line << std::endl;
+            continue;
+        }
+        const std::string path = directory + line.substr( open + 1, close - open - 1 );
+        std::ifstream file( path );
+        if( !file )
+        {
+            std::cerr << "ERROR::SHADER::INCLUDE_NOT_FOUND: " << path << std::endl;
+            continue;
+        }
+        std::stringstream content;
+        content << file.rdbuf();
+        result << resolveIncludes( content.str(), directoryOf( path ), depth + 1 );
+    }
+    return result.str();
+}
+
+std::string Shader::insertDefines( const std::string & code, const std::string & defines )
+{
+    if( defines.empty() )
+        return code;
+    // #version has to stay the first statement
+    size_t start = 0;
+    if( code.compare( 0, 8, "#version" ) == 0 )
+    {
+        size_t end = code.find( '\n' );
+        start = end == std::string::npos ? code.size() : end + 1;
+    }
+    std::string result = code.substr( 0, start ) + defines;
+    if( !defines.empty() && defines.back() != '\n' )
+        result += '\n';
+    return result + code.substr( start );
+}
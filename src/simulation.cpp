@@ -0,0 +1,197 @@
+#include <simulation.hpp>
+#include <stdexcept>
+#include <iostream>
+
+Simulation::Simulation( double tickRate, int resolution, float patchSize, unsigned int threadCount ) :
+    tickRate( tickRate ), ocean( resolution, patchSize, threadCount ), stop( false ), tickTime( 0.0f ), droppedTicks( 0 ),
+    exportedFrames( 0 ), exportTime( 0.0f ), exportFailed( false )
+{
+    if( tickRate <= 0.0 )
+    {
+        throw std::runtime_error( "Simulation tick rate must be positive" );
+    }
+    start = std::chrono::steady_clock::now();
+    worker = std::thread( &Simulation::run, this );
+}
+
+Simulation::~Simulation()
+{
+    stop = true;
+    worker.join();
+}
+
+void Simulation::setSettings( const SimulationSettings & settings ) noexcept
+{
+    this->settings.back() = settings;
+    this->settings.publish();
+}
+
+bool Simulation::interpolate( std::vector< glm::vec4 > & displacement, std::vector< glm::vec4 > & normals )
+{
+    if( snapshots.isFresh() )
+    {
+        // The front snapshot becomes the previous one, the buffers it gives back are overwritten by the next tick
+        std::swap( previous, snapshots.front() );
+        snapshots.acquire();
+    }
+    const SimulationSnapshot & current = snapshots.front();
+    if( current.displacement.empty() )
+        return false;
+
+    // Rendering one tick in the past keeps the time between the two latest snapshots
+    float alpha = 1.0f;
+    if( previous.displacement.size() == current.displacement.size() && current.time > previous.time )
+    {
+        const double renderTime = getTime() - 1.0 / tickRate;
+        alpha = static_cast< float >( std::min( std::max( ( renderTime - previous.time ) / ( current.time - previous.time ), 0.0 ), 1.0 ) );
+    }
+
+    const size_t count = current.displacement.size();
+    displacement.resize( count );
+    normals.resize( count );
+    if( alpha == 1.0f )
+    {
+        displacement = current.displacement;
+        normals = current.normals;
+        return true;
+    }
+    for( size_t i = 0; i < count; i++ )
+    {
+        displacement[i] = glm::mix( previous.displacement[i], current.displacement[i], alpha );
+        normals[i] = glm::mix( previous.normals[i], current.normals[i], alpha );
+    }
+    return true;
+}
+
+double Simulation::getTime() const noexcept
+{
+    std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+double Simulation::getTickRate() const noexcept
+{
+    return tickRate;
+}
+
+float Simulation::getTickTime() const noexcept
+{
+    return tickTime;
+}
+
+unsigned long Simulation::getDroppedTicks() const noexcept
+{
+    return droppedTicks;
+}
+
+unsigned long Simulation::getExportedFrames() const noexcept
+{
+    return exportedFrames;
+}
+
+float Simulation::getExportTime() const noexcept
+{
+    return exportTime;
+}
+
+bool Simulation::hasExportFailed() const noexcept
+{
+    return exportFailed;
+}
+
+int Simulation::getResolution() const noexcept
+{
+    return ocean.getResolution();
+}
+
+float Simulation::getPatchSize() const noexcept
+{
+    return ocean.getPatchSize();
+}
+
+void Simulation::run() noexcept
+{
+    const std::chrono::duration< double > period( 1.0 / tickRate );
+    auto dueTime = [ & ]( unsigned long tick )
+    {
+        return start + std::chrono::duration_cast< std::chrono::steady_clock::duration >( period * static_cast< double >( tick ) );
+    };
+
+    SimulationSettings current;
+    unsigned long tick = 0;
+    while( !stop )
+    {
+        tick++;
+        const auto now = std::chrono::steady_clock::now();
+        if( now > dueTime( tick ) + period )
+        {
+            // More than a period late : resume at the tick due now instead of running the missed ones back to back
+            const unsigned long late = static_cast< unsigned long >( std::chrono::duration< double >( now - start ) / period );
+            droppedTicks += late - tick;
+            tick = late;
+        }
+        std::this_thread::sleep_until( dueTime( tick ) );
+
+        if( settings.acquire() )
+        {
+            current = settings.front();
+            updateExport( current );
+        }
+        if( !current.oceanEnabled )
+            continue;
+
+        const auto begin = std::chrono::steady_clock::now();
+        const double time = tick / tickRate;
+        ocean.setSpectrum( current.amplitude, current.windSpeed, current.windDirection );
+        ocean.setChoppiness( current.choppiness );
+        ocean.update( ( time + current.timeOffset ) * current.speed );
+
+        SimulationSnapshot & snapshot = snapshots.back();
+        snapshot.tick = tick;
+        snapshot.time = time;
+        snapshot.displacement = ocean.getDisplacement();
+        snapshot.normals = ocean.getNormals();
+
+        std::chrono::duration< float, std::milli > elapsed = std::chrono::steady_clock::now() - begin;
+        tickTime = tickTime * 0.95f + elapsed.count() * 0.05f;
+
+        // Written before publishing, the snapshot belongs to the render thread afterwards
+        if( exporter )
+        {
+            const auto exportBegin = std::chrono::steady_clock::now();
+            RingExportParameters parameters;
+            parameters.amplitude = current.amplitude;
+            parameters.windSpeed = current.windSpeed;
+            parameters.windDirection[ 0 ] = current.windDirection.x;
+            parameters.windDirection[ 1 ] = current.windDirection.y;
+            parameters.choppiness = current.choppiness;
+            parameters.speed = current.speed;
+            exporter->write( time, parameters, snapshot.displacement, snapshot.normals );
+            exportedFrames++;
+            std::chrono::duration< float, std::milli > exportElapsed = std::chrono::steady_clock::now() - exportBegin;
+            exportTime = exportTime * 0.95f + exportElapsed.count() * 0.05f;
+        }
+        snapshots.publish();
+    }
+}
+
+void Simulation::updateExport( const SimulationSettings & settings ) noexcept
+{
+    if( settings.exportPath == exportPath )
+        return;
+    exportPath = settings.exportPath;
+    exporter.reset();
+    exportedFrames = 0;
+    exportFailed = false;
+    if( exportPath.empty() )
+        return;
+    try
+    {
+        exporter = std::make_unique< RingExport >( exportPath, ocean.getResolution(), ocean.getPatchSize(), static_cast< float >( 1.0 / tickRate ) );
+    }
+    catch( std::exception & e )
+    {
+        std::cerr << e.what() << std::endl;
+        exportFailed = true;
+    }
+}
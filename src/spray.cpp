@@ -0,0 +1,275 @@
+#include <spray.hpp>
+#include <simd.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Particles per chunk of the parallel update, a multiple of every SIMD width
+    const int UPDATE_GRANULARITY = 4096;
+
+    struct SprayStep
+    {
+        float dt;
+        float gravity;
+        float sprayDrag; // velocity kept over the step
+        float foamDrag;
+        float landingKeep; // horizontal velocity kept when the spray hits the water
+        float foamRateScale;
+    };
+
+    // One step of the particles [ begin, end ), both multiples of SIMD_WIDTH. The spray falls under gravity and drag
+    // until it goes below the height it was thrown from, then turns into foam drifting on the surface
+    void stepParticles( float * x, float * y, float * z, float * velocityX, float * velocityY, float * velocityZ,
+                        float * fade, float * rate, const float * floor, float * foam, int begin, int end, const SprayStep & step ) noexcept
+    {
+        const vfloat zero = vset1( 0.0f );
+        const vfloat one = vset1( 1.0f );
+        const vfloat dt = vset1( step.dt );
+        const vfloat fall = vset1( step.gravity * step.dt );
+        const vfloat sprayDrag = vset1( step.sprayDrag );
+        const vfloat dragDelta = vset1( step.foamDrag - step.sprayDrag );
+        const vfloat landingKeep = vset1( step.landingKeep );
+        const vfloat foamRateScale = vset1( step.foamRateScale );
+        for( int i = begin; i < end; i += SIMD_WIDTH )
+        {
+            vfloat f = vload( foam + i );
+            // The foam has no vertical velocity and keeps its height, only the spray falls
+            vfloat drag = vfmadd( f, dragDelta, sprayDrag );
+            vfloat vx = vmul( vload( velocityX + i ), drag );
+            vfloat vy = vmul( vfnmadd( fall, vsub( one, f ), vload( velocityY + i ) ), drag );
+            vfloat vz = vmul( vload( velocityZ + i ), drag );
+            vfloat px = vfmadd( vx, dt, vload( x + i ) );
+            vfloat py = vfmadd( vy, dt, vload( y + i ) );
+            vfloat pz = vfmadd( vz, dt, vload( z + i ) );
+            vfloat r = vload( rate + i );
+            vfloat fd = vfmadd( r, dt, vload( fade + i ) );
+
+            vfloat ground = vload( floor + i );
+            vmask landed = vcmplt( py, ground );
+            vfloat keep = vselect( landed, landingKeep, one );
+            vstore( x + i, px );
+            vstore( y + i, vselect( landed, ground, py ) );
+            vstore( z + i, pz );
+            vstore( velocityX + i, vmul( vx, keep ) );
+            vstore( velocityY + i, vselect( landed, zero, vy ) );
+            vstore( velocityZ + i, vmul( vz, keep ) );
+            // Landing starts the fade over with the slower rate of the foam
+            vstore( fade + i, vselect( landed, zero, fd ) );
+            vstore( foam + i, vselect( landed, one, f ) );
+            vstore( rate + i, vselect( landed, vmul( r, foamRateScale ), r ) );
+        }
+    }
+}
+
+Spray::Spray( int capacity, int emitterResolution, float emitterSize, unsigned int threadCount ) :
+    emitterResolution( emitterResolution ), emitterSize( emitterSize ), pool( threadCount )
+{
+    if( capacity < 1 || emitterResolution < 1 || emitterSize <= 0.0f )
+    {
+        throw std::runtime_error( "Spray must have room for one particle and an emitter with at least one point" );
+    }
+    this->capacity = ( capacity + SIMD_WIDTH - 1 ) / SIMD_WIDTH * SIMD_WIDTH;
+    cellSize = emitterSize / emitterResolution;
+
+    const size_t points = static_cast< size_t >( emitterResolution ) * emitterResolution;
+    gridX.resize( points );
+    gridZ.resize( points );
+    gridHeight.resize( points );
+    gridNormalX.resize( points );
+    gridNormalY.resize( points );
+    gridNormalZ.resize( points );
+
+    for( std::vector< float > * lane : { &x, &y, &z, &velocityX, &velocityY, &velocityZ, &rate, &floor, &foam } )
+        lane->assign( this->capacity, 0.0f );
+    fade.assign( this->capacity, 1.0f );
+    setCenter( glm::vec2( 0.0f ) );
+}
+
+void Spray::setWaves( const WaveSpectrum & spectrum )
+{
+    if( spectrum.getVersion() == wavesVersion )
+        return;
+    waves = spectrum.getWaves();
+    wavesVersion = spectrum.getVersion();
+}
+
+void Spray::setParameters( const SprayParameters & parameters ) noexcept
+{
+    this->parameters = parameters;
+}
+
+void Spray::setCenter( glm::vec2 center ) noexcept
+{
+    emitterOrigin = glm::floor( center / cellSize ) * cellSize - glm::vec2( emitterSize * 0.5f );
+}
+
+void Spray::setOrigin( glm::dvec2 origin ) noexcept
+{
+    const glm::vec2 offset = glm::vec2( origin - this->origin );
+    this->origin = origin;
+    if( offset == glm::vec2( 0.0f ) )
+        return;
+    for( unsigned long long i = tail; i < head; i++ )
+    {
+        const size_t slot = static_cast< size_t >( i % capacity );
+        x[ slot ] -= offset.x;
+        z[ slot ] -= offset.y;
+    }
+    emitterOrigin -= offset;
+}
+
+void Spray::emit( double time, float deltaTime, const std::vector< float > & phases )
+{
+    crestCount = 0;
+    if( waves.empty() || deltaTime <= 0.0f )
+        return;
+
+    // Cell centers, sampled row by row, the cells along the edges only serve the differences
+    const int n = emitterResolution;
+    pool.parallelFor( n, [ & ]( int begin, int end )
+    {
+        for( int j = begin; j < end; j++ )
+        {
+            const size_t row = static_cast< size_t >( j ) * n;
+            for( int i = 0; i < n; i++ )
+            {
+                gridX[ row + i ] = emitterOrigin.x + ( i + 0.5f ) * cellSize;
+                gridZ[ row + i ] = emitterOrigin.y + ( j + 0.5f ) * cellSize;
+            }
+            SurfaceBatch batch = { &gridX[ row ], &gridZ[ row ], &gridHeight[ row ], &gridNormalX[ row ], &gridNormalY[ row ], &gridNormalZ[ row ], n };
+            batch.origin = origin;
+            batch.phases = phases.size() == waves.size() ? phases.data() : nullptr;
+            evaluateWaves( waves.data(), static_cast< int >( waves.size() ), time, batch );
+        }
+    } );
+
+    std::uniform_real_distribution< float > unit( 0.0f, 1.0f );
+    const float cellArea = cellSize * cellSize;
+    const float threshold = std::max( parameters.steepness, 1e-3f );
+    const float inverseSpan = 0.5f / cellSize;
+    for( int j = 1; j < n - 1; j++ )
+    {
+        for( int i = 1; i < n - 1; i++ )
+        {
+            // The slope comes from central differences of the heights, the normal of the shader is a running sum
+            // of the wave derivatives used for the shading and understates it
+            const size_t p = static_cast< size_t >( j ) * n + i;
+            const glm::vec2 gradient( ( gridHeight[ p + 1 ] - gridHeight[ p - 1 ] ) * inverseSpan, ( gridHeight[ p + n ] - gridHeight[ p - n ] ) * inverseSpan );
+            const float slope = glm::length( gradient );
+            if( slope <= threshold )
+                continue;
+            crestCount++;
+            // Stochastic rounding keeps the mean rate when less than one particle per cell is due
+            const float expected = parameters.emissionRate * cellArea * deltaTime * std::min( slope / threshold - 1.0f, 4.0f );
+            int count = static_cast< int >( expected );
+            if( unit( random ) < expected - count )
+                count++;
+            // Thrown forward, down the slope the crest is breaking on
+            const glm::vec2 forward = -gradient / slope;
+            for( int k = 0; k < count; k++ )
+            {
+                glm::vec3 position( gridX[p] + ( unit( random ) - 0.5f ) * cellSize, gridHeight[p], gridZ[p] + ( unit( random ) - 0.5f ) * cellSize );
+                glm::vec2 horizontalVelocity = forward * ( 0.5f + 1.5f * unit( random ) ) + parameters.wind * ( 0.1f + 0.2f * unit( random ) );
+                glm::vec3 velocity( horizontalVelocity.x, 1.5f + 3.0f * unit( random ), horizontalVelocity.y );
+                spawn( position, velocity, parameters.sprayLife * ( 0.5f + unit( random ) ) );
+            }
+        }
+    }
+}
+
+void Spray::spawn( glm::vec3 position, glm::vec3 velocity, float life ) noexcept
+{
+    // A full ring overwrites its oldest particle
+    if( head - tail == static_cast< unsigned long long >( capacity ) )
+        tail++;
+    const size_t slot = static_cast< size_t >( head % capacity );
+    x[ slot ] = position.x;
+    y[ slot ] = position.y;
+    z[ slot ] = position.z;
+    velocityX[ slot ] = velocity.x;
+    velocityY[ slot ] = velocity.y;
+    velocityZ[ slot ] = velocity.z;
+    fade[ slot ] = 0.0f;
+    rate[ slot ] = 1.0f / std::max( life, 1e-3f );
+    floor[ slot ] = position.y;
+    foam[ slot ] = 0.0f;
+    head++;
+}
+
+void Spray::update( float deltaTime ) noexcept
+{
+    if( head == tail || deltaTime <= 0.0f )
+        return;
+
+    SprayStep step;
+    step.dt = deltaTime;
+    step.gravity = parameters.gravity;
+    step.sprayDrag = std::exp( -parameters.sprayDrag * deltaTime );
+    step.foamDrag = std::exp( -parameters.foamDrag * deltaTime );
+    step.landingKeep = 0.3f;
+    step.foamRateScale = 1.0f / std::max( parameters.foamLife, 1e-3f );
+
+    // The range is widened to whole SIMD groups, the extra lanes hold dead particles or unused slots
+    const unsigned long long first = tail / SIMD_WIDTH * SIMD_WIDTH;
+    const unsigned long long last = ( head + SIMD_WIDTH - 1 ) / SIMD_WIDTH * SIMD_WIDTH;
+    const int count = static_cast< int >( std::min< unsigned long long >( last - first, capacity ) );
+    const int start = static_cast< int >( first % capacity );
+    pool.parallelFor( count, [ & ]( int begin, int end )
+    {
+        // A chunk crossing the end of the ring is run in two parts
+        int a = start + begin;
+        int b = start + end;
+        if( a >= capacity )
+        {
+            a -= capacity;
+            b -= capacity;
+        }
+        auto run = [ & ]( int from, int to )
+        {
+            stepParticles( x.data(), y.data(), z.data(), velocityX.data(), velocityY.data(), velocityZ.data(),
+                           fade.data(), rate.data(), floor.data(), foam.data(), from, to, step );
+        };
+        if( b > capacity )
+        {
+            run( a, capacity );
+            run( 0, b - capacity );
+        }
+        else
+            run( a, b );
+    }, UPDATE_GRANULARITY );
+
+    while( tail != head && fade[ tail % capacity ] >= 1.0f )
+        tail++;
+}
+
+void Spray::clear() noexcept
+{
+    tail = head;
+}
+
+SprayPool Spray::getPool() const noexcept
+{
+    return { x.data(), y.data(), z.data(), fade.data(), foam.data(), capacity, static_cast< int >( tail % capacity ), static_cast< int >( head - tail ) };
+}
+
+int Spray::getCapacity() const noexcept
+{
+    return capacity;
+}
+
+int Spray::getLiveCount() const noexcept
+{
+    return static_cast< int >( head - tail );
+}
+
+int Spray::getCrestCount() const noexcept
+{
+    return crestCount;
+}
+
+unsigned int Spray::getThreadCount() const noexcept
+{
+    return pool.getThreadCount();
+}
@@ -0,0 +1,80 @@
+#include <sprayrenderer.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+
+SprayRenderer::SprayRenderer( int capacity ) noexcept : capacity( capacity )
+{
+    glGenVertexArrays( 1, &vao );
+    glGenBuffers( 1, &vbo );
+    glBindVertexArray( vao );
+    glBindBuffer( GL_ARRAY_BUFFER, vbo );
+    glBufferData( GL_ARRAY_BUFFER, static_cast< size_t >( capacity ) * LANE_COUNT * sizeof( float ), nullptr, GL_STREAM_DRAW );
+    // x, y, z, fade and foam one after the other, one float per instance each
+    for( int lane = 0; lane < LANE_COUNT; lane++ )
+    {
+        glEnableVertexAttribArray( lane );
+        glVertexAttribPointer( lane, 1, GL_FLOAT, GL_FALSE, sizeof( float ), ( void* )( static_cast< size_t >( capacity ) * lane * sizeof( float ) ) );
+        glVertexAttribDivisor( lane, 1 );
+    }
+    glBindVertexArray( 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+SprayRenderer::~SprayRenderer()
+{
+    glDeleteBuffers( 1, &vbo );
+    glDeleteVertexArrays( 1, &vao );
+}
+
+void SprayRenderer::upload( const SprayPool & pool ) noexcept
+{
+    count = std::min( pool.count, capacity );
+    if( count == 0 )
+        return;
+    const size_t size = static_cast< size_t >( capacity ) * LANE_COUNT * sizeof( float );
+    glBindBuffer( GL_ARRAY_BUFFER, vbo );
+    // Orphan the previous storage, the driver hands out a fresh block while the last draw still reads the old one
+    glBufferData( GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW );
+    float * mapped = static_cast< float * >( glMapBufferRange( GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT ) );
+    if( mapped )
+    {
+        // The live range may wrap around the end of the ring, it is unrolled from the start of each block
+        const float * lanes[ LANE_COUNT ] = { pool.x, pool.y, pool.z, pool.fade, pool.foam };
+        const int first = std::min( count, pool.capacity - pool.first );
+        for( int lane = 0; lane < LANE_COUNT; lane++ )
+        {
+            float * block = mapped + static_cast< size_t >( capacity ) * lane;
+            std::memcpy( block, lanes[ lane ] + pool.first, first * sizeof( float ) );
+            std::memcpy( block + first, lanes[ lane ], ( count - first ) * sizeof( float ) );
+        }
+        glUnmapBuffer( GL_ARRAY_BUFFER );
+    }
+    else
+        count = 0;
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+void SprayRenderer::draw() noexcept
+{
+    if( count == 0 )
+        return;
+    // Blended over the scene without hiding each other
+    glDepthMask( GL_FALSE );
+    glDisable( GL_CULL_FACE );
+    glBindVertexArray( vao );
+    glDrawArraysInstanced( GL_TRIANGLE_STRIP, 0, 4, count );
+    glBindVertexArray( 0 );
+    glEnable( GL_CULL_FACE );
+    glDepthMask( GL_TRUE );
+}
+
+Shader & SprayRenderer::getShader() noexcept
+{
+    return shader;
+}
+
+int SprayRenderer::getCount() const noexcept
+{
+    return count;
+}
@@ -0,0 +1,58 @@
+#include <streamtexture.hpp>
+#include <glad/glad.h>
+#include <cstring>
+
+StreamTexture::StreamTexture( int width, int height, int internalFormat, bool mipmaps ) noexcept :
+    width( width ), height( height ), mipmaps( mipmaps )
+{
+    glGenTextures( 1, &texture );
+    glBindTexture( GL_TEXTURE_2D, texture );
+    glTexImage2D( GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGBA, GL_FLOAT, nullptr );
+    if( mipmaps )
+        glGenerateMipmap( GL_TEXTURE_2D );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    glGenBuffers( 1, &pbo );
+}
+
+StreamTexture::~StreamTexture()
+{
+    glDeleteBuffers( 1, &pbo );
+    glDeleteTextures( 1, &texture );
+}
+
+void StreamTexture::upload( const float * data ) noexcept
+{
+    const size_t size = static_cast< size_t >( width ) * height * 4 * sizeof( float );
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, pbo );
+    // Orphan the previous storage, the driver hands out a fresh block while the old one is still in use
+    glBufferData( GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW );
+    void * mapped = glMapBufferRange( GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT );
+    if( mapped )
+    {
+        std::memcpy( mapped, data, size );
+        glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+        glBindTexture( GL_TEXTURE_2D, texture );
+        glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_FLOAT, nullptr );
+        if( mipmaps )
+            glGenerateMipmap( GL_TEXTURE_2D );
+        glBindTexture( GL_TEXTURE_2D, 0 );
+    }
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+}
+
+void StreamTexture::bind( unsigned int unit ) const noexcept
+{
+    glActiveTexture( GL_TEXTURE0 + unit );
+    glBindTexture( GL_TEXTURE_2D, texture );
+    glActiveTexture( GL_TEXTURE0 );
+}
+
+unsigned int StreamTexture::getId() const noexcept
+{
+    return texture;
+}
@@ -0,0 +1,90 @@
+#include <threadpool.hpp>
+#include <algorithm>
+
+ThreadPool::ThreadPool( unsigned int threadCount ) : nextChunk( 0 )
+{
+    if( threadCount == 0 )
+        threadCount = 1;
+    for( unsigned int i = 1; i < threadCount; i++ )
+        workers.emplace_back( &ThreadPool::workerLoop, this );
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard< std::mutex > lock( mutex );
+        stop = true;
+    }
+    wakeCondition.notify_all();
+    for( std::thread & worker : workers )
+        worker.join();
+}
+
+void ThreadPool::parallelFor( int count, const std::function< void( int, int ) > & task, int granularity )
+{
+    if( count <= 0 )
+        return;
+    if( workers.empty() || count <= granularity )
+    {
+        task( 0, count );
+        return;
+    }
+
+    std::lock_guard< std::mutex > submitLock( submitMutex );
+    {
+        std::lock_guard< std::mutex > lock( mutex );
+        this->task = &task;
+        this->count = count;
+        // A few chunks per thread so an unlucky thread does not hold everyone back
+        int chunks = static_cast< int >( ( workers.size() + 1 ) * 4 );
+        int units = ( count + granularity - 1 ) / granularity;
+        chunkSize = std::max( 1, ( units + chunks - 1 ) / chunks ) * granularity;
+        chunkCount = ( count + chunkSize - 1 ) / chunkSize;
+        nextChunk = 0;
+        pending = static_cast< unsigned int >( workers.size() );
+        generation++;
+    }
+    wakeCondition.notify_all();
+
+    runChunks();
+
+    std::unique_lock< std::mutex > lock( mutex );
+    doneCondition.wait( lock, [ this ] { return pending == 0; } );
+    this->task = nullptr;
+}
+
+unsigned int ThreadPool::getThreadCount() const noexcept
+{
+    return static_cast< unsigned int >( workers.size() + 1 );
+}
+
+void ThreadPool::workerLoop() noexcept
+{
+    unsigned long seenGeneration = 0;
+    while( true )
+    {
+        {
+            std::unique_lock< std::mutex > lock( mutex );
+            wakeCondition.wait( lock, [ this, seenGeneration ] { return stop || generation != seenGeneration; } );
+            if( stop )
+                return;
+            seenGeneration = generation;
+        }
+
+        runChunks();
+
+        std::lock_guard< std::mutex > lock( mutex );
+        if( --pending == 0 )
+            doneCondition.notify_one();
+    }
+}
+
+void ThreadPool::runChunks() noexcept
+{
+    int chunk;
+    while( ( chunk = nextChunk.fetch_add( 1 ) ) < chunkCount )
+    {
+        int begin = chunk * chunkSize;
+        ( *task )( begin, std::min( count, begin + chunkSize ) );
+    }
+}
@@ -0,0 +1,91 @@
+#include <vertexprobe.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+VertexProbe::VertexProbe( int resolution, float spacing ) noexcept :
+    resolution( resolution ), spacing( spacing ), points( resolution * resolution )
+{
+    glGenVertexArrays( 1, &VAO );
+    glGenBuffers( 1, &VBO );
+    glGenBuffers( 1, &feedbackBuffer );
+
+    glBindVertexArray( VAO );
+    glBindBuffer( GL_ARRAY_BUFFER, VBO );
+    glBufferData( GL_ARRAY_BUFFER, points.size() * sizeof( glm::vec3 ), nullptr, GL_STREAM_DRAW );
+    glEnableVertexAttribArray( 0 );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, sizeof( glm::vec3 ), (void*)0 );
+    glBindVertexArray( 0 );
+
+    glBindBuffer( GL_TRANSFORM_FEEDBACK_BUFFER, feedbackBuffer );
+    glBufferData( GL_TRANSFORM_FEEDBACK_BUFFER, points.size() * sizeof( CapturedVertex ), nullptr, GL_STREAM_READ );
+    glBindBuffer( GL_TRANSFORM_FEEDBACK_BUFFER, 0 );
+}
+
+VertexProbe::~VertexProbe()
+{
+    glDeleteBuffers( 1, &feedbackBuffer );
+    glDeleteBuffers( 1, &VBO );
+    glDeleteVertexArrays( 1, &VAO );
+}
+
+VertexError VertexProbe::measure( const Shader & reference, const Shader & candidate, glm::vec2 center ) noexcept
+{
+    const float half = 0.5f * ( resolution - 1 ) * spacing;
+    for( int z = 0; z < resolution; z++ )
+        for( int x = 0; x < resolution; x++ )
+            points[ z * resolution + x ] = glm::vec3( center.x - half + x * spacing, 0.0f, center.y - half + z * spacing );
+    glBindBuffer( GL_ARRAY_BUFFER, VBO );
+    glBufferSubData( GL_ARRAY_BUFFER, 0, points.size() * sizeof( glm::vec3 ), points.data() );
+
+    std::vector< CapturedVertex > expected;
+    std::vector< CapturedVertex > result;
+    capture( reference, expected );
+    capture( candidate, result );
+
+    VertexError error;
+    double heightSquares = 0.0;
+    double normalSquares = 0.0;
+    size_t count = 0;
+    for( size_t i = 0; i < points.size(); i++ )
+    {
+        // Points the reference itself cannot evaluate ( overflowing legacy spectra ) have nothing to compare to
+        if( !std::isfinite( expected[i].pos.y ) || !std::isfinite( glm::dot( expected[i].normal, expected[i].normal ) ) )
+            continue;
+        count++;
+        const float height = std::abs( result[i].pos.y - expected[i].pos.y );
+        // atan2 of the sine and cosine stays accurate for the tiny angles, unlike acos close to 1
+        const glm::vec3 a = glm::normalize( result[i].normal );
+        const glm::vec3 b = glm::normalize( expected[i].normal );
+        const float angle = glm::degrees( std::atan2( glm::length( glm::cross( a, b ) ), glm::dot( a, b ) ) );
+        error.maxHeight = std::max( error.maxHeight, height );
+        error.maxNormal = std::max( error.maxNormal, angle );
+        heightSquares += height * height;
+        normalSquares += angle * angle;
+    }
+    if( count > 0 )
+    {
+        error.rmsHeight = static_cast< float >( std::sqrt( heightSquares / count ) );
+        error.rmsNormal = static_cast< float >( std::sqrt( normalSquares / count ) );
+    }
+    return error;
+}
+
+void VertexProbe::capture( const Shader & shader, std::vector< CapturedVertex > & output ) noexcept
+{
+    shader.activate();
+    glEnable( GL_RASTERIZER_DISCARD );
+    glBindVertexArray( VAO );
+    glBindBufferBase( GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedbackBuffer );
+    glBeginTransformFeedback( GL_POINTS );
+    glDrawArrays( GL_POINTS, 0, static_cast< int >( points.size() ) );
+    glEndTransformFeedback();
+    glBindBufferBase( GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0 );
+    glBindVertexArray( 0 );
+    glDisable( GL_RASTERIZER_DISCARD );
+
+    output.resize( points.size() );
+    glBindBuffer( GL_TRANSFORM_FEEDBACK_BUFFER, feedbackBuffer );
+    glGetBufferSubData( GL_TRANSFORM_FEEDBACK_BUFFER, 0, output.size() * sizeof( CapturedVertex ), output.data() );
+    glBindBuffer( GL_TRANSFORM_FEEDBACK_BUFFER, 0 );
+}
@@ -0,0 +1,197 @@
+#include <wakefield.hpp>
+#include <glad/glad.h>
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <cmath>
+
+// Steps run at most per update, the field slows down rather than stalling the frame after a hitch
+#define WAKE_MAX_STEPS 4
+
+WakeField::WakeField( int resolution, float size, float waveSpeed, float damping, float stepRate ) :
+    resolution( resolution ), size( size ), waveSpeed( waveSpeed ), damping( damping )
+{
+    if( resolution < 8 || size <= 0.0f || stepRate <= 0.0f )
+    {
+        throw std::runtime_error( "Wake field needs at least 8 cells, a positive size and step rate" );
+    }
+    cellSize = size / resolution;
+    stepTime = 1.0f / stepRate;
+    // The explicit scheme is only stable below a Courant number of 1 / sqrt( 2 )
+    if( waveSpeed * stepTime / cellSize > 0.7f )
+    {
+        throw std::runtime_error( "Wake field waves are too fast for its cell size and step rate" );
+    }
+
+    glGenVertexArrays( 1, &quadVAO );
+    glGenTextures( 2, textures );
+    glGenFramebuffers( 2, framebuffers );
+    for( int i = 0; i < 2; i++ )
+    {
+        glBindTexture( GL_TEXTURE_2D, textures[i] );
+        glTexImage2D( GL_TEXTURE_2D, 0, GL_RG32F, resolution, resolution, 0, GL_RG, GL_FLOAT, nullptr );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+
+        glBindFramebuffer( GL_FRAMEBUFFER, framebuffers[i] );
+        glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[i], 0 );
+        if( glCheckFramebufferStatus( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
+        {
+            glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+            throw std::runtime_error( "Wake field framebuffer is incomplete" );
+        }
+    }
+    glBindTexture( GL_TEXTURE_2D, 0 );
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    reset();
+}
+
+WakeField::~WakeField()
+{
+    glDeleteFramebuffers( 2, framebuffers );
+    glDeleteTextures( 2, textures );
+    glDeleteVertexArrays( 1, &quadVAO );
+}
+
+void WakeField::setCenter( glm::vec2 center ) noexcept
+{
+    glm::ivec2 newOrigin = glm::ivec2( glm::floor( center / cellSize ) ) - glm::ivec2( resolution / 2 );
+    // Moves made between two steps add up, the field is cleared against the window it was last stepped in
+    shift += newOrigin - origin;
+    origin = newOrigin;
+}
+
+void WakeField::rebase( glm::vec2 offset ) noexcept
+{
+    const glm::ivec2 cells = glm::ivec2( glm::round( offset / cellSize ) );
+    origin -= cells;
+    for( Source & source : sources )
+        source.position -= offset;
+    // Texel w mod resolution only keeps its world cell when the window moves by whole windows
+    if( cells.x % resolution != 0 || cells.y % resolution != 0 )
+        reset();
+}
+
+void WakeField::addSource( glm::vec2 position, float radius, float speed, float duration ) noexcept
+{
+    sources.push_back( { position, std::max( radius, cellSize ), speed, duration } );
+}
+
+void WakeField::update( float deltaTime ) noexcept
+{
+    accumulator = std::min( accumulator + deltaTime, WAKE_MAX_STEPS * stepTime );
+    bool stepped = false;
+    while( accumulator >= stepTime )
+    {
+        step( true );
+        accumulator -= stepTime;
+        stepped = true;
+    }
+    // The window is drawn where it is now, the cells it moved onto must not show what wrapped around
+    if( !stepped && shift != glm::ivec2( 0 ) )
+        step( false );
+
+    for( Source & source : sources )
+        source.remaining -= deltaTime;
+    sources.erase( std::remove_if( sources.begin(), sources.end(), []( const Source & source ) { return source.remaining <= 0.0f; } ), sources.end() );
+}
+
+void WakeField::reset() noexcept
+{
+    const float zero[ 4 ] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for( int i = 0; i < 2; i++ )
+    {
+        glBindFramebuffer( GL_FRAMEBUFFER, framebuffers[i] );
+        glClearBufferfv( GL_COLOR, 0, zero );
+    }
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    shift = glm::ivec2( 0 );
+}
+
+void WakeField::bind( unsigned int unit ) const noexcept
+{
+    glActiveTexture( GL_TEXTURE0 + unit );
+    glBindTexture( GL_TEXTURE_2D, textures[ current ] );
+    glActiveTexture( GL_TEXTURE0 );
+}
+
+glm::vec2 WakeField::getOrigin() const noexcept
+{
+    return glm::vec2( origin ) * cellSize;
+}
+
+float WakeField::getSize() const noexcept
+{
+    return size;
+}
+
+int WakeField::getResolution() const noexcept
+{
+    return resolution;
+}
+
+unsigned long WakeField::getStepCount() const noexcept
+{
+    return stepCount;
+}
+
+void WakeField::step( bool advance ) noexcept
+{
+    // Save the state touched by the pass
+    int viewport[ 4 ];
+    glGetIntegerv( GL_VIEWPORT, viewport );
+    bool depthTest = glIsEnabled( GL_DEPTH_TEST );
+    bool blend = glIsEnabled( GL_BLEND );
+    bool cullFace = glIsEnabled( GL_CULL_FACE );
+    glDisable( GL_DEPTH_TEST );
+    glDisable( GL_BLEND );
+    glDisable( GL_CULL_FACE );
+
+    glViewport( 0, 0, resolution, resolution );
+    glBindVertexArray( quadVAO );
+    glBindFramebuffer( GL_FRAMEBUFFER, framebuffers[ 1 - current ] );
+    glActiveTexture( GL_TEXTURE0 );
+    glBindTexture( GL_TEXTURE_2D, textures[ current ] );
+
+    const float courant = waveSpeed * stepTime / cellSize;
+    const glm::ivec2 originTexel = ( origin % resolution + resolution ) % resolution;
+    stepShader.activate();
+    stepShader.setInt( "state", 0 );
+    stepShader.setInt( "resolution", resolution );
+    stepShader.setVec2( "originTexel", static_cast< float >( originTexel.x ), static_cast< float >( originTexel.y ) );
+    stepShader.setVec2( "shift", static_cast< float >( shift.x ), static_cast< float >( shift.y ) );
+    stepShader.setInt( "advance", advance );
+    stepShader.setFloat( "courant2", courant * courant );
+    stepShader.setFloat( "damping", damping * stepTime );
+    stepShader.setFloat( "spongeWidth", resolution * 0.05f );
+    stepShader.setFloat( "cellSize", cellSize );
+    stepShader.setFloat( "dt", stepTime );
+    const int sourceCount = std::min( static_cast< int >( sources.size() ), WAKE_MAX_SOURCES );
+    stepShader.setInt( "sourceCount", sourceCount );
+    const glm::vec2 originPosition = getOrigin();
+    for( int i = 0; i < sourceCount; i++ )
+    {
+        const std::string name = "sources[" + std::to_string( i ) + "]";
+        stepShader.setVec4( name.c_str(), sources[i].position.x - originPosition.x, sources[i].position.y - originPosition.y, sources[i].radius, sources[i].speed );
+    }
+    glDrawArrays( GL_TRIANGLES, 0, 3 );
+
+    current = 1 - current;
+    shift = glm::ivec2( 0 );
+    if( advance )
+        stepCount++;
+
+    // Restore the state
+    glBindTexture( GL_TEXTURE_2D, 0 );
+    glBindVertexArray( 0 );
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    glViewport( viewport[0], viewport[1], viewport[2], viewport[3] );
+    if( depthTest )
+        glEnable( GL_DEPTH_TEST );
+    if( blend )
+        glEnable( GL_BLEND );
+    if( cullFace )
+        glEnable( GL_CULL_FACE );
+}
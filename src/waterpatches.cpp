@@ -0,0 +1,119 @@
+#include <waterpatches.hpp>
+#include <glad/glad.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Entry point and constants of GL 4.0 missing from the 3.3 glad
+typedef void ( APIENTRYP PatchParameteriProc )( GLenum name, GLint value );
+#define WATER_PATCHES 0x000E
+#define WATER_PATCH_VERTICES 0x8E72
+#define WATER_MAX_TESS_GEN_LEVEL 0x8E7E
+
+WaterPatches::WaterPatches( void * ( *loader )( const char * ), float distance, float patchWidth ) :
+    across( static_cast< int >( std::ceil( 2.0f * distance / patchWidth ) ) + 1 ), patchWidth( patchWidth )
+{
+    if( distance <= 0.0f || patchWidth <= 0.0f || ( across + 1 ) * ( across + 1 ) > 65536 )
+    {
+        throw std::runtime_error( "Water patches need a positive size and at most 255 patches across" );
+    }
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv( GL_MAJOR_VERSION, &major );
+    glGetIntegerv( GL_MINOR_VERSION, &minor );
+    if( major < 4 )
+    {
+        throw std::runtime_error( "Tessellation needs OpenGL 4.0, the context is " + std::to_string( major ) + "." + std::to_string( minor ) );
+    }
+    patchParameteri = loader( "glPatchParameteri" );
+    if( !patchParameteri )
+    {
+        throw std::runtime_error( "Tessellation could not load the GL 4.0 functions" );
+    }
+    GLint level = 64;
+    glGetIntegerv( WATER_MAX_TESS_GEN_LEVEL, &level );
+    maxLevel = static_cast< float >( std::max( level, 1 ) );
+
+    // Corners in patches, ( i, 0, j ), then 4 per patch going ( 0, 0 ), ( 1, 0 ), ( 1, 1 ), ( 0, 1 ) in ( x, z )
+    const int side = across + 1;
+    std::vector< glm::vec3 > vertices( static_cast< size_t >( side ) * side );
+    for( int j = 0; j < side; j++ )
+        for( int i = 0; i < side; i++ )
+            vertices[ j * side + i ] = glm::vec3( i, 0.0f, j );
+    std::vector< unsigned short > indices;
+    indices.reserve( static_cast< size_t >( across ) * across * 4 );
+    for( int j = 0; j < across; j++ )
+    {
+        for( int i = 0; i < across; i++ )
+        {
+            unsigned short corner = static_cast< unsigned short >( j * side + i );
+            indices.insert( indices.end(), { corner, static_cast< unsigned short >( corner + 1 ), static_cast< unsigned short >( corner + side + 1 ), static_cast< unsigned short >( corner + side ) } );
+        }
+    }
+    indexCount = static_cast< unsigned int >( indices.size() );
+
+    glGenVertexArrays( 1, &vao );
+    glGenBuffers( 1, &vbo );
+    glGenBuffers( 1, &ebo );
+    glBindVertexArray( vao );
+    glBindBuffer( GL_ARRAY_BUFFER, vbo );
+    glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof( glm::vec3 ), vertices.data(), GL_STATIC_DRAW );
+    glEnableVertexAttribArray( 0 );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, sizeof( glm::vec3 ), (void*)0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebo );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof( unsigned short ), indices.data(), GL_STATIC_DRAW );
+    glBindVertexArray( 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+WaterPatches::~WaterPatches()
+{
+    glDeleteBuffers( 1, &ebo );
+    glDeleteBuffers( 1, &vbo );
+    glDeleteVertexArrays( 1, &vao );
+}
+
+void WaterPatches::update( glm::vec3 cameraPosition ) noexcept
+{
+    // Snapped to whole patches so the corners do not swim, the levels of an edge only depend on them
+    const glm::vec2 snapped = glm::floor( glm::vec2( cameraPosition.x, cameraPosition.z ) / patchWidth );
+    origin = ( snapped - glm::vec2( static_cast< float >( across / 2 ) ) ) * patchWidth;
+}
+
+void WaterPatches::setUniforms( const Shader & shader ) const noexcept
+{
+    glm::vec2 patchOrigin = origin;
+    shader.setVec2( "patchOrigin", patchOrigin );
+    shader.setFloat( "patchWidth", patchWidth );
+    shader.setFloat( "maxTessLevel", maxLevel );
+}
+
+void WaterPatches::draw() const noexcept
+{
+    reinterpret_cast< PatchParameteriProc >( patchParameteri )( WATER_PATCH_VERTICES, 4 );
+    glBindVertexArray( vao );
+    glDrawElements( WATER_PATCHES, indexCount, GL_UNSIGNED_SHORT, 0 );
+    glBindVertexArray( 0 );
+}
+
+int WaterPatches::getPatchesAcross() const noexcept
+{
+    return across;
+}
+
+unsigned int WaterPatches::getVertexCount() const noexcept
+{
+    return static_cast< unsigned int >( ( across + 1 ) * ( across + 1 ) );
+}
+
+float WaterPatches::getPatchWidth() const noexcept
+{
+    return patchWidth;
+}
+
+float WaterPatches::getMinSpacing() const noexcept
+{
+    return patchWidth / maxLevel;
+}
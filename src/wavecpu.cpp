@@ -0,0 +1,175 @@
+#include <wavecpu.hpp>
+#include <simd.hpp>
+#include <wavemodel.hpp>
+#include <utility>
+#include <vector>
+#include <cmath>
+
+namespace
+{
+    // Sums carried across the waves for SIMD_WIDTH points, normal.y is 1 + the wave count and needs no lane
+    struct WaveSums
+    {
+        vfloat height;
+        vfloat dx;
+        vfloat dz;
+        vfloat normalX;
+        vfloat normalZ;
+    };
+
+    inline void addWave( const WaveComponent & wave, float timePhase, vfloat x, vfloat z, WaveSums & sums ) noexcept
+    {
+        vfloat kx = vset1( wave.k.x );
+        vfloat kz = vset1( wave.k.y );
+        // Written as separate multiplies and adds like the shader, but nothing stops either compiler from fusing them
+        // ( GCC contracts by default ) : both sides only agree within the tolerance given in wavecpu.hpp
+        vfloat phase = vadd( vset1( timePhase ), vadd( vmul( kx, x ), vmul( kz, z ) ) );
+        vfloat s, c;
+        vsincos( phase, s, c );
+        vfloat f = vmul( vset1( wave.amplitude ), vexp( vsub( c, vset1( 1.0f ) ) ) );
+        vfloat fp = vfnmadd( s, f, vset1( 0.0f ) );
+
+        sums.height = vadd( sums.height, f );
+        sums.dx = vfmadd( kx, fp, sums.dx );
+        sums.dz = vfmadd( kz, fp, sums.dz );
+        sums.normalX = vadd( sums.normalX, sums.dx );
+        sums.normalZ = vadd( sums.normalZ, sums.dz );
+    }
+
+    // Phase of wave i at the origin of the batch, the accumulated one of WavePhases when the batch carries them
+    inline float batchPhase( const WaveComponent * waves, int i, double time, const SurfaceBatch & batch ) noexcept
+    {
+        return batch.phases ? batch.phases[i] : wavePhase( waves[i], time, batch.origin );
+    }
+
+    template< int... I >
+    inline void addWaves( const WaveComponent * waves, const float * timePhases, vfloat x, vfloat z, WaveSums & sums, std::integer_sequence< int, I... > ) noexcept
+    {
+        // The fold expands to one addWave per wave, evaluated in order
+        ( addWave( waves[ I ], timePhases[ I ], x, z, sums ), ... );
+    }
+
+    inline void storeResult( const WaveSums & sums, float sumY, float * height, float * normalX, float * normalY, float * normalZ ) noexcept
+    {
+        vfloat ny = vset1( sumY );
+        vfloat length2 = vfmadd( sums.normalX, sums.normalX, vfmadd( sums.normalZ, sums.normalZ, vmul( ny, ny ) ) );
+        vfloat inverseLength = vdiv( vset1( 1.0f ), vsqrt( length2 ) );
+        vstore( height, sums.height );
+        vstore( normalX, vmul( sums.normalX, inverseLength ) );
+        vstore( normalY, vmul( ny, inverseLength ) );
+        vstore( normalZ, vmul( sums.normalZ, inverseLength ) );
+    }
+
+    // Runs kernel( x, z, sums ) on every group of SIMD_WIDTH points, the last partial group goes through a padded copy
+    // sumY is the y component of the normal before normalization
+    template< typename Kernel >
+    void forEachGroup( const SurfaceBatch & batch, float sumY, const Kernel & kernel ) noexcept
+    {
+        const int full = batch.count - batch.count % SIMD_WIDTH;
+        for( int i = 0; i < full; i += SIMD_WIDTH )
+        {
+            WaveSums sums = { vset1( 0.0f ), vset1( 0.0f ), vset1( 0.0f ), vset1( 0.0f ), vset1( 0.0f ) };
+            kernel( vload( batch.x + i ), vload( batch.z + i ), sums );
+            storeResult( sums, sumY, batch.height + i, batch.normalX + i, batch.normalY + i, batch.normalZ + i );
+        }
+        if( full == batch.count )
+            return;
+
+        float x[ SIMD_WIDTH ] = {}, z[ SIMD_WIDTH ] = {};
+        float height[ SIMD_WIDTH ], normalX[ SIMD_WIDTH ], normalY[ SIMD_WIDTH ], normalZ[ SIMD_WIDTH ];
+        const int rest = batch.count - full;
+        for( int j = 0; j < rest; j++ )
+        {
+            x[j] = batch.x[ full + j ];
+            z[j] = batch.z[ full + j ];
+        }
+        WaveSums sums = { vset1( 0.0f ), vset1( 0.0f ), vset1( 0.0f ), vset1( 0.0f ), vset1( 0.0f ) };
+        kernel( vload( x ), vload( z ), sums );
+        storeResult( sums, sumY, height, normalX, normalY, normalZ );
+        for( int j = 0; j < rest; j++ )
+        {
+            batch.height[ full + j ] = height[j];
+            batch.normalX[ full + j ] = normalX[j];
+            batch.normalY[ full + j ] = normalY[j];
+            batch.normalZ[ full + j ] = normalZ[j];
+        }
+    }
+}
+
+void evaluateWavesReference( const WaveComponent * waves, int waveCount, double time, const SurfaceBatch & batch ) noexcept
+{
+    std::vector< float > timePhases( waveCount );
+    for( int i = 0; i < waveCount; i++ )
+        timePhases[i] = batchPhase( waves, i, time, batch );
+
+    for( int p = 0; p < batch.count; p++ )
+    {
+        const float x = batch.x[p];
+        const float z = batch.z[p];
+        float height = 0.0f;
+        float dx = 0.0f;
+        float dz = 0.0f;
+        float normalX = 0.0f, normalY = 1.0f, normalZ = 0.0f;
+
+        for( int i = 0; i < waveCount; i++ )
+        {
+            const WaveComponent & w = waves[i];
+            glm::vec3 contribution = waveModel::waveSample( glm::vec4( w.k, w.amplitude, w.omega ), timePhases[i], glm::vec2( x, z ) );
+
+            height += contribution.x;
+            dx += contribution.y;
+            dz += contribution.z;
+            normalX += dx;
+            normalY += 1.0f;
+            normalZ += dz;
+        }
+        float inverseLength = 1.0f / std::sqrt( normalX * normalX + normalY * normalY + normalZ * normalZ );
+        batch.height[p] = height;
+        batch.normalX[p] = normalX * inverseLength;
+        batch.normalY[p] = normalY * inverseLength;
+        batch.normalZ[p] = normalZ * inverseLength;
+    }
+}
+
+void evaluateWavesLoop( const WaveComponent * waves, int waveCount, double time, const SurfaceBatch & batch ) noexcept
+{
+    std::vector< float > timePhases( waveCount );
+    for( int i = 0; i < waveCount; i++ )
+        timePhases[i] = batchPhase( waves, i, time, batch );
+
+    forEachGroup( batch, 1.0f + waveCount, [ & ]( vfloat x, vfloat z, WaveSums & sums )
+    {
+        for( int i = 0; i < waveCount; i++ )
+            addWave( waves[i], timePhases[i], x, z, sums );
+    } );
+}
+
+template< int WAVES >
+void evaluateWavesFixed( const WaveComponent * waves, double time, const SurfaceBatch & batch ) noexcept
+{
+    float timePhases[ WAVES ];
+    for( int i = 0; i < WAVES; i++ )
+        timePhases[i] = batchPhase( waves, i, time, batch );
+
+    forEachGroup( batch, 1.0f + WAVES, [ & ]( vfloat x, vfloat z, WaveSums & sums )
+    {
+        addWaves( waves, timePhases, x, z, sums, std::make_integer_sequence< int, WAVES >() );
+    } );
+}
+
+template void evaluateWavesFixed< 8 >( const WaveComponent *, double, const SurfaceBatch & ) noexcept;
+template void evaluateWavesFixed< 16 >( const WaveComponent *, double, const SurfaceBatch & ) noexcept;
+template void evaluateWavesFixed< 32 >( const WaveComponent *, double, const SurfaceBatch & ) noexcept;
+template void evaluateWavesFixed< 64 >( const WaveComponent *, double, const SurfaceBatch & ) noexcept;
+
+void evaluateWaves( const WaveComponent * waves, int waveCount, double time, const SurfaceBatch & batch ) noexcept
+{
+    switch( waveCount )
+    {
+        case 8: evaluateWavesFixed< 8 >( waves, time, batch ); break;
+        case 16: evaluateWavesFixed< 16 >( waves, time, batch ); break;
+        case 32: evaluateWavesFixed< 32 >( waves, time, batch ); break;
+        case 64: evaluateWavesFixed< 64 >( waves, time, batch ); break;
+        default: evaluateWavesLoop( waves, waveCount, time, batch ); break;
+    }
+}
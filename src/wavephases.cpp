@@ -0,0 +1,77 @@
+#include <wavephases.hpp>
+#include <glm/gtc/constants.hpp>
+#include <cmath>
+
+namespace
+{
+    double wrap( double phase ) noexcept
+    {
+        phase = std::fmod( phase, glm::two_pi< double >() );
+        return phase < 0.0 ? phase + glm::two_pi< double >() : phase;
+    }
+
+    float toFloat( double phase ) noexcept
+    {
+        // The float rounding can land exactly on 2 pi
+        float result = static_cast< float >( phase );
+        return result < glm::two_pi< float >() ? result : 0.0f;
+    }
+
+    double originPhase( const WaveComponent & wave, glm::dvec2 origin ) noexcept
+    {
+        return static_cast< double >( wave.k.x ) * origin.x + static_cast< double >( wave.k.y ) * origin.y;
+    }
+}
+
+float wavePhase( float omega, double time ) noexcept
+{
+    return toFloat( wrap( omega * time ) );
+}
+
+float wavePhase( const WaveComponent & wave, double time, glm::dvec2 origin ) noexcept
+{
+    return toFloat( wrap( wave.omega * time + originPhase( wave, origin ) ) );
+}
+
+void WavePhases::advance( const std::vector< WaveComponent > & waves, double time, glm::dvec2 origin ) noexcept
+{
+    if( !started )
+    {
+        reset( waves, time, origin );
+        return;
+    }
+
+    const double elapsed = time - this->time;
+    const size_t previousCount = phases.size();
+    phases.resize( waves.size() );
+    floatPhases.resize( waves.size() );
+    for( size_t i = 0; i < waves.size(); i++ )
+    {
+        phases[i] = i < previousCount ? wrap( phases[i] + waves[i].omega * elapsed ) : wrap( waves[i].omega * time );
+        floatPhases[i] = toFloat( wrap( phases[i] + originPhase( waves[i], origin ) ) );
+    }
+    this->time = time;
+}
+
+void WavePhases::reset( const std::vector< WaveComponent > & waves, double time, glm::dvec2 origin ) noexcept
+{
+    phases.resize( waves.size() );
+    floatPhases.resize( waves.size() );
+    for( size_t i = 0; i < waves.size(); i++ )
+    {
+        phases[i] = wrap( waves[i].omega * time );
+        floatPhases[i] = toFloat( wrap( phases[i] + originPhase( waves[i], origin ) ) );
+    }
+    this->time = time;
+    started = true;
+}
+
+const std::vector< float > & WavePhases::getPhases() const noexcept
+{
+    return floatPhases;
+}
+
+double WavePhases::getTime() const noexcept
+{
+    return time;
+}
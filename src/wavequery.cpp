@@ -0,0 +1,162 @@
+#include <wavequery.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <mutex>
+#include <cmath>
+
+WaveQuery::WaveQuery( int resolution, float tileSize, unsigned int threadCount ) : resolution( resolution ), tileSize( tileSize ), pool( threadCount )
+{
+    if( resolution < 1 || tileSize <= 0.0f )
+    {
+        throw std::runtime_error( "Wave query tile must have at least one cell and a positive size" );
+    }
+    cellSize = tileSize / resolution;
+    const size_t samples = static_cast< size_t >( resolution + 1 ) * ( resolution + 1 );
+    tileHeight.resize( samples );
+    tileNormalX.resize( samples );
+    tileNormalY.resize( samples );
+    tileNormalZ.resize( samples );
+    setTileCenter( glm::vec2( 0.0f ) );
+}
+
+void WaveQuery::setWaves( const WaveSpectrum & spectrum )
+{
+    std::unique_lock< std::shared_mutex > lock( mutex );
+    if( spectrum.getVersion() == wavesVersion )
+        return;
+    waves = spectrum.getWaves();
+    wavesVersion = spectrum.getVersion();
+    tileValid = false;
+}
+
+void WaveQuery::setTileCenter( glm::vec2 center ) noexcept
+{
+    glm::vec2 origin = glm::floor( center / cellSize ) * cellSize - glm::vec2( tileSize * 0.5f );
+    std::unique_lock< std::shared_mutex > lock( mutex );
+    if( origin == tileOrigin && tileValid )
+        return;
+    tileOrigin = origin;
+    tileValid = false;
+}
+
+void WaveQuery::query( const SurfaceBatch & batch, double time, QueryMode mode )
+{
+    if( mode == QUERY_EXACT )
+    {
+        std::shared_lock< std::shared_mutex > lock( mutex );
+        evaluateWaves( waves.data(), static_cast< int >( waves.size() ), time, batch );
+        return;
+    }
+
+    {
+        std::shared_lock< std::shared_mutex > lock( mutex );
+        if( tileValid && tileTime == time )
+        {
+            lookup( batch, time );
+            return;
+        }
+    }
+    // First reader of a new tick : rebuild unless another reader did while this one waited
+    std::unique_lock< std::shared_mutex > lock( mutex );
+    if( !tileValid || tileTime != time )
+        rebuildTile( time, batch );
+    lookup( batch, time );
+}
+
+int WaveQuery::getResolution() const noexcept
+{
+    return resolution;
+}
+
+float WaveQuery::getTileSize() const noexcept
+{
+    return tileSize;
+}
+
+unsigned long WaveQuery::getRebuildCount() const noexcept
+{
+    std::shared_lock< std::shared_mutex > lock( mutex );
+    return rebuildCount;
+}
+
+void WaveQuery::rebuildTile( double time, const SurfaceBatch & query ) noexcept
+{
+    const int samples = resolution + 1;
+    pool.parallelFor( samples, [ & ]( int begin, int end )
+    {
+        std::vector< float > x( samples ), z( samples );
+        for( int i = 0; i < samples; i++ )
+            x[i] = tileOrigin.x + i * cellSize;
+        for( int j = begin; j < end; j++ )
+        {
+            std::fill( z.begin(), z.end(), tileOrigin.y + j * cellSize );
+            const size_t row = static_cast< size_t >( j ) * samples;
+            SurfaceBatch batch = { x.data(), z.data(), &tileHeight[ row ], &tileNormalX[ row ], &tileNormalY[ row ], &tileNormalZ[ row ], samples };
+            batch.origin = query.origin;
+            batch.phases = query.phases;
+            evaluateWaves( waves.data(), static_cast< int >( waves.size() ), time, batch );
+        }
+    } );
+    tileTime = time;
+    tileValid = true;
+    rebuildCount++;
+}
+
+void WaveQuery::lookup( const SurfaceBatch & batch, double time ) const
+{
+    const int samples = resolution + 1;
+    const float inverseCellSize = 1.0f / cellSize;
+    std::vector< int > misses;
+
+    for( int p = 0; p < batch.count; p++ )
+    {
+        const float u = ( batch.x[p] - tileOrigin.x ) * inverseCellSize;
+        const float v = ( batch.z[p] - tileOrigin.y ) * inverseCellSize;
+        // Written so that NaN coordinates also miss
+        if( !( u >= 0.0f && v >= 0.0f && u < resolution && v < resolution ) )
+        {
+            misses.push_back( p );
+            continue;
+        }
+        const int i = static_cast< int >( u );
+        const int j = static_cast< int >( v );
+        const float s = u - i;
+        const float t = v - j;
+        const size_t a = static_cast< size_t >( j ) * samples + i;
+        const size_t c = a + samples;
+        auto bilinear = [ & ]( const std::vector< float > & field )
+        {
+            float top = field[ a ] + ( field[ a + 1 ] - field[ a ] ) * s;
+            float bottom = field[ c ] + ( field[ c + 1 ] - field[ c ] ) * s;
+            return top + ( bottom - top ) * t;
+        };
+
+        batch.height[p] = bilinear( tileHeight );
+        glm::vec3 normal = glm::normalize( glm::vec3( bilinear( tileNormalX ), bilinear( tileNormalY ), bilinear( tileNormalZ ) ) );
+        batch.normalX[p] = normal.x;
+        batch.normalY[p] = normal.y;
+        batch.normalZ[p] = normal.z;
+    }
+    if( misses.empty() )
+        return;
+
+    // Points outside of the tile are gathered and evaluated exactly in one batch
+    const int count = static_cast< int >( misses.size() );
+    std::vector< float > x( count ), z( count ), height( count ), normalX( count ), normalY( count ), normalZ( count );
+    for( int m = 0; m < count; m++ )
+    {
+        x[m] = batch.x[ misses[m] ];
+        z[m] = batch.z[ misses[m] ];
+    }
+    SurfaceBatch missBatch = { x.data(), z.data(), height.data(), normalX.data(), normalY.data(), normalZ.data(), count };
+    missBatch.origin = batch.origin;
+    missBatch.phases = batch.phases;
+    evaluateWaves( waves.data(), static_cast< int >( waves.size() ), time, missBatch );
+    for( int m = 0; m < count; m++ )
+    {
+        batch.height[ misses[m] ] = height[m];
+        batch.normalX[ misses[m] ] = normalX[m];
+        batch.normalY[ misses[m] ] = normalY[m];
+        batch.normalZ[ misses[m] ] = normalZ[m];
+    }
+}
@@ -0,0 +1,188 @@
+#include <wavespectrum.hpp>
+#include <wavemodel.hpp>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cmath>
+
+#define SPECTRUM_GRAVITY 9.81f
+// First hash key of the physical spectra, the legacy one uses the wave index
+#define SPECTRUM_SEED 0x5eed0000u
+
+bool SpectrumParameters::operator==( const SpectrumParameters & other ) const noexcept
+{
+    return type == other.type && waveCount == other.waveCount &&
+           amplitude == other.amplitude && frequency == other.frequency && speed == other.speed &&
+           amplitudeDecay == other.amplitudeDecay && frequencyIncrease == other.frequencyIncrease && directionFactor == other.directionFactor &&
+           windSpeed == other.windSpeed && windDirection == other.windDirection && fetch == other.fetch &&
+           peakEnhancement == other.peakEnhancement && spreading == other.spreading && minWaveLength == other.minWaveLength;
+}
+
+bool SpectrumParameters::operator!=( const SpectrumParameters & other ) const noexcept
+{
+    return !( *this == other );
+}
+
+WaveSpectrum::WaveSpectrum() noexcept
+{
+    buildLegacy();
+    version = 1;
+}
+
+bool WaveSpectrum::setParameters( const SpectrumParameters & parameters ) noexcept
+{
+    SpectrumParameters clamped = parameters;
+    clamped.waveCount = std::min( std::max( parameters.waveCount, 0 ), MAX_WAVES );
+    if( clamped == this->parameters )
+        return false;
+
+    this->parameters = clamped;
+    if( parameters.type == SPECTRUM_LEGACY )
+        buildLegacy();
+    else
+        buildPhysical();
+    version++;
+    return true;
+}
+
+const SpectrumParameters & WaveSpectrum::getParameters() const noexcept
+{
+    return parameters;
+}
+
+const std::vector< WaveComponent > & WaveSpectrum::getWaves() const noexcept
+{
+    return waves;
+}
+
+unsigned long WaveSpectrum::getVersion() const noexcept
+{
+    return version;
+}
+
+const char * WaveSpectrum::getTypeName( SpectrumType type ) noexcept
+{
+    switch( type )
+    {
+        case SPECTRUM_LEGACY: return "Legacy";
+        case SPECTRUM_PHILLIPS: return "Phillips";
+        case SPECTRUM_JONSWAP: return "JONSWAP";
+        case SPECTRUM_PIERSON_MOSKOWITZ: return "Pierson-Moskowitz";
+        default: return "Unknown";
+    }
+}
+
+void WaveSpectrum::buildLegacy() noexcept
+{
+    // Same progression as the loop water.vs used to run for every vertex, with the directions drawn from
+    // the integer hash of wavemodel.glsl instead of fract( sin ), which every driver rounded its own way
+    waves.clear();
+    float A = parameters.amplitude;
+    float w = parameters.frequency;
+    glm::vec2 k = glm::vec2( 1.0f, 0.0f );
+    for( int i = 0; i < parameters.waveCount; i++ )
+    {
+        waves.push_back( { k * w, A, parameters.speed } );
+
+        A *= parameters.amplitudeDecay;
+        float random = waveModel::waveRandom( static_cast< unsigned int >( i ) );
+        // directionFactor is how much the wave direction changes between each wave in [0, 1]
+        k = glm::normalize( glm::vec2( random, 1.0f - random ) ) * parameters.directionFactor;
+        w *= parameters.frequencyIncrease;
+    }
+}
+
+void WaveSpectrum::buildPhysical() noexcept
+{
+    waves.clear();
+    const int count = parameters.waveCount;
+    if( count == 0 )
+        return;
+
+    // The seed is fixed and the hash exact, so the sea looks the same on every run and with every compiler
+    unsigned int key = SPECTRUM_SEED;
+    auto uniform = [ & ]() { return waveModel::waveRandom( key++ ); };
+
+    // Frequencies from half the peak up to the shortest wave, log spaced bins with one jittered wave each
+    const float wp = peakFrequency();
+    const float wMin = 0.5f * wp;
+    const float wMax = std::max( 2.0f * wp, std::sqrt( SPECTRUM_GRAVITY * glm::two_pi< float >() / parameters.minWaveLength ) );
+    const float windAngle = std::atan2( parameters.windDirection.y, parameters.windDirection.x );
+
+    for( int i = 0; i < count; i++ )
+    {
+        float w0 = wMin * std::pow( wMax / wMin, static_cast< float >( i ) / count );
+        float w1 = wMin * std::pow( wMax / wMin, static_cast< float >( i + 1 ) / count );
+        float w = w0 * std::pow( w1 / w0, uniform() );
+
+        // Directional spreading by rejection sampling, cos²( theta ) for Phillips, cos^2s( theta / 2 ) otherwise
+        float theta = 0.0f;
+        for( int attempt = 0; attempt < 64; attempt++ )
+        {
+            theta = ( uniform() * 2.0f - 1.0f ) * glm::pi< float >();
+            float spread;
+            if( parameters.type == SPECTRUM_PHILLIPS )
+            {
+                spread = std::cos( theta ) * std::cos( theta );
+                // Waves moving against the wind are mostly suppressed
+                if( std::abs( theta ) > glm::half_pi< float >() )
+                    spread *= 0.07f;
+            }
+            else
+            {
+                spread = std::pow( std::cos( theta * 0.5f ), 2.0f * parameters.spreading );
+            }
+            if( uniform() < spread )
+                break;
+        }
+        theta += windAngle;
+
+        // Deep water dispersion relation
+        float k = w * w / SPECTRUM_GRAVITY;
+        float amplitude = parameters.amplitude * std::sqrt( 2.0f * density( w ) * ( w1 - w0 ) );
+        waves.push_back( { glm::vec2( std::cos( theta ), std::sin( theta ) ) * k, amplitude, w * parameters.speed } );
+    }
+}
+
+float WaveSpectrum::density( float omega ) const noexcept
+{
+    const float g = SPECTRUM_GRAVITY;
+    const float U = std::max( parameters.windSpeed, 0.1f );
+    const float base = g * g / std::pow( omega, 5.0f );
+    switch( parameters.type )
+    {
+        case SPECTRUM_PHILLIPS:
+        {
+            // Phillips' k^-4 spectrum expressed in frequency, exp( -1 / ( kL )² ) with L = U² / g
+            float w0 = g / U;
+            return 8.1e-3f * base * std::exp( -std::pow( w0 / omega, 4.0f ) );
+        }
+        case SPECTRUM_PIERSON_MOSKOWITZ:
+        {
+            float w0 = g / U;
+            return 8.1e-3f * base * std::exp( -0.74f * std::pow( w0 / omega, 4.0f ) );
+        }
+        case SPECTRUM_JONSWAP:
+        {
+            float F = std::max( parameters.fetch, 1.0f );
+            float alpha = 0.076f * std::pow( U * U / ( F * g ), 0.22f );
+            float wp = peakFrequency();
+            float sigma = omega <= wp ? 0.07f : 0.09f;
+            float r = std::exp( -( omega - wp ) * ( omega - wp ) / ( 2.0f * sigma * sigma * wp * wp ) );
+            return alpha * base * std::exp( -1.25f * std::pow( wp / omega, 4.0f ) ) * std::pow( parameters.peakEnhancement, r );
+        }
+        default:
+            return 0.0f;
+    }
+}
+
+float WaveSpectrum::peakFrequency() const noexcept
+{
+    const float g = SPECTRUM_GRAVITY;
+    const float U = std::max( parameters.windSpeed, 0.1f );
+    switch( parameters.type )
+    {
+        case SPECTRUM_PHILLIPS: return 0.946f * g / U;
+        case SPECTRUM_JONSWAP: return 22.0f * std::cbrt( g * g / ( U * std::max( parameters.fetch, 1.0f ) ) );
+        default: return 0.877f * g / U;
+    }
+}
@@ -0,0 +1,82 @@
+#include <wavetable.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+
+WaveTable::WaveTable() noexcept
+{
+    glGenBuffers( 1, &buffer );
+    glBindBuffer( GL_TEXTURE_BUFFER, buffer );
+    glBufferData( GL_TEXTURE_BUFFER, MAX_WAVES * sizeof( WaveComponent ), nullptr, GL_STATIC_DRAW );
+    glBindBuffer( GL_TEXTURE_BUFFER, 0 );
+
+    glGenTextures( 1, &texture );
+    glBindTexture( GL_TEXTURE_BUFFER, texture );
+    glTexBuffer( GL_TEXTURE_BUFFER, GL_RGBA32F, buffer );
+    glBindTexture( GL_TEXTURE_BUFFER, 0 );
+
+    glGenBuffers( 1, &phaseBuffer );
+    glBindBuffer( GL_TEXTURE_BUFFER, phaseBuffer );
+    glBufferData( GL_TEXTURE_BUFFER, MAX_WAVES * sizeof( float ), nullptr, GL_STREAM_DRAW );
+    glBindBuffer( GL_TEXTURE_BUFFER, 0 );
+
+    glGenTextures( 1, &phaseTexture );
+    glBindTexture( GL_TEXTURE_BUFFER, phaseTexture );
+    glTexBuffer( GL_TEXTURE_BUFFER, GL_R32F, phaseBuffer );
+    glBindTexture( GL_TEXTURE_BUFFER, 0 );
+}
+
+WaveTable::~WaveTable()
+{
+    glDeleteTextures( 1, &phaseTexture );
+    glDeleteBuffers( 1, &phaseBuffer );
+    glDeleteTextures( 1, &texture );
+    glDeleteBuffers( 1, &buffer );
+}
+
+bool WaveTable::update( const WaveSpectrum & spectrum ) noexcept
+{
+    if( spectrum.getVersion() == version )
+        return false;
+
+    const std::vector< WaveComponent > & waves = spectrum.getWaves();
+    waveCount = static_cast< int >( waves.size() );
+    if( waveCount > 0 )
+    {
+        glBindBuffer( GL_TEXTURE_BUFFER, buffer );
+        glBufferSubData( GL_TEXTURE_BUFFER, 0, waveCount * sizeof( WaveComponent ), &waves[0] );
+        glBindBuffer( GL_TEXTURE_BUFFER, 0 );
+    }
+    version = spectrum.getVersion();
+    return true;
+}
+
+void WaveTable::updatePhases( const std::vector< float > & phases ) noexcept
+{
+    const size_t count = std::min( phases.size(), static_cast< size_t >( MAX_WAVES ) );
+    if( count == 0 )
+        return;
+    glBindBuffer( GL_TEXTURE_BUFFER, phaseBuffer );
+    // Orphaning lets the driver hand out new storage instead of waiting for the frame still reading the old phases
+    glBufferData( GL_TEXTURE_BUFFER, MAX_WAVES * sizeof( float ), nullptr, GL_STREAM_DRAW );
+    glBufferSubData( GL_TEXTURE_BUFFER, 0, count * sizeof( float ), phases.data() );
+    glBindBuffer( GL_TEXTURE_BUFFER, 0 );
+}
+
+void WaveTable::bind( unsigned int unit ) const noexcept
+{
+    glActiveTexture( GL_TEXTURE0 + unit );
+    glBindTexture( GL_TEXTURE_BUFFER, texture );
+    glActiveTexture( GL_TEXTURE0 );
+}
+
+void WaveTable::bindPhases( unsigned int unit ) const noexcept
+{
+    glActiveTexture( GL_TEXTURE0 + unit );
+    glBindTexture( GL_TEXTURE_BUFFER, phaseTexture );
+    glActiveTexture( GL_TEXTURE0 );
+}
+
+int WaveTable::getWaveCount() const noexcept
+{
+    return waveCount;
+}